@@ -0,0 +1,93 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+    char *alignUp(char *pointer, size_t alignment) {
+        auto address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+}
+
+// constructor
+ArenaResource::ArenaResource(size_t chunk_size, pmr::memory_resource *upstream)
+        : _upstream_(upstream), _chunk_size_(max(chunk_size, (size_t) 64)) {}
+
+// destructor
+ArenaResource::~ArenaResource() {
+    release();
+}
+
+void ArenaResource::nextChunk(size_t bytes, size_t alignment) {
+    // chunks left over from before the last reset are reused in order
+    while (_next_ != nullptr && _current_ + 1 < _chunks_.size()) {
+        _current_++;
+        Chunk &chunk = _chunks_[_current_];
+        _next_ = chunk.memory;
+        _end_ = chunk.memory + chunk.size;
+        if (alignUp(_next_, alignment) + bytes <= _end_) {
+            return;
+        }
+    }
+    // every new chunk is at least as large as all the earlier ones together
+    size_t size = max(_chunk_size_, bytes + alignment);
+    if (!_chunks_.empty()) {
+        size = max(size, capacity());
+    }
+    auto memory = static_cast<char *>(_upstream_->allocate(size, alignof(max_align_t)));
+    _chunks_.push_back({memory, size});
+    _current_ = _chunks_.size() - 1;
+    _next_ = memory;
+    _end_ = memory + size;
+}
+
+void *ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+    char *start = _next_ == nullptr ? nullptr : alignUp(_next_, alignment);
+    if (start == nullptr || start + bytes > _end_) {
+        nextChunk(bytes, alignment);
+        start = alignUp(_next_, alignment);
+    }
+    _next_ = start + bytes;
+    _used_ += bytes;
+    return start;
+}
+
+void ArenaResource::do_deallocate(void *, size_t, size_t) {}
+
+bool ArenaResource::do_is_equal(const pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+// ===== FUNCTIONS =====
+
+void ArenaResource::reset() {
+    _used_ = 0;
+    _current_ = 0;
+    if (_chunks_.empty()) {
+        _next_ = _end_ = nullptr;
+    } else {
+        _next_ = _chunks_[0].memory;
+        _end_ = _chunks_[0].memory + _chunks_[0].size;
+    }
+}
+
+void ArenaResource::release() {
+    for (const Chunk &chunk: _chunks_) {
+        _upstream_->deallocate(chunk.memory, chunk.size, alignof(max_align_t));
+    }
+    _chunks_.clear();
+    reset();
+}
+
+size_t ArenaResource::used() const {
+    return _used_;
+}
+
+size_t ArenaResource::capacity() const {
+    size_t total = 0;
+    for (const Chunk &chunk: _chunks_) {
+        total += chunk.size;
+    }
+    return total;
+}
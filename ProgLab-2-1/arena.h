@@ -0,0 +1,71 @@
+#ifndef PROGLAB_2_1_ARENA_H
+#define PROGLAB_2_1_ARENA_H
+
+#include "geometry.h"
+#include <memory_resource>
+
+// Bump allocator for shapes that are built and dropped together.
+//
+// Memory is taken from the upstream resource in chunks and handed out by
+// moving a pointer; deallocation does nothing, reset() takes back everything
+// at once and keeps the chunks for the next batch, so a steady stream of
+// batches stops calling the upstream resource after the first one. The chunks
+// come from the upstream resource (pass a node-local one to keep a batch on
+// its NUMA node) and are first written by the thread that fills them.
+//
+// A buffer that grows leaves its old copies behind in the arena until the
+// reset, reserving the vertexes up front avoids that. Not thread safe: give
+// every thread an arena of its own.
+class ArenaResource : public pmr::memory_resource {
+private:
+    struct Chunk {
+        char *memory;
+        size_t size;
+    };
+
+    pmr::memory_resource *_upstream_;
+    size_t _chunk_size_;
+    vector<Chunk> _chunks_;
+    // the chunk being filled and the free space left in it
+    size_t _current_ = 0;
+    char *_next_ = nullptr;
+    char *_end_ = nullptr;
+    size_t _used_ = 0;
+
+    // moves on to a chunk (an old one when it is large enough) with room for bytes at alignment
+    void nextChunk(size_t bytes, size_t alignment);
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const pmr::memory_resource &other) const noexcept override;
+
+public:
+    // constructor
+    explicit ArenaResource(size_t chunk_size = 1 << 20, pmr::memory_resource *upstream = pmr::get_default_resource());
+
+    ArenaResource(const ArenaResource &arena) = delete;
+
+    ArenaResource &operator=(const ArenaResource &arena) = delete;
+
+    // destructor
+    ~ArenaResource() override;
+
+    // ===== FUNCTIONS =====
+
+    // frees every allocation at once, the shapes using the arena must be gone or cleared
+    void reset();
+
+    // reset and return the chunks to the upstream resource
+    void release();
+
+    // bytes handed out since the last reset
+    size_t used() const;
+
+    // bytes held from the upstream resource
+    size_t capacity() const;
+};
+
+#endif //PROGLAB_2_1_ARENA_H
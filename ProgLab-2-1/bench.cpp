@@ -0,0 +1,775 @@
+#include "arena.h"
+#include "fixed.h"
+#include "geometry.h"
+#include "grid.h"
+#include "hull.h"
+#include "kernels.h"
+#include "metrics.h"
+#include "minkowski.h"
+#include "overlay.h"
+#include "prepared.h"
+#include "reader.h"
+#include "regular.h"
+#include "rtree.h"
+#include "simplify.h"
+#include "stats.h"
+#include "sweep.h"
+#include "triangulate.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+// Microbenchmarks for the hot paths. Every input is generated from a fixed seed,
+// results are written as JSON to the file given as the first argument (stdout otherwise).
+//
+//   geometry_bench [output.json] [name filter]
+
+namespace {
+    const unsigned SEED = 20211015;
+
+    const double MIN_SECONDS = 0.2;
+
+    const vector<long long> SIZES = {3, 10, 100, 1000, 10000, 100000, 1000000};
+
+    struct Result {
+        string name;
+        long long size;
+        long long iterations;
+        double ns_per_op;
+    };
+
+    // keeps results alive so the optimizer cannot drop the measured work
+    volatile double sink;
+
+    // runs body(iterations) with a growing iteration count until it takes MIN_SECONDS
+    Result measure(const string &name, long long size, const function<void(long long)> &body) {
+        using clock = chrono::steady_clock;
+
+        body(1);
+        long long iterations = 1;
+        while (true) {
+            auto start = clock::now();
+            body(iterations);
+            double seconds = chrono::duration<double>(clock::now() - start).count();
+            if (seconds >= MIN_SECONDS || iterations >= (1LL << 40)) {
+                return {name, size, iterations, seconds * 1e9 / (double) iterations};
+            }
+            long long grow = seconds > 0 ? (long long) (MIN_SECONDS * 1.2 / seconds * (double) iterations) : 0;
+            iterations = max(iterations * 2, min(grow, iterations * 100));
+        }
+    }
+
+    vector<Point> randomPoints(long long n, mt19937_64 &random) {
+        uniform_real_distribution<double> coordinate(-1000, 1000);
+        vector<Point> points;
+        points.reserve(n);
+        for (long long i = 0; i < n; i++) {
+            double x = coordinate(random);
+            points.emplace_back(x, coordinate(random));
+        }
+        return points;
+    }
+
+    class Suite {
+    private:
+        vector<Result> _results_;
+        string _filter_;
+        mt19937_64 _random_;
+    public:
+        explicit Suite(string filter) : _filter_(move(filter)), _random_(SEED) {}
+
+        void add(const string &name, long long size, const function<void(long long)> &body) {
+            if (name.find(_filter_) == string::npos) {
+                return;
+            }
+            _results_.push_back(measure(name, size, body));
+            const Result &result = _results_.back();
+            cerr << result.name << "/" << result.size << ": " << result.ns_per_op << " ns/op" << endl;
+        }
+
+        mt19937_64 &random() {
+            return _random_;
+        }
+
+        void write(ostream &out) const {
+            out << "{\n  \"seed\": " << SEED << ",\n  \"kernels\": \"" << kernelsName() << "\",\n";
+            out << "  \"benchmarks\": [";
+            for (size_t i = 0; i < _results_.size(); i++) {
+                const Result &result = _results_[i];
+                out << (i == 0 ? "\n" : ",\n");
+                out << "    {\"name\": \"" << result.name << "\", \"size\": " << result.size
+                    << ", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << result.ns_per_op << "}";
+            }
+            out << "\n  ]";
+            if (statsEnabled()) {
+                out << ",\n  \"stats\": " << statsJson(statsSnapshot());
+            }
+            out << "\n}\n";
+        }
+    };
+
+    void pointBenchmarks(Suite &suite) {
+        vector<Point> points = randomPoints(1024, suite.random());
+
+        suite.add("point_sum", 1, [&](long long iterations) {
+            Point acc;
+            for (long long i = 0; i < iterations; i++) {
+                acc = acc + points[i & 1023];
+            }
+            sink = acc.getX();
+        });
+        suite.add("point_difference", 1, [&](long long iterations) {
+            Point acc;
+            for (long long i = 0; i < iterations; i++) {
+                acc = acc - points[i & 1023];
+            }
+            sink = acc.getX();
+        });
+        suite.add("point_cross", 1, [&](long long iterations) {
+            double acc = 0;
+            for (long long i = 0; i < iterations; i++) {
+                acc += points[i & 1023] * points[(i + 1) & 1023];
+            }
+            sink = acc;
+        });
+        suite.add("point_equality", 1, [&](long long iterations) {
+            long long equal = 0;
+            for (long long i = 0; i < iterations; i++) {
+                equal += points[i & 1023] == points[(i * 7) & 1023];
+            }
+            sink = (double) equal;
+        });
+    }
+
+    void segmentBenchmarks(Suite &suite) {
+        vector<Point> points = randomPoints(2048, suite.random());
+        vector<DirectSegment> segments;
+        for (long long i = 0; i < 1024; i++) {
+            segments.emplace_back(points[2 * i], points[2 * i + 1]);
+        }
+
+        suite.add("segment_intersects", 1, [&](long long iterations) {
+            long long hits = 0;
+            for (long long i = 0; i < iterations; i++) {
+                hits += segments[i & 1023].intersects(segments[(i * 31 + 1) & 1023]);
+            }
+            sink = (double) hits;
+        });
+
+        SegmentPack pack;
+        for (const DirectSegment &segment: segments) {
+            pack.add(segment);
+        }
+        vector<uint64_t> mask;
+        suite.add("segment_intersects_batch", pack.size(), [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                intersectsMask(segments[i & 1023], pack, mask);
+            }
+            sink = (double) mask[0];
+        });
+    }
+
+    void lineBenchmarks(Suite &suite) {
+        for (long long n: SIZES) {
+            vector<Point> points = randomPoints(n, suite.random());
+            Polyline line;
+            ClosedPolyline closed_line;
+            for (const Point &point: points) {
+                line.elongate(point);
+            }
+            closed_line = line;
+
+            suite.add("polyline_length", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = line.length();
+                }
+            });
+            suite.add("closed_polyline_perimeter", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = closed_line.perimeter();
+                }
+            });
+            // what Polygon::area costs when its cache is cold
+            suite.add("shoelace", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = shoelace(points.data(), n);
+                }
+            });
+
+            // the same line with float and long double coordinates
+            BasicPolyline<float> float_line(line);
+            vector<BasicPoint<float>> float_points(points.size());
+            vector<BasicPoint<long double>> long_points(points.size());
+            for (size_t i = 0; i < points.size(); i++) {
+                float_points[i] = BasicPoint<float>(points[i]);
+                long_points[i] = BasicPoint<long double>(points[i]);
+            }
+            suite.add("polyline_length_float", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = float_line.length();
+                }
+            });
+            suite.add("shoelace_float", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = shoelace(float_points.data(), n);
+                }
+            });
+            suite.add("shoelace_long_double", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) shoelace(long_points.data(), n);
+                }
+            });
+        }
+    }
+
+    void polygonBenchmarks(Suite &suite) {
+        for (long long n: SIZES) {
+            RegularPolygon polygon((int) n, 1, Point());
+
+            // Polygon caches its metrics, so after the first call these measure cache hits
+            suite.add("polygon_area", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = polygon.area();
+                }
+            });
+            suite.add("polygon_perimeter", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = polygon.perimeter();
+                }
+            });
+            suite.add("regular_polygon_construct", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    RegularPolygon built((int) n, 1, Point());
+                    sink = (double) built.degree();
+                }
+            });
+
+            // the parametric shape answers without its vertexes, O(1) per query whatever n is
+            RegularShape shape(n, 1, Point());
+            vector<Point> probes;
+            uniform_real_distribution<double> coordinate(-1.2 * shape.circumradius(), 1.2 * shape.circumradius());
+            for (int i = 0; i < 1024; i++) {
+                probes.emplace_back(coordinate(suite.random()), coordinate(suite.random()));
+            }
+            suite.add("regular_shape_contains", n, [&](long long iterations) {
+                long long inside = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    inside += shape.contains(probes[i & 1023]);
+                }
+                sink = (double) inside;
+            });
+
+            // star shaped outline with jittered radii, validated by the simplicity sweep
+            vector<Point> outline;
+            uniform_real_distribution<double> radius(500, 1000);
+            for (long long i = 0; i < n; i++) {
+                double angle = 2 * M_PI * (double) i / (double) n;
+                double r = radius(suite.random());
+                outline.emplace_back(r * cos(angle), r * sin(angle));
+            }
+            suite.add("polygon_construct", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    Polygon built(outline.data(), n);
+                    sink = (double) built.degree();
+                }
+            });
+        }
+
+        suite.add("triangle_construct", 3, [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                Triangle built = {Point(0, 0), Point(4, 0), Point(1, (double) (i & 7) + 1)};
+                sink = (double) built.degree();
+            }
+        });
+        suite.add("trapezoid_construct", 4, [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                Trapezoid built = {Point(0, 0), Point(6, 0), Point(4, 2), Point(1, 2)};
+                sink = (double) built.degree();
+            }
+        });
+
+        // a million triangles as values, one contiguous block without a single allocation per triangle
+        vector<FixedTriangle> triangles;
+        vector<Point> corners = randomPoints(3 * 1000000, suite.random());
+        for (size_t i = 0; i < corners.size(); i += 3) {
+            triangles.push_back(FixedTriangle({corners[i], corners[i + 1], corners[i + 2]}));
+        }
+        suite.add("fixed_triangle_construct", 3, [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                FixedTriangle built({Point(0, 0), Point(4, 0), Point(1, (double) (i & 7) + 1)});
+                sink = built.area();
+            }
+        });
+        suite.add("fixed_triangle_area_sum", (long long) triangles.size(), [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                double sum = 0;
+                for (const FixedTriangle &triangle: triangles) {
+                    sum += triangle.area();
+                }
+                sink = sum;
+            }
+        });
+    }
+
+    void comparisonBenchmarks(Suite &suite) {
+        vector<RegularPolygon> polygons;
+        uniform_int_distribution<int> degree(3, 64);
+        uniform_real_distribution<double> side(0.5, 2);
+        for (int i = 0; i < 256; i++) {
+            polygons.emplace_back(degree(suite.random()), side(suite.random()), Point());
+        }
+
+        suite.add("polygon_less", 1, [&](long long iterations) {
+            long long less = 0;
+            for (long long i = 0; i < iterations; i++) {
+                less += polygons[i & 255] < polygons[(i * 7 + 1) & 255];
+            }
+            sink = (double) less;
+        });
+        suite.add("polygon_equal", 1, [&](long long iterations) {
+            long long equal = 0;
+            for (long long i = 0; i < iterations; i++) {
+                equal += polygons[i & 255] == polygons[(i * 7 + 1) & 255];
+            }
+            sink = (double) equal;
+        });
+        suite.add("polygon_sort", (long long) polygons.size(), [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                vector<RegularPolygon> sorted = polygons;
+                sort(sorted.begin(), sorted.end());
+                sink = sorted.front().area();
+            }
+        });
+    }
+
+    void containmentBenchmarks(Suite &suite) {
+        for (long long n: {10LL, 1000LL, 100000LL}) {
+            vector<Point> outline;
+            uniform_real_distribution<double> radius(500, 1000);
+            for (long long i = 0; i < n; i++) {
+                double angle = 2 * M_PI * (double) i / (double) n;
+                double r = radius(suite.random());
+                outline.emplace_back(r * cos(angle), r * sin(angle));
+            }
+            Polygon polygon(outline.data(), n);
+            vector<Point> queries = randomPoints(4096, suite.random());
+
+            suite.add("polygon_contains", n, [&](long long iterations) {
+                long long inside = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    inside += polygon.contains(queries[i & 4095]);
+                }
+                sink = (double) inside;
+            });
+            suite.add("prepared_polygon_build", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    PreparedPolygon prepared(polygon);
+                    sink = (double) prepared.contains(queries[i & 4095]);
+                }
+            });
+            PreparedPolygon prepared(polygon);
+            suite.add("prepared_polygon_contains", n, [&](long long iterations) {
+                long long inside = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    inside += prepared.contains(queries[i & 4095]);
+                }
+                sink = (double) inside;
+            });
+        }
+    }
+
+    void hullBenchmarks(Suite &suite) {
+        for (long long n: {1000LL, 100000LL, 10000000LL}) {
+            vector<Point> cloud = randomPoints(n, suite.random());
+            suite.add("convex_hull", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) convexHull(cloud).degree();
+                }
+            });
+        }
+    }
+
+    void simplificationBenchmarks(Suite &suite) {
+        // a circle with noise on the radius, about a tenth of the vertexes survive
+        for (long long n: {1000LL, 100000LL}) {
+            vector<Point> outline;
+            uniform_real_distribution<double> noise(-1, 1);
+            for (long long i = 0; i < n; i++) {
+                double angle = 2 * M_PI * (double) i / (double) n;
+                double r = 1000 + noise(suite.random());
+                outline.emplace_back(r * cos(angle), r * sin(angle));
+            }
+            Polyline line(outline.data(), n);
+            Polygon polygon(outline.data(), n);
+            double tolerance = 2, area = 1000 * M_PI * M_PI / (double) n;
+
+            suite.add("douglas_peucker_polyline", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) douglasPeucker(line, tolerance).size();
+                }
+            });
+            suite.add("douglas_peucker_polygon", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) douglasPeucker(polygon, tolerance).degree();
+                }
+            });
+            suite.add("visvalingam_polyline", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) visvalingam(line, area).size();
+                }
+            });
+            suite.add("visvalingam_polygon", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) visvalingam(polygon, area).degree();
+                }
+            });
+            suite.add("streaming_simplifier", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    long long emitted = 0;
+                    StreamingSimplifier simplifier(tolerance, [&](const Point &) { emitted++; }, 1024);
+                    for (const Point &vertex: outline) {
+                        simplifier.elongate(vertex);
+                    }
+                    simplifier.finish();
+                    sink = (double) emitted;
+                }
+            });
+        }
+    }
+
+    void triangulationBenchmarks(Suite &suite) {
+        // spiky outlines, about a third of the vertexes are split or merge vertexes
+        for (long long n: {1000LL, 100000LL}) {
+            vector<Point> outline;
+            uniform_real_distribution<double> radius(500, 1000);
+            for (long long i = 0; i < n; i++) {
+                double angle = 2 * M_PI * (double) i / (double) n;
+                double r = radius(suite.random());
+                outline.emplace_back(r * cos(angle), r * sin(angle));
+            }
+            Polygon polygon(outline.data(), n);
+            vector<long long> indexes;
+            suite.add("triangulate_indexes", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    triangulate(polygon, indexes);
+                }
+                sink = (double) indexes.size();
+            });
+            vector<Triangle> triangles;
+            suite.add("triangulate_triangles", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    triangulate(polygon, triangles);
+                }
+                sink = (double) triangles.size();
+            });
+        }
+    }
+
+    void overlayBenchmarks(Suite &suite) {
+        // two wavy discs a third of their radius apart, the boundaries cross a few dozen times
+        for (long long n: {1000LL, 100000LL}) {
+            vector<Point> first, second;
+            for (long long i = 0; i < n; i++) {
+                double angle = 2 * M_PI * (double) i / (double) n;
+                double r = 1000 + 50 * sin(7 * angle);
+                first.emplace_back(r * cos(angle), r * sin(angle));
+                r = 1000 + 50 * sin(11 * angle);
+                second.emplace_back(300 + r * cos(angle), r * sin(angle));
+            }
+            Polygon A(first.data(), n), B(second.data(), n);
+            suite.add("overlay_build", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) Overlay(A, B).size();
+                }
+            });
+            Overlay overlay(A, B);
+            suite.add("overlay_union", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) overlay.result(BooleanOperation::UNION).size();
+                }
+            });
+        }
+    }
+
+    void minkowskiBenchmarks(Suite &suite) {
+        // a convex footprint grown by a convex obstacle, and by a disc
+        for (long long n: {8LL, 64LL, 1024LL}) {
+            RegularPolygon footprint((int) n, 1, Point()), obstacle((int) n, 2, Point(5, 5), 0.3);
+            RegularShape disc(16, 0.4, Point());
+            suite.add("minkowski_convex", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) minkowskiSum(footprint, obstacle).degree();
+                }
+            });
+            suite.add("minkowski_disc", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) minkowskiSum(footprint, disc).degree();
+                }
+            });
+        }
+
+        // a star shaped footprint goes through its triangles
+        for (long long n: {8LL, 32LL}) {
+            vector<Point> outline;
+            for (long long i = 0; i < n; i++) {
+                double angle = 2 * M_PI * (double) i / (double) n;
+                double r = i % 2 == 0 ? 10 : 6;
+                outline.emplace_back(r * cos(angle), r * sin(angle));
+            }
+            Polygon star(outline.data(), n);
+            RegularShape disc(16, 0.4, Point());
+            suite.add("minkowski_nonconvex_disc", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) minkowskiSum(star, disc).degree();
+                }
+            });
+        }
+    }
+
+    void batchBenchmarks(Suite &suite) {
+        // many small polygons of mixed degree, the nightly workload in miniature
+        vector<RegularPolygon> source;
+        uniform_int_distribution<int> degree(3, 64);
+        for (int i = 0; i < 100000; i++) {
+            source.emplace_back(degree(suite.random()), 1, Point());
+        }
+        for (unsigned threads: {1U, 0U}) {
+            // the caches are cold in every iteration, as they are on freshly read polygons
+            suite.add(threads == 1 ? "batch_metrics_serial" : "batch_metrics_parallel", (long long) source.size(),
+                      [&](long long iterations) {
+                          for (long long i = 0; i < iterations; i++) {
+                              vector<RegularPolygon> polygons = source;
+                              sink = batchMetrics(polygons, threads)[i % polygons.size()].area;
+                          }
+                      });
+        }
+    }
+
+    void arenaBenchmarks(Suite &suite) {
+        // a request-scoped job: build a batch of small lines, measure them, drop them all
+        vector<Point> outline;
+        for (int i = 0; i < 16; i++) {
+            double angle = 2 * M_PI * i / 16;
+            outline.emplace_back(cos(angle), sin(angle));
+        }
+        const long long batch = 10000;
+        suite.add("polyline_batch_heap", batch, [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                vector<Polyline> lines;
+                lines.reserve(batch);
+                for (long long k = 0; k < batch; k++) {
+                    lines.emplace_back(outline.data(), (long long) outline.size());
+                }
+                sink = lines[i % batch].length();
+            }
+        });
+        ArenaResource arena;
+        suite.add("polyline_batch_arena", batch, [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                {
+                    vector<Polyline> lines;
+                    lines.reserve(batch);
+                    for (long long k = 0; k < batch; k++) {
+                        lines.emplace_back(outline.data(), (long long) outline.size(), &arena);
+                    }
+                    sink = lines[i % batch].length();
+                }
+                arena.reset();
+            }
+        });
+    }
+
+    // the star outline of polygonBenchmarks on a millimetre grid, validated and measured exactly
+    void gridBenchmarks(Suite &suite) {
+        Grid grid(0.001);
+        for (long long n: {10LL, 1000LL, 100000LL}) {
+            vector<Point> outline;
+            uniform_real_distribution<double> radius(500, 1000);
+            for (long long i = 0; i < n; i++) {
+                double angle = 2 * M_PI * (double) i / (double) n;
+                double r = radius(suite.random());
+                outline.emplace_back(r * cos(angle), r * sin(angle));
+            }
+            Polygon polygon(outline.data(), n);
+            GridPolygon snapped = grid.snap(polygon);
+            vector<GridPoint> vertexes;
+            for (const Point &point: outline) {
+                vertexes.push_back(grid.snap(point));
+            }
+
+            suite.add("grid_snap", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) grid.snap(polygon).degree();
+                }
+            });
+            suite.add("grid_polygon_construct", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    GridPolygon built(vertexes.data(), n);
+                    sink = (double) built.degree();
+                }
+            });
+            suite.add("grid_shoelace", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    sink = (double) shoelace(vertexes.data(), n);
+                }
+            });
+        }
+    }
+
+    void indexBenchmarks(Suite &suite) {
+        uniform_real_distribution<double> offset(-5, 5);
+        for (long long n: {1000LL, 100000LL, 1000000LL}) {
+            vector<Point> points = randomPoints(n, suite.random());
+            vector<DirectSegment> segments;
+            for (const Point &point: points) {
+                segments.emplace_back(point, point + Point(offset(suite.random()), offset(suite.random())));
+            }
+            vector<Box> windows;
+            for (const Point &corner: randomPoints(1024, suite.random())) {
+                windows.emplace_back(corner, corner + Point(20, 20));
+            }
+
+            suite.add("rtree_build", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    RTree tree(segments.begin(), segments.end());
+                    sink = (double) tree.size();
+                }
+            });
+            RTree tree(segments.begin(), segments.end());
+            vector<long long> items;
+            suite.add("rtree_search", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    tree.search(windows[i & 1023], items);
+                }
+                sink = (double) items.size();
+            });
+            // what the same window query costs without the index
+            suite.add("linear_search", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    items.clear();
+                    for (long long j = 0; j < n; j++) {
+                        if (segments[j].boundingBox().intersects(windows[i & 1023])) {
+                            items.push_back(j);
+                        }
+                    }
+                }
+                sink = (double) items.size();
+            });
+            suite.add("rtree_segment_intersections", n, [&](long long iterations) {
+                long long hits = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    const DirectSegment &segment = segments[(i * 31) % n];
+                    tree.candidates(segment, items);
+                    for (long long item: items) {
+                        hits += segment.intersects(segments[item]);
+                    }
+                }
+                sink = (double) hits;
+            });
+        }
+    }
+
+    void sweepBenchmarks(Suite &suite) {
+        uniform_real_distribution<double> offset(-20, 20);
+        for (long long n: {1000LL, 100000LL}) {
+            vector<Point> points = randomPoints(n, suite.random());
+            vector<DirectSegment> segments;
+            for (const Point &point: points) {
+                segments.emplace_back(point, point + Point(offset(suite.random()), offset(suite.random())));
+            }
+            vector<SegmentIntersection> intersections;
+            suite.add("all_intersections", n, [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    allIntersections(segments, intersections);
+                }
+                sink = (double) intersections.size();
+            });
+            if (n > 1000) {
+                continue;
+            }
+            // the same pairs by testing every one of them
+            suite.add("all_intersections_brute_force", n, [&](long long iterations) {
+                long long hits = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    for (long long a = 0; a < n; a++) {
+                        for (long long b = a + 1; b < n; b++) {
+                            hits += segments[a].intersects(segments[b]);
+                        }
+                    }
+                }
+                sink = (double) hits;
+            });
+        }
+    }
+
+    void readerBenchmarks(Suite &suite) {
+        // 1000 line strings of 100 vertices each, the size is the text length in bytes
+        ostringstream wkt, geojson;
+        wkt.precision(17);
+        geojson.precision(17);
+        geojson << "{\"type\":\"FeatureCollection\",\"features\":[";
+        for (int feature = 0; feature < 1000; feature++) {
+            vector<Point> points = randomPoints(100, suite.random());
+            wkt << "LINESTRING (";
+            geojson << (feature == 0 ? "" : ",") << "{\"type\":\"Feature\",\"geometry\":"
+                    << "{\"type\":\"LineString\",\"coordinates\":[";
+            for (size_t i = 0; i < points.size(); i++) {
+                wkt << (i == 0 ? "" : ", ") << points[i].getX() << " " << points[i].getY();
+                geojson << (i == 0 ? "[" : ",[") << points[i].getX() << "," << points[i].getY() << "]";
+            }
+            wkt << ")\n";
+            geojson << "]}}";
+        }
+        geojson << "]}";
+        string wkt_text = wkt.str(), geojson_text = geojson.str();
+
+        auto count = [](GeometryBatch &batch) { sink = (double) batch.polylines.size(); };
+        suite.add("wkt_parse", (long long) wkt_text.size(), [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                parseWKT(wkt_text.data(), (long long) wkt_text.size(), count);
+            }
+        });
+        suite.add("geojson_parse", (long long) geojson_text.size(), [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                parseGeoJSON(geojson_text.data(), (long long) geojson_text.size(), count);
+            }
+        });
+    }
+}
+
+int main(int argc, char **argv) {
+    string output = argc > 1 ? argv[1] : "-";
+    Suite suite(argc > 2 ? argv[2] : "");
+
+    pointBenchmarks(suite);
+    segmentBenchmarks(suite);
+    lineBenchmarks(suite);
+    polygonBenchmarks(suite);
+    comparisonBenchmarks(suite);
+    containmentBenchmarks(suite);
+    hullBenchmarks(suite);
+    overlayBenchmarks(suite);
+    minkowskiBenchmarks(suite);
+    simplificationBenchmarks(suite);
+    triangulationBenchmarks(suite);
+    batchBenchmarks(suite);
+    arenaBenchmarks(suite);
+    gridBenchmarks(suite);
+    indexBenchmarks(suite);
+    sweepBenchmarks(suite);
+    readerBenchmarks(suite);
+
+    if (output == "-") {
+        suite.write(cout);
+    } else {
+        ofstream file(output);
+        suite.write(file);
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+#ifndef PROGLAB_2_1_FIXED_H
+#define PROGLAB_2_1_FIXED_H
+
+#include "geometry.h"
+#include "predicates.h"
+#include <algorithm>
+#include <array>
+
+// Polygons with a number of vertexes fixed at compile time, as plain values.
+//
+// The vertexes sit in a std::array inside the object: no heap buffer, no type
+// tag and no vtable, so a FixedTriangle is six doubles, copies with memcpy and
+// a vector of them is one contiguous block. Building one checks nothing, like
+// building a Point; the checks of Polygon, Triangle and Trapezoid run when a
+// fixed polygon is turned into one of them. Everything that only needs
+// arithmetic is constexpr.
+
+template<size_t N>
+class FixedPolygon {
+    static_assert(N >= 3, "a polygon has at least three vertexes");
+
+private:
+    array<Point, N> _vertexes_;
+
+public:
+    // constructor (every vertex at the origin)
+    constexpr FixedPolygon() : _vertexes_() {}
+
+    constexpr FixedPolygon(const array<Point, N> &vertexes) : _vertexes_(vertexes) {}
+
+    // a polygon of N vertexes (a Triangle, a Trapezoid...), any other one
+    // gives every vertex at the origin without output (see tryMake)
+    explicit FixedPolygon(Polygon &polygon) : _vertexes_() {
+        if (polygon.degree() != (long long) N) {
+            return;
+        }
+        const Point *vertexes = polygon.data();
+        for (size_t i = 0; i < N; i++) {
+            _vertexes_[i] = vertexes[i];
+        }
+    }
+
+    // as the constructor, but a polygon of another degree is reported as WRONG_DEGREE
+    static Checked<FixedPolygon> tryMake(Polygon &polygon) {
+        Checked<FixedPolygon> result{FixedPolygon(polygon), ShapeStatus()};
+        if (polygon.degree() != (long long) N) {
+            result.status.error = ShapeError::WRONG_DEGREE;
+        }
+        return result;
+    }
+
+    // indexing operator
+    constexpr Point &operator[](size_t idx) { return _vertexes_[idx]; }
+
+    constexpr const Point &operator[](size_t idx) const { return _vertexes_[idx]; }
+
+    // equality operator
+    friend constexpr bool operator==(const FixedPolygon &A, const FixedPolygon &B) {
+        for (size_t i = 0; i < N; i++) {
+            if (A._vertexes_[i] != B._vertexes_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // inequality operator
+    friend constexpr bool operator!=(const FixedPolygon &A, const FixedPolygon &B) {
+        return !(A == B);
+    }
+
+    // output operator
+    friend ostream &operator<<(ostream &out, const FixedPolygon &polygon) {
+        out << "[";
+        for (size_t i = 0; i < N; i++) {
+            out << (i == 0 ? "" : ", ") << polygon._vertexes_[i];
+        }
+        out << "]";
+        return out;
+    }
+
+    // ===== FUNCTIONS =====
+
+    constexpr long long degree() const { return (long long) N; }
+
+    constexpr const Point *data() const { return _vertexes_.data(); }
+
+    // twice the signed area, positive for counterclockwise vertexes
+    constexpr double doubleSignedArea() const {
+        double sum = 0;
+        for (size_t i = 0; i < N; i++) {
+            sum += _vertexes_[i] * _vertexes_[i + 1 == N ? 0 : i + 1];
+        }
+        return sum;
+    }
+
+    constexpr double area() const {
+        double sum = doubleSignedArea();
+        return (sum < 0 ? -sum : sum) / 2;
+    }
+
+    // 1 for counterclockwise vertexes, -1 for clockwise, 0 for a degenerate polygon
+    constexpr int orientation() const {
+        double sum = doubleSignedArea();
+        return (sum > 0) - (sum < 0);
+    }
+
+    double perimeter() const {
+        double sum = 0;
+        for (size_t i = 0; i < N; i++) {
+            sum += DirectSegment(_vertexes_[i], _vertexes_[i + 1 == N ? 0 : i + 1]).length();
+        }
+        return sum;
+    }
+
+    Box boundingBox() const {
+        Box box;
+        for (const Point &vertex: _vertexes_) {
+            box.expand(vertex);
+        }
+        return box;
+    }
+
+    // the rule of Polygon::contains: points on the boundary are inside
+    bool contains(const Point &point) const {
+        bool inside = false;
+        for (size_t i = 0; i < N; i++) {
+            Point lower = _vertexes_[i], upper = _vertexes_[i + 1 == N ? 0 : i + 1];
+            if (lower.getY() > upper.getY()) {
+                swap(lower, upper);
+            }
+            if (point.getY() < lower.getY() || point.getY() > upper.getY()) {
+                continue;
+            }
+            double side = orient2d(lower, upper, point);
+            if (side == 0 && min(lower.getX(), upper.getX()) <= point.getX() &&
+                point.getX() <= max(lower.getX(), upper.getX())) {
+                return true;
+            }
+            if (side < 0 && point.getY() < upper.getY()) {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+
+    // the same vertexes checked by Polygon, empty unless they form a simple polygon
+    Polygon toPolygon() const {
+        return Polygon(_vertexes_.data(), (long long) N);
+    }
+};
+
+using FixedTriangle = FixedPolygon<3>;
+
+// any quadrilateral; Trapezoid(fixed.data(), 4) checks for the parallel sides
+using FixedTrapezoid = FixedPolygon<4>;
+
+#endif //PROGLAB_2_1_FIXED_H
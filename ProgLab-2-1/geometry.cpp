@@ -1,108 +1,23 @@
 #include "geometry.h"
+#include "kernels.h"
+#include "predicates.h"
+#include "regular.h"
 #include <cmath>
-
-// assignment operator
-Point &Point::operator=(const Point &point) {
-    _x_ = point._x_;
-    _y_ = point._y_;
-
-    return *this;
-}
-
-// equality operator
-bool operator==(const Point &A, const Point &B) {
-    return (A._x_ == B._x_) && (A._y_ == B._y_);
-}
-
-// inequality operator
-bool operator!=(const Point &A, const Point &B) {
-    return (A._x_ != B._x_) || (A._y_ != B._y_);
-}
-
-// summation operator
-Point operator+(const Point &A, const Point &B) {
-    return Point(A._x_ + B._x_, A._y_ + B._y_);
-}
-
-// subtraction operator
-Point operator-(const Point &A, const Point &B) {
-    return Point(A._x_ - B._x_, A._y_ - B._y_);
-}
-
-//multiplication operator (pseudo scalar multiplication)
-double operator*(const Point &A, const Point &B) {
-    return A._x_ * B._y_ - B._x_ * A._y_;
-}
-
-//output operator
-ostream &operator<<(ostream &out, const Point &point) {
-    out << "(" << point._x_ << ", " << point._y_ << ")";
-    return out;
-}
-
-// ===== FUNCTIONS =====
-double Point::scalar(const Point &other) const {
-    return this->_x_ * other._x_ + this->_y_ * other._y_;
-}
-
-double Point::getX() const {
-    return _x_;
-}
-
-double Point::getY() const {
-    return _y_;
-}
-
-void Point::setX(const double &x) {
-    _x_ = x;
-}
-
-void Point::setY(const double &y) {
-    _y_ = y;
-}
-
-// assignment operator
-DirectSegment &DirectSegment::operator=(const DirectSegment &segment) {
-    _begin_ = segment._begin_;
-    _end_ = segment._end_;
-
-    return *this;
-}
-
-//multiplication operator (pseudo scalar multiplication)
-double operator*(DirectSegment A, DirectSegment B) {
-    return A.toVector().getX() * B.toVector().getY() -
-           B.toVector().getX() * A.toVector().getY();
-}
-
-// output operator
-ostream &operator<<(ostream &out, const DirectSegment &segment) {
-    out << "[" << segment._begin_ << ", " << segment._end_ << "]";
-    return out;
-}
+#include <set>
+#include <algorithm>
 
 // ===== FUNCTIONS =====
-double DirectSegment::length() {
+template<class T>
+typename BasicDirectSegment<T>::Measure BasicDirectSegment<T>::length() const {
     return sqrt(pow(_end_.getX() - _begin_.getX(), 2) + pow(_end_.getY() - _begin_.getY(), 2));
 }
 
-double DirectSegment::scalar(DirectSegment other) {
-    return this->toVector().getX() * other.toVector().getX() +
-           this->toVector().getY() * other.toVector().getY();
-}
-
-Point DirectSegment::toVector() {
-    return _end_ - _begin_;
-}
-
-DirectSegment &DirectSegment::reverse() {
-    swap(_begin_, _end_);
-    return *this;
-}
+template<class T>
+bool BasicDirectSegment<T>::intersects(const BasicDirectSegment &other) const {
+    GEOMETRY_COUNT(intersects_calls, 1);
 
-bool DirectSegment::intersects(DirectSegment other) {
-    double min_this, max_this;
-    double min_other, max_other;
+    T min_this, max_this;
+    T min_other, max_other;
 
     min_this = min(this->_begin_.getX(), this->_end_.getX());
     max_this = max(this->_begin_.getX(), this->_end_.getX());
@@ -124,52 +39,129 @@ bool DirectSegment::intersects(DirectSegment other) {
         return false;
     }
 
-    if (((this->_begin_ - other._begin_) * this->toVector()) *
-        ((this->_begin_ - other._end_) * this->toVector()) > 0) {
+    // the endpoints of each segment may not lie strictly on the same side of the other one
+    auto first = orient2d(this->_begin_, this->_end_, other._begin_);
+    auto second = orient2d(this->_begin_, this->_end_, other._end_);
+    if ((first > 0 && second > 0) || (first < 0 && second < 0)) {
         return false;
     }
 
-    if (((other._begin_ - this->_begin_) * other.toVector()) *
-        ((other._begin_ - this->_end_) * other.toVector()) > 0) {
+    first = orient2d(other._begin_, other._end_, this->_begin_);
+    second = orient2d(other._begin_, other._end_, this->_end_);
+    if ((first > 0 && second > 0) || (first < 0 && second < 0)) {
         return false;
     }
 
     return true;
 }
 
-Polyline::Polyline(initializer_list<Point> vertexes) {
-    _vertexes_.clear();
-    for (const Point &point: vertexes) {
-        _vertexes_.push_back(point);
+template<class T>
+BasicBox<T> BasicDirectSegment<T>::boundingBox() const {
+    return Box().expand(_begin_).expand(_end_);
+}
+
+
+namespace {
+    // a coordinate above all others: infinity, or the largest integer for integer coordinates
+    template<class T>
+    constexpr T farthest() {
+        return numeric_limits<T>::has_infinity ? numeric_limits<T>::infinity() : numeric_limits<T>::max();
+    }
+}
+
+// constructor
+template<class T>
+BasicBox<T>::BasicBox() : _lower_(farthest<T>(), farthest<T>()), _upper_(-farthest<T>(), -farthest<T>()) {}
+
+// ===== FUNCTIONS =====
+
+template<class T>
+BasicPoint<T> BasicBox<T>::getLower() const {
+    return _lower_;
+}
+
+template<class T>
+BasicPoint<T> BasicBox<T>::getUpper() const {
+    return _upper_;
+}
+
+template<class T>
+bool BasicBox<T>::isEmpty() const {
+    return _lower_.getX() > _upper_.getX() || _lower_.getY() > _upper_.getY();
+}
+
+template<class T>
+bool BasicBox<T>::contains(const Point &point) const {
+    return _lower_.getX() <= point.getX() && point.getX() <= _upper_.getX() &&
+           _lower_.getY() <= point.getY() && point.getY() <= _upper_.getY();
+}
+
+template<class T>
+bool BasicBox<T>::intersects(const BasicBox &other) const {
+    return _lower_.getX() <= other._upper_.getX() && other._lower_.getX() <= _upper_.getX() &&
+           _lower_.getY() <= other._upper_.getY() && other._lower_.getY() <= _upper_.getY();
+}
+
+template<class T>
+BasicBox<T> &BasicBox<T>::expand(const Point &point) {
+    _lower_ = Point(min(_lower_.getX(), point.getX()), min(_lower_.getY(), point.getY()));
+    _upper_ = Point(max(_upper_.getX(), point.getX()), max(_upper_.getY(), point.getY()));
+    return *this;
+}
+
+template<class T>
+BasicPolyline<T>::BasicPolyline(const T *coordinates, long long n, pmr::memory_resource *resource)
+        : _vertexes_(resource) {
+    _vertexes_.reserve(n);
+    for (long long i = 0; i < n; i++) {
+        _vertexes_.emplace_back(coordinates[2 * i], coordinates[2 * i + 1]);
+    }
+}
+
+template<class T>
+BasicPolyline<T>::BasicPolyline(const T *x, const T *y, long long n, pmr::memory_resource *resource)
+        : _vertexes_(resource) {
+    _vertexes_.reserve(n);
+    for (long long i = 0; i < n; i++) {
+        _vertexes_.emplace_back(x[i], y[i]);
     }
 }
 
 //copy constructor
-Polyline::Polyline(const Polyline &line) {
+template<class T>
+BasicPolyline<T>::BasicPolyline(const BasicPolyline &line) {
     _vertexes_.clear();
     _vertexes_ = line._vertexes_;
 }
 
+// move constructor
+template<class T>
+BasicPolyline<T>::BasicPolyline(BasicPolyline &&line) noexcept: _vertexes_(move(line._vertexes_)) {}
+
 // assignment operator
-Polyline &Polyline::operator=(const Polyline &line) {
+template<class T>
+BasicPolyline<T> &BasicPolyline<T>::operator=(const BasicPolyline &line) {
     _vertexes_.clear();
     _vertexes_ = line._vertexes_;
 
     return *this;
 }
 
-Polyline &Polyline::operator=(initializer_list<Point> vertexes) {
-    _vertexes_.clear();
-
-    for (const Point &point: vertexes) {
-        _vertexes_.push_back(point);
-    }
+template<class T>
+BasicPolyline<T> &BasicPolyline<T>::operator=(BasicPolyline &&line) noexcept {
+    _vertexes_ = move(line._vertexes_);
+    return *this;
+}
 
+template<class T>
+BasicPolyline<T> &BasicPolyline<T>::operator=(initializer_list<Point> vertexes) {
+    _vertexes_.assign(vertexes);
     return *this;
 }
 
 // indexing operator
-Point &Polyline::operator[](const long long &idx) {
+template<class T>
+BasicPoint<T> &BasicPolyline<T>::operator[](const long long &idx) {
     if (idx >= 0 && idx < _vertexes_.size()) {
         return _vertexes_[idx];
     } else {
@@ -178,61 +170,77 @@ Point &Polyline::operator[](const long long &idx) {
     }
 }
 
-//output operator
-ostream &operator<<(ostream &out, Polyline &line) {
-    out << "[";
-    for (int i = 0; i < line.size(); i++) {
-        if (i != 0) {
-            out << ", ";
-        }
-        out << line[i];
-    }
-    out << "]";
-    return out;
-}
-
 // ===== FUNCTIONS =====
 
-long long Polyline::size() {
+template<class T>
+long long BasicPolyline<T>::size() {
     return _vertexes_.size();
 }
 
-void Polyline::clear() {
+template<class T>
+void BasicPolyline<T>::clear() {
     _vertexes_.clear();
 }
 
-void Polyline::elongate(const Point &vertex) {
+template<class T>
+void BasicPolyline<T>::elongate(const Point &vertex) {
     _vertexes_.push_back(vertex);
 }
 
-double Polyline::length() {
-    double _length_ = 0;
-    for (int i = 0; i < _vertexes_.size() - 1; i++) {
-        _length_ += sqrt(pow(_vertexes_[i + 1].getX() - _vertexes_[i].getX(), 2)
-                         + pow(_vertexes_[i + 1].getY() - _vertexes_[i].getY(), 2));
+template<class T>
+typename BasicPolyline<T>::Measure BasicPolyline<T>::length() {
+    GEOMETRY_TIME(length);
+    return chainLength(_vertexes_.data(), (long long) _vertexes_.size());
+}
+
+template<class T>
+BasicBox<T> BasicPolyline<T>::boundingBox() {
+    Box box;
+    for (const Point &vertex: _vertexes_) {
+        box.expand(vertex);
     }
-    return _length_;
+    return box;
+}
+
+template<class T>
+pmr::memory_resource *BasicPolyline<T>::resource() const {
+    return _vertexes_.resource();
+}
+
+template<class T>
+const BasicPoint<T> *BasicPolyline<T>::data() const {
+    return _vertexes_.data();
 }
 
 
 // assignment operator
-ClosedPolyline &ClosedPolyline::operator=(const ClosedPolyline &closed_line) {
+template<class T>
+BasicClosedPolyline<T> &BasicClosedPolyline<T>::operator=(const BasicClosedPolyline &closed_line) {
     Polyline::operator=(closed_line);
     return *this;
 }
 
-ClosedPolyline &ClosedPolyline::operator=(const Polyline &line) {
+template<class T>
+BasicClosedPolyline<T> &BasicClosedPolyline<T>::operator=(BasicClosedPolyline &&closed_line) noexcept {
+    Polyline::operator=(move(closed_line));
+    return *this;
+}
+
+template<class T>
+BasicClosedPolyline<T> &BasicClosedPolyline<T>::operator=(const Polyline &line) {
     Polyline::operator=(line);
     return *this;
 }
 
-ClosedPolyline &ClosedPolyline::operator=(initializer_list<Point> vertexes) {
+template<class T>
+BasicClosedPolyline<T> &BasicClosedPolyline<T>::operator=(initializer_list<Point> vertexes) {
     Polyline::operator=(vertexes);
     return *this;
 }
 
 // indexing operator
-Point &ClosedPolyline::operator[](const long long &idx) {
+template<class T>
+BasicPoint<T> &BasicClosedPolyline<T>::operator[](const long long &idx) {
     if (idx < 0) {
         return Polyline::operator[](((idx % Polyline::size()) + Polyline::size()) % Polyline::size());
     } else {
@@ -240,250 +248,687 @@ Point &ClosedPolyline::operator[](const long long &idx) {
     }
 }
 
-//output operator
-ostream &operator<<(ostream &out, ClosedPolyline &closed_line) {
-    out << "[";
-    for (int i = 0; i < closed_line.size(); i++) {
-        if (i != 0) {
-            out << ", ";
-        }
-        out << closed_line[i];
-    }
-
-    out << " >>]";
-    return out;
-}
-
 // ===== FUNCTIONS =====
 
-long long ClosedPolyline::size() {
+template<class T>
+long long BasicClosedPolyline<T>::size() {
     return Polyline::size();
 }
 
-double ClosedPolyline::perimeter() {
-    double _perimeter_ = Polyline::length();
-    _perimeter_ += sqrt(
-            pow(operator[](0).getX() - operator[](size() - 1).getX(), 2) +
-            pow(operator[](0).getY() - operator[](size() - 1).getY(), 2));
-    return _perimeter_;
+template<class T>
+typename BasicClosedPolyline<T>::Measure BasicClosedPolyline<T>::perimeter() {
+    GEOMETRY_TIME(perimeter);
+    return loopLength(this->data(), Polyline::size());
 }
 
 
-bool Polygon::isAdequate(const Point &new_vertex) {
-    for (int i = 1; i < size() - 1; i++) {
-        if (DirectSegment(operator[](size() - 1), new_vertex).intersects(
-                DirectSegment(operator[](i - 1), operator[](i)))) {
-            return false;
+namespace {
+    // polygons up to this degree are validated without the sweep
+    const long long SMALL_POLYGON = 16;
+
+    // edge of a polygon as seen by the sweep line: left is lexicographically smaller
+    template<class T>
+    struct SweepEdge {
+        BasicPoint<T> left;
+        BasicPoint<T> right;
+        long long idx;
+    };
+
+    template<class T>
+    struct SweepEvent {
+        BasicPoint<T> point;
+        bool is_insertion;
+        long long edge;
+    };
+
+    template<class T>
+    bool lexLess(const BasicPoint<T> &A, const BasicPoint<T> &B) {
+        return A.getX() < B.getX() || (A.getX() == B.getX() && A.getY() < B.getY());
+    }
+
+    template<class T>
+    int orient(const BasicPoint<T> &A, const BasicPoint<T> &B, const BasicPoint<T> &C) {
+        auto det = orient2d(A, B, C);
+        return (det > 0) - (det < 0);
+    }
+
+    // position of the newer edge relative to the older one just right of the sweep line
+    template<class T>
+    int sideOf(const SweepEdge<T> &older, const SweepEdge<T> &newer) {
+        int side = orient(older.left, older.right, newer.left);
+        if (side == 0) {
+            side = orient(older.left, older.right, newer.right);
         }
+        return side;
     }
-    return true;
+
+    template<class T>
+    struct SweepOrder {
+        const vector<SweepEdge<T>> *edges;
+
+        bool operator()(long long a, long long b) const {
+            if (a == b) {
+                return false;
+            }
+            const SweepEdge<T> &A = (*edges)[a];
+            const SweepEdge<T> &B = (*edges)[b];
+            int side;
+            if (lexLess(B.left, A.left)) {
+                side = -sideOf(B, A);
+            } else {
+                side = sideOf(A, B);
+            }
+            if (side != 0) {
+                return side > 0;
+            }
+            return a < b;
+        }
+    };
 }
 
-bool Polygon::isClosed() {
-    if (size() <= 2) {
+template<class T>
+bool BasicPolygon<T>::isAdequate(long long &first_edge, long long &second_edge) {
+    first_edge = second_edge = -1;
+    GEOMETRY_COUNT(validations, 1);
+
+    long long n = this->size();
+    if (n <= 2) {
         return false;
     }
-    for (int i = 2; i < size() - 1; i++) {
-        if (DirectSegment(operator[](size() - 1), operator[](0)).intersects(
-                DirectSegment(operator[](i - 1), operator[](i)))) {
+    if (n == 3) {
+        return true;
+    }
+
+    const Point *points = this->data();
+
+    // a repeated vertex makes the edges around it touch
+    for (long long i = 0; i < n; i++) {
+        if (points[i] == points[(i + 1) % n]) {
+            first_edge = (i + n - 1) % n;
+            second_edge = (i + 1) % n;
             return false;
         }
     }
-    return true;
-}
 
-double Polygon::det(const Point &A, const Point &B) {
-    return A.getX() * B.getY() - B.getX() * A.getY();
-}
+    // adjacent edges may only share their common vertex, any other pair may not touch at all
+    auto conflicts = [&](long long a, long long b) {
+        GEOMETRY_COUNT(validation_checks, 1);
+        if (a > b) {
+            swap(a, b);
+        }
+        if (b - a == 1 || b - a == n - 1) {
+            long long shared = (b - a == 1) ? b : a;
+            const Point &prev = points[(shared + n - 1) % n];
+            const Point &vertex = points[shared];
+            const Point &next = points[(shared + 1) % n];
+            // collinear neighbours overlap when both lie on the same side of the shared vertex
+            return orient(prev, vertex, next) == 0 && lexLess(prev, vertex) == lexLess(next, vertex);
+        }
+        return BasicDirectSegment<T>(points[a], points[(a + 1) % n]).intersects(
+                BasicDirectSegment<T>(points[b], points[(b + 1) % n]));
+    };
+
+    // a small polygon is checked pair by pair: cheaper than the sweep and free of allocations
+    if (n <= SMALL_POLYGON) {
+        for (long long a = 0; a < n; a++) {
+            for (long long b = a + 1; b < n; b++) {
+                if (conflicts(a, b)) {
+                    first_edge = a;
+                    second_edge = b;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    vector<SweepEdge<T>> edges;
+    vector<SweepEvent<T>> events;
+    edges.reserve(n);
+    events.reserve(2 * n);
+    for (long long i = 0; i < n; i++) {
+        const Point &A = points[i];
+        const Point &B = points[(i + 1) % n];
+        if (lexLess(A, B)) {
+            edges.push_back({A, B, i});
+        } else {
+            edges.push_back({B, A, i});
+        }
+        events.push_back({edges[i].left, true, i});
+        events.push_back({edges[i].right, false, i});
+    }
+
+    // insertions go before removals at the same point, so edges that only touch there are compared
+    sort(events.begin(), events.end(), [](const SweepEvent<T> &A, const SweepEvent<T> &B) {
+        if (A.point != B.point) {
+            return lexLess(A.point, B.point);
+        }
+        return A.is_insertion && !B.is_insertion;
+    });
 
+    set<long long, SweepOrder<T>> status(SweepOrder<T>{&edges});
+    vector<typename set<long long, SweepOrder<T>>::iterator> position(n);
 
-Polygon::Polygon(initializer_list<Point> vertexes) : ClosedPolyline(vertexes), _type_("...") {
-    clear();
-    for (const Point &point: vertexes) {
-        if (isAdequate(point)) {
-            ClosedPolyline::elongate(point);
+    auto report = [&](long long a, long long b) {
+        first_edge = min(a, b);
+        second_edge = max(a, b);
+        return false;
+    };
+
+    for (const SweepEvent<T> &event: events) {
+        if (event.is_insertion) {
+            auto it = status.insert(event.edge).first;
+            position[event.edge] = it;
+            auto next = std::next(it);
+            if (next != status.end() && conflicts(*it, *next)) {
+                return report(*it, *next);
+            }
+            if (it != status.begin() && conflicts(*it, *std::prev(it))) {
+                return report(*it, *std::prev(it));
+            }
         } else {
-            clear();
-            cout << "<Polygon> The points do not form a polygon" << endl;
-            return;
+            auto it = position[event.edge];
+            auto next = std::next(it);
+            if (it != status.begin() && next != status.end()) {
+                auto prev = std::prev(it);
+                if (conflicts(*prev, *next)) {
+                    return report(*prev, *next);
+                }
+            }
+            status.erase(it);
         }
     }
-    if (!isClosed()) {
+    return true;
+}
+
+
+template<class T>
+void BasicPolygon<T>::validate() {
+    long long first_edge, second_edge;
+    if (!isAdequate(first_edge, second_edge)) {
         clear();
-        cout << "<Polygon> The points do not form a polygon" << endl;
+        if (first_edge < 0) {
+            cout << "<Polygon> The points do not form a polygon" << endl;
+        } else {
+            cout << "<Polygon> The points do not form a polygon (edges " << first_edge << " and "
+                 << second_edge << " intersect)" << endl;
+        }
+    }
+}
+
+
+template<class T>
+ShapeStatus BasicPolygon<T>::check() {
+    ShapeStatus status;
+    long long first_edge, second_edge;
+    if (isAdequate(first_edge, second_edge)) {
+        return status;
+    }
+    long long n = degree();
+    const Point *points = this->data();
+    if (first_edge < 0) {
+        status.error = ShapeError::TOO_FEW_VERTEXES;
+    } else if (second_edge == (first_edge + 2) % n && points[second_edge] == points[(first_edge + 1) % n]) {
+        // isAdequate reports a repeated vertex as the edges on either side of it
+        status.error = ShapeError::REPEATED_VERTEX;
+        status.vertex = second_edge;
+    } else {
+        status.error = ShapeError::EDGES_INTERSECT;
+        status.vertex = first_edge;
+        status.edge = second_edge;
     }
+    clear();
+    return status;
+}
+
+const char *describe(ShapeError error) {
+    switch (error) {
+        case ShapeError::NONE:
+            return "";
+        case ShapeError::TOO_FEW_VERTEXES:
+            return "The points do not form a polygon";
+        case ShapeError::REPEATED_VERTEX:
+            return "The points do not form a polygon (a vertex is repeated)";
+        case ShapeError::EDGES_INTERSECT:
+            return "The points do not form a polygon (edges intersect)";
+        case ShapeError::WRONG_DEGREE:
+            return "The number of vertexes is wrong";
+        case ShapeError::NOT_A_TRAPEZOID:
+            return "The points do not form a trapezoid";
+        case ShapeError::UNEQUAL_SIDES:
+            return "The points do not form a regular polygon";
+        case ShapeError::INVALID_SIDE:
+            return "The side length is not a positive number";
+        case ShapeError::OUTSIDE_GRID:
+            return "The point is outside the grid";
+    }
+    return "";
+}
+
+
+template<class T>
+BasicPolygon<T>::BasicPolygon(initializer_list<Point> vertexes, pmr::memory_resource *resource)
+        : ClosedPolyline(vertexes, resource) {
+    validate();
+}
+
+template<class T>
+BasicPolygon<T>::BasicPolygon(const Point *vertexes, long long n, pmr::memory_resource *resource)
+        : ClosedPolyline(vertexes, n, resource) {
+    validate();
+}
+
+template<class T>
+BasicPolygon<T>::BasicPolygon(const T *coordinates, long long n, pmr::memory_resource *resource)
+        : ClosedPolyline(coordinates, n, resource) {
+    validate();
+}
+
+template<class T>
+BasicPolygon<T>::BasicPolygon(const T *x, const T *y, long long n, pmr::memory_resource *resource)
+        : ClosedPolyline(x, y, n, resource) {
+    validate();
+}
+
+template<class T>
+BasicPolygon<T>::BasicPolygon(vector<Point> &&vertexes) : ClosedPolyline(move(vertexes)) {
+    validate();
+}
+
+template<class T>
+BasicPolygon<T>::BasicPolygon(pmr::vector<Point> &&vertexes) : ClosedPolyline(move(vertexes)) {
+    validate();
+}
+
+template<class T>
+Checked<BasicPolygon<T>> BasicPolygon<T>::tryMake(const Point *vertexes, long long n,
+                                                  pmr::memory_resource *resource) {
+    Checked<BasicPolygon> result{BasicPolygon(vertexes, n, resource, Trusted()), ShapeStatus()};
+    result.status = result.shape.check();
+    return result;
+}
+
+template<class T>
+Checked<BasicPolygon<T>> BasicPolygon<T>::tryMake(pmr::vector<Point> &&vertexes) {
+    Checked<BasicPolygon> result{BasicPolygon(move(vertexes), Trusted()), ShapeStatus()};
+    result.status = result.shape.check();
+    return result;
+}
+
+//copy constructor
+template<class T>
+BasicPolygon<T>::BasicPolygon(const BasicPolygon &polygon) : ClosedPolyline(polygon), _type_(polygon._type_) {
+    copyCache(polygon);
+}
+
+template<class T>
+BasicPolygon<T>::BasicPolygon(const BasicPolygon &polygon, pmr::memory_resource *resource)
+        : ClosedPolyline(polygon, resource), _type_(polygon._type_) {
+    copyCache(polygon);
+}
+
+// move constructor
+template<class T>
+BasicPolygon<T>::BasicPolygon(BasicPolygon &&polygon) noexcept: ClosedPolyline(move(polygon)),
+                                                                _type_(polygon._type_) {
+    copyCache(polygon);
+    polygon.invalidate();
 }
 
 // assignment operator
-Polygon &Polygon::operator=(const Polygon &polygon) {
+template<class T>
+BasicPolygon<T> &BasicPolygon<T>::operator=(const BasicPolygon &polygon) {
     ClosedPolyline::operator=(polygon);
+    copyCache(polygon);
+    return *this;
+}
+
+template<class T>
+BasicPolygon<T> &BasicPolygon<T>::operator=(BasicPolygon &&polygon) noexcept {
+    ClosedPolyline::operator=(move(polygon));
+    copyCache(polygon);
+    polygon.invalidate();
     return *this;
-};
+}
+
+// ===== FUNCTIONS =====
+
+template<class T>
+long long BasicPolygon<T>::degree() {
+    return ClosedPolyline::size();
+}
+
+template<class T>
+typename BasicPolygon<T>::Measure BasicPolygon<T>::perimeter() {
+    if (!(_cached_ & PERIMETER_CACHED)) {
+        _perimeter_ = ClosedPolyline::perimeter();
+        _cached_ |= PERIMETER_CACHED;
+    }
+    return _perimeter_;
+}
 
-// equality operator
-bool operator==(Polygon &A, Polygon &B) {
-    return A.area() == B.area();
+template<class T>
+typename BasicPolygon<T>::Measure BasicPolygon<T>::area() {
+    Product double_area = doubleSignedArea();
+    return (Measure) (double_area < 0 ? -double_area : double_area) / 2;
 }
 
-// inequality operator
-bool operator!=(Polygon &A, Polygon &B) {
-    return A.area() != B.area();
+template<class T>
+typename BasicPolygon<T>::Product BasicPolygon<T>::doubleSignedArea() {
+    if (!(_cached_ & AREA_CACHED)) {
+        GEOMETRY_TIME(area);
+        _double_area_ = shoelace(this->data(), degree());
+        _cached_ |= AREA_CACHED;
+    }
+    return _double_area_;
 }
 
-// less operator
-bool operator<(Polygon &A, Polygon &B) {
-    return A.area() < B.area();
+template<class T>
+int BasicPolygon<T>::orientation() {
+    Product double_area = doubleSignedArea();
+    return (double_area > 0) - (double_area < 0);
 }
 
-// greater operator
-bool operator>(Polygon &A, Polygon &B) {
-    return A.area() > B.area();
+template<class T>
+BasicBox<T> BasicPolygon<T>::boundingBox() {
+    if (!(_cached_ & BOX_CACHED)) {
+        _box_ = Box();
+        const Point *vertexes = this->data();
+        for (long long i = 0; i < degree(); i++) {
+            _box_.expand(vertexes[i]);
+        }
+        _cached_ |= BOX_CACHED;
+    }
+    return _box_;
 }
 
-// output operator
-ostream &operator<<(ostream &out, Polygon &polygon) {
-    out << "[" << polygon._type_ << "][";
-    for (int i = 0; i < polygon.size(); i++) {
-        if (i != 0) {
-            out << ", ";
+template<class T>
+bool BasicPolygon<T>::contains(const Point &point) {
+    if (!boundingBox().contains(point)) {
+        return false;
+    }
+    const Point *vertexes = this->data();
+    long long n = degree();
+    bool inside = false;
+    for (long long i = 0; i < n; i++) {
+        Point lower = vertexes[i], upper = vertexes[(i + 1) % n];
+        if (lower.getY() > upper.getY()) {
+            swap(lower, upper);
+        }
+        if (point.getY() < lower.getY() || point.getY() > upper.getY()) {
+            continue;
+        }
+        auto side = orient2d(lower, upper, point);
+        if (side == 0 && min(lower.getX(), upper.getX()) <= point.getX() &&
+            point.getX() <= max(lower.getX(), upper.getX())) {
+            return true;
+        }
+        // edges crossing the ray to the left of the point, counted for lower <= y < upper
+        if (side < 0 && point.getY() < upper.getY()) {
+            inside = !inside;
         }
-        out << polygon[i];
     }
+    return inside;
+}
 
-    out << "]";
-    return out;
+// indexing operator
+template<class T>
+BasicPoint<T> &BasicPolygon<T>::operator[](const long long &idx) {
+    invalidate();
+    return ClosedPolyline::operator[](idx);
 }
 
-// ===== FUNCTIONS =====
+template<class T>
+PolygonType BasicPolygon<T>::getType() const {
+    return _type_;
+}
 
-long long Polygon::degree() {
-    return ClosedPolyline::size();
+template<class T>
+void BasicPolygon<T>::setType(PolygonType type) {
+    _type_ = type;
 }
 
-double Polygon::perimeter() {
-    return ClosedPolyline::perimeter();
+template<class T>
+void BasicPolygon<T>::add(const Point &point) {
+    elongate(point);
 }
 
-double Polygon::area() {
-    double _area_ = 0;
-    for (int i = 0; i < size() - 1; i++) {
-        _area_ += det(operator[](i), operator[](i + 1));
-    }
+template<class T>
+void BasicPolygon<T>::elongate(const Point &vertex) {
+    invalidate();
+    ClosedPolyline::elongate(vertex);
+}
 
-    return abs(_area_) / 2;
+template<class T>
+void BasicPolygon<T>::clear() {
+    invalidate();
+    ClosedPolyline::clear();
 }
 
-void Polygon::setType(const string &type_name) {
-    _type_ = type_name;
+template<class T>
+void BasicPolygon<T>::invalidate() {
+    _cached_ = 0;
 }
 
-void Polygon::add(const Point &point) {
-    elongate(point);
+template<class T>
+void BasicPolygon<T>::copyCache(const BasicPolygon &polygon) {
+    _cached_ = polygon._cached_;
+    _double_area_ = polygon._double_area_;
+    _perimeter_ = polygon._perimeter_;
+    _box_ = polygon._box_;
 }
 
 
-Triangle::Triangle() : Polygon() {
-    setType("tri");
+template<class T>
+BasicTriangle<T>::BasicTriangle() : Polygon() {
+    this->setType(PolygonType::TRIANGLE);
 }
 
-Triangle::Triangle(initializer_list<Point> vertexes) : Polygon(vertexes) {
-    setType("tri");
-    if (vertexes.size() != 3) {
-        clear();
+template<class T>
+BasicTriangle<T>::BasicTriangle(const Point &A, const Point &B, const Point &C, typename Polygon::Trusted)
+        : Polygon(pmr::vector<Point>{A, B, C}, typename Polygon::Trusted()) {
+    this->setType(PolygonType::TRIANGLE);
+}
+
+template<class T>
+BasicTriangle<T>::BasicTriangle(initializer_list<Point> vertexes)
+        : BasicTriangle(vertexes.begin(), (long long) vertexes.size()) {}
+
+template<class T>
+BasicTriangle<T>::BasicTriangle(const Point *vertexes, long long n) : Polygon(vertexes, n) {
+    this->setType(PolygonType::TRIANGLE);
+    if (n != 3) {
+        this->clear();
         cout << "<Triangle> The number of vertexes is not equal to 3" << endl;
     }
 }
 
 
-Trapezoid::Trapezoid() : Polygon() {
-    setType("tpz");
+template<class T>
+Checked<BasicTriangle<T>> BasicTriangle<T>::tryMake(const Point *vertexes, long long n) {
+    if (n != 3) {
+        return {BasicTriangle(), {ShapeError::WRONG_DEGREE}};
+    }
+    // three vertexes are never rejected by the polygon check, repeated or collinear ones included
+    return {BasicTriangle(vertexes[0], vertexes[1], vertexes[2], typename Polygon::Trusted()), ShapeStatus()};
 }
 
-Trapezoid::Trapezoid(initializer_list<Point> vertexes) : Polygon(vertexes) {
-    setType("tpz");
-    if (vertexes.size() != 4) {
-        clear();
-        cout << "<Trapezoid> The number of vertexes is not equal to 4" << endl;
-    } else {
-        vector<Point> _vertexes_;
-        bool first_pair, second_pair;
 
-        for (const Point &point: vertexes) {
-            _vertexes_.push_back(point);
+namespace {
+    // exactly one pair of opposite sides is parallel
+    template<class T>
+    bool formsTrapezoid(const BasicPoint<T> *vertexes) {
+        bool first_pair = crossSign(vertexes[0], vertexes[1], vertexes[2], vertexes[3]) == 0;
+        bool second_pair = crossSign(vertexes[1], vertexes[2], vertexes[3], vertexes[0]) == 0;
+        return first_pair != second_pair;
+    }
+
+    // the end of the first side not as long as the first one, -1 when all sides are equal
+    template<class T>
+    long long unequalSide(const BasicPoint<T> *vertexes, long long n) {
+        for (long long i = 2; i < n; i++) {
+            if (BasicDirectSegment<T>(vertexes[i - 1], vertexes[i]).length() !=
+                BasicDirectSegment<T>(vertexes[0], vertexes[1]).length()) {
+                return i;
+            }
         }
-        first_pair = DirectSegment(_vertexes_[0], _vertexes_[1]) *
-                     DirectSegment(_vertexes_[2], _vertexes_[3]) == 0;
+        return -1;
+    }
+}
 
-        second_pair = DirectSegment(_vertexes_[1], _vertexes_[2]) *
-                      DirectSegment(_vertexes_[3], _vertexes_[0]) == 0;
+template<class T>
+BasicTrapezoid<T>::BasicTrapezoid() : Polygon() {
+    this->setType(PolygonType::TRAPEZOID);
+}
 
-        if (first_pair == second_pair) {
-            clear();
-            cout << "<Trapezoid> The points do not form a trapezoid" << endl;
-        }
+template<class T>
+BasicTrapezoid<T>::BasicTrapezoid(initializer_list<Point> vertexes)
+        : BasicTrapezoid(vertexes.begin(), (long long) vertexes.size()) {}
+
+template<class T>
+BasicTrapezoid<T>::BasicTrapezoid(const Point *vertexes, long long n) : Polygon(vertexes, n) {
+    this->setType(PolygonType::TRAPEZOID);
+    if (n != 4) {
+        this->clear();
+        cout << "<Trapezoid> The number of vertexes is not equal to 4" << endl;
+    } else if (!formsTrapezoid(vertexes)) {
+        this->clear();
+        cout << "<Trapezoid> The points do not form a trapezoid" << endl;
+    }
+}
+
+template<class T>
+Checked<BasicTrapezoid<T>> BasicTrapezoid<T>::tryMake(const Point *vertexes, long long n) {
+    Checked<BasicTrapezoid> result;
+    if (n != 4) {
+        result.status.error = ShapeError::WRONG_DEGREE;
+        return result;
+    }
+    result.shape.Polygon::operator=(Polygon(vertexes, n, pmr::get_default_resource(), typename Polygon::Trusted()));
+    result.status = result.shape.check();
+    if (result.status && !formsTrapezoid(vertexes)) {
+        result.shape.clear();
+        result.status.error = ShapeError::NOT_A_TRAPEZOID;
     }
+    return result;
 }
 
 // constructor
-RegularPolygon::RegularPolygon() : Polygon() {
-    setType("reg");
+template<class T>
+BasicRegularPolygon<T>::BasicRegularPolygon() : Polygon() {
+    this->setType(PolygonType::REGULAR);
 }
 
-RegularPolygon::RegularPolygon(initializer_list<Point> vertexes) : Polygon(vertexes) {
-    setType("reg");
-    vector<Point> _vertexes_;
-    double prev;
+template<class T>
+BasicRegularPolygon<T>::BasicRegularPolygon(initializer_list<Point> vertexes)
+        : BasicRegularPolygon(vertexes.begin(), (long long) vertexes.size()) {}
 
-    for (const Point &point: vertexes) {
-        _vertexes_.push_back(point);
+template<class T>
+BasicRegularPolygon<T>::BasicRegularPolygon(const Point *vertexes, long long n) : Polygon(vertexes, n) {
+    this->setType(PolygonType::REGULAR);
+    if (unequalSide(vertexes, n) >= 0) {
+        this->clear();
+        cout << "<RegularPolygon> The points do not form a regular polygon" << endl;
     }
+}
 
-    for (int i = 1; i < _vertexes_.size(); i++) {
-        if (i == 1) {
-            prev = DirectSegment(_vertexes_[i - 1], _vertexes_[i]).length();
-        } else {
-            if (DirectSegment(_vertexes_[i - 1], _vertexes_[i]).length() != prev) {
-                clear();
-                cout << "<RegularPolygon> The points do not form a regular polygon" << endl;
-                return;
-            }
+template<class T>
+Checked<BasicRegularPolygon<T>> BasicRegularPolygon<T>::tryMake(const Point *vertexes, long long n) {
+    Checked<BasicRegularPolygon> result;
+    result.shape.Polygon::operator=(Polygon(vertexes, n, pmr::get_default_resource(), typename Polygon::Trusted()));
+    result.status = result.shape.check();
+    if (result.status) {
+        long long vertex = unequalSide(vertexes, n);
+        if (vertex >= 0) {
+            result.shape.clear();
+            result.status.error = ShapeError::UNEQUAL_SIDES;
+            result.status.vertex = vertex;
         }
-
     }
+    return result;
 }
 
-RegularPolygon::RegularPolygon(int n, double side_len, const Point &center) : Polygon() {
-    setType("reg");
-    if (n <= 2) {
+template<class T>
+BasicRegularPolygon<T>::BasicRegularPolygon(int n, T side_len, const Point &center, T rotation) : Polygon() {
+    this->setType(PolygonType::REGULAR);
+    Checked<BasicRegularShape<T>> shape = BasicRegularShape<T>::tryMake(n, side_len, center, rotation);
+    if (!shape.status) {
         cout << "<RegularPolygon> The points do not form a polygon" << endl;
         return;
     }
+    *this = BasicRegularPolygon(shape.shape);
+}
 
-    double x = side_len / 2;
-    double y = side_len * tan(((n - 2) * M_PI) / (2 * n)) / 2;
-
-    add(Point(x + center.getX(), y + center.getY()));
-
-    double cs, sn;
-    double new_x, new_y;
-    for (int i = 0; i < n - 1; i++) {
-        cs = cos(2 * M_PI / n);
-        sn = sin(2 * M_PI / n);
-
-        new_x = x * cs - y * sn;
-        new_y = x * sn + y * cs;
-
-        add(Point(new_x + center.getX(), new_y + center.getY()));
-
-        x = new_x;
-        y = new_y;
+template<class T>
+BasicRegularPolygon<T>::BasicRegularPolygon(const BasicRegularShape<T> &shape) : Polygon() {
+    this->setType(PolygonType::REGULAR);
+    long long n = shape.degree();
+    if (n == 0) {
+        return;
     }
+    if (n <= GEOMETRY_INLINE_VERTEXES) {
+        Point vertexes[GEOMETRY_INLINE_VERTEXES];
+        shape.vertexes(vertexes);
+        Polygon::operator=(Polygon(vertexes, n, pmr::get_default_resource(), typename Polygon::Trusted()));
+    } else {
+        pmr::vector<Point> vertexes((size_t) n);
+        shape.vertexes(vertexes.data());
+        Polygon::operator=(Polygon(move(vertexes), typename Polygon::Trusted()));
+    }
+    this->_double_area_ = 2 * shape.area();
+    this->_perimeter_ = shape.perimeter();
+    this->_cached_ |= Polygon::AREA_CACHED | Polygon::PERIMETER_CACHED;
+}
+
+template<class T>
+Checked<BasicRegularPolygon<T>> BasicRegularPolygon<T>::tryMake(int n, T side_len, const Point &center, T rotation) {
+    Checked<BasicRegularShape<T>> shape = BasicRegularShape<T>::tryMake(n, side_len, center, rotation);
+    return {BasicRegularPolygon(shape.shape), shape.status};
 }
 
 // assignment operator
-RegularPolygon &RegularPolygon::operator=(const RegularPolygon &polygon) {
+template<class T>
+BasicRegularPolygon<T> &BasicRegularPolygon<T>::operator=(const BasicRegularPolygon &polygon) {
     Polygon::operator=(polygon);
     return *this;
 }
 
 
+template class BasicBox<float>;
+template class BasicBox<double>;
+template class BasicBox<long double>;
+template class BasicBox<int64_t>;
+
+template class BasicDirectSegment<float>;
+template class BasicDirectSegment<double>;
+template class BasicDirectSegment<long double>;
+template class BasicDirectSegment<int64_t>;
+
+template class BasicPolyline<float>;
+template class BasicPolyline<double>;
+template class BasicPolyline<long double>;
+template class BasicPolyline<int64_t>;
+
+template class BasicClosedPolyline<float>;
+template class BasicClosedPolyline<double>;
+template class BasicClosedPolyline<long double>;
+template class BasicClosedPolyline<int64_t>;
+
+template class BasicPolygon<float>;
+template class BasicPolygon<double>;
+template class BasicPolygon<long double>;
+template class BasicPolygon<int64_t>;
+
+template class BasicTriangle<float>;
+template class BasicTriangle<double>;
+template class BasicTriangle<long double>;
+template class BasicTriangle<int64_t>;
+
+template class BasicTrapezoid<float>;
+template class BasicTrapezoid<double>;
+template class BasicTrapezoid<long double>;
+template class BasicTrapezoid<int64_t>;
+
+template class BasicRegularPolygon<float>;
+template class BasicRegularPolygon<double>;
+template class BasicRegularPolygon<long double>;
@@ -1,111 +1,500 @@
 #ifndef PROGLAB_2_1_GEOMETRY_H
 #define PROGLAB_2_1_GEOMETRY_H
 
+#include "stats.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 using namespace std;
 
-class Point {
+// Every shape is a template over the type of its coordinates: float, double,
+// long double or int64_t (geometry.cpp builds the shapes for these four). The
+// names without the Basic prefix (Point, Polygon...) are the double versions.
+// float halves the memory of a shape and doubles the width of the vectorised
+// kernels; int64_t coordinates are steps of a grid (see grid.h) and make every
+// predicate and area exact. Converting a shape to other coordinates is always
+// explicit; the predicates stay exact for every type.
+
+// Product is the type of a product of two coordinates and Measure the type of
+// lengths and areas. Integer coordinates multiply into 128 bits, which keeps
+// the products exact for coordinates within +-2^62 and twice the area of a
+// polygon exact within +-2^61 (GRID_LIMIT in grid.h).
+template<class T>
+struct CoordinateTraits {
+    using Product = T;
+    using Measure = T;
+};
+
+template<>
+struct CoordinateTraits<int64_t> {
+    using Product = __int128;
+    using Measure = double;
+};
+
+template<class T>
+class BasicPoint {
+    static_assert(is_floating_point<T>::value || is_same<T, int64_t>::value,
+                  "coordinates are float, double, long double or int64_t");
+
 private:
-    double _x_;
-    double _y_;
+    T _x_;
+    T _y_;
 public:
+    using Scalar = T;
+    using Product = typename CoordinateTraits<T>::Product;
+
     // constructor
-    explicit Point(const double &x = 0, const double &y = 0) : _x_(x), _y_(y) {}
+    constexpr explicit BasicPoint(const T &x = 0, const T &y = 0) : _x_(x), _y_(y) {}
+
+    // conversion from other coordinates (rounded to the nearest value of T)
+    template<class U>
+    constexpr explicit BasicPoint(const BasicPoint<U> &point) : _x_((T) point.getX()), _y_((T) point.getY()) {
+        static_assert(is_floating_point<T>::value || is_integral<U>::value,
+                      "floating coordinates are snapped to a Grid explicitly");
+    }
 
     // copy constructor
-    Point(const Point &point) : _x_(point._x_), _y_(point._y_) {}
+    constexpr BasicPoint(const BasicPoint &point) = default;
 
     // assignment operator
-    Point &operator=(const Point &point);
+    constexpr BasicPoint &operator=(const BasicPoint &point) = default;
 
     // equality operator
-    friend bool operator==(const Point &A, const Point &B);
+    friend constexpr bool operator==(const BasicPoint &A, const BasicPoint &B) {
+        return (A._x_ == B._x_) && (A._y_ == B._y_);
+    }
 
     // inequality operator
-    friend bool operator!=(const Point &A, const Point &B);
+    friend constexpr bool operator!=(const BasicPoint &A, const BasicPoint &B) {
+        return (A._x_ != B._x_) || (A._y_ != B._y_);
+    }
 
     // summation operator
-    friend Point operator+(const Point &A, const Point &B);
+    friend constexpr BasicPoint operator+(const BasicPoint &A, const BasicPoint &B) {
+        return BasicPoint(A._x_ + B._x_, A._y_ + B._y_);
+    }
 
     // subtraction operator
-    friend Point operator-(const Point &A, const Point &B);
+    friend constexpr BasicPoint operator-(const BasicPoint &A, const BasicPoint &B) {
+        return BasicPoint(A._x_ - B._x_, A._y_ - B._y_);
+    }
 
     //multiplication operator (pseudo scalar multiplication)
-    friend double operator*(const Point &A, const Point &B);
+    friend constexpr Product operator*(const BasicPoint &A, const BasicPoint &B) {
+        return (Product) A._x_ * B._y_ - (Product) B._x_ * A._y_;
+    }
 
     //output operator
-    friend ostream &operator<<(ostream &out, const Point &point);
+    friend ostream &operator<<(ostream &out, const BasicPoint &point) {
+        out << "(" << point._x_ << ", " << point._y_ << ")";
+        return out;
+    }
 
     // ===== FUNCTIONS =====
-    double scalar(const Point &other) const;
+    constexpr Product scalar(const BasicPoint &other) const {
+        return (Product) this->_x_ * other._x_ + (Product) this->_y_ * other._y_;
+    }
 
-    double getX() const;
+    constexpr T getX() const { return _x_; }
 
-    double getY() const;
+    constexpr T getY() const { return _y_; }
 
     //void abobus();
 
-    void setX(const double &x);
+    constexpr void setX(const T &x) { _x_ = x; }
+
+    constexpr void setY(const T &y) { _y_ = y; }
+};
+
+using Point = BasicPoint<double>;
+
+template<class T>
+class BasicBox {
+public:
+    using Point = BasicPoint<T>;
+private:
+    Point _lower_;
+    Point _upper_;
+public:
+    // constructor (an empty box, expanding it by a point gives that point)
+    BasicBox();
+
+    BasicBox(const Point &lower, const Point &upper) : _lower_(lower), _upper_(upper) {}
+
+    template<class U>
+    explicit BasicBox(const BasicBox<U> &box) : _lower_(box.getLower()), _upper_(box.getUpper()) {}
+
+    //output operator
+    friend ostream &operator<<(ostream &out, const BasicBox &box) {
+        out << "{" << box._lower_ << ", " << box._upper_ << "}";
+        return out;
+    }
+
+    // ===== FUNCTIONS =====
+
+    Point getLower() const;
+
+    Point getUpper() const;
 
-    void setY(const double &y);
+    bool isEmpty() const;
+
+    bool contains(const Point &point) const;
+
+    bool intersects(const BasicBox &other) const;
+
+    BasicBox &expand(const Point &point);
 };
 
-class DirectSegment {
+using Box = BasicBox<double>;
+
+template<class T>
+class BasicDirectSegment {
+public:
+    using Point = BasicPoint<T>;
+    using Box = BasicBox<T>;
+    using Product = typename CoordinateTraits<T>::Product;
+    using Measure = typename CoordinateTraits<T>::Measure;
 private:
     Point _begin_;
     Point _end_;
 public:
     // constructor
-    DirectSegment(const Point &begin, const Point &end) : _begin_(begin), _end_(end) {}
+    constexpr BasicDirectSegment(const Point &begin, const Point &end) : _begin_(begin), _end_(end) {}
+
+    template<class U>
+    constexpr explicit BasicDirectSegment(const BasicDirectSegment<U> &segment)
+            : _begin_(segment.getBegin()), _end_(segment.getEnd()) {}
 
     // copy constructor
-    DirectSegment(const DirectSegment &segment) : _begin_(segment._begin_), _end_(segment._end_) {}
+    constexpr BasicDirectSegment(const BasicDirectSegment &segment) = default;
 
     // assignment operator
-    DirectSegment &operator=(const DirectSegment &segment);
+    constexpr BasicDirectSegment &operator=(const BasicDirectSegment &segment) = default;
 
     //multiplication operator (pseudo scalar multiplication)
-    friend double operator*(DirectSegment A, DirectSegment B);
+    friend constexpr Product operator*(const BasicDirectSegment &A, const BasicDirectSegment &B) {
+        return A.toVector() * B.toVector();
+    }
 
     // output operator
-    friend ostream &operator<<(ostream &out, const DirectSegment &segment);
+    friend ostream &operator<<(ostream &out, const BasicDirectSegment &segment) {
+        out << "[" << segment._begin_ << ", " << segment._end_ << "]";
+        return out;
+    }
 
     // ===== FUNCTIONS =====
-    double length();
+    Measure length() const;
+
+    constexpr Product scalar(const BasicDirectSegment &other) const {
+        return toVector().scalar(other.toVector());
+    }
+
+    constexpr Point toVector() const {
+        return _end_ - _begin_;
+    }
+
+    constexpr BasicDirectSegment &reverse() {
+        Point begin = _begin_;
+        _begin_ = _end_;
+        _end_ = begin;
+        return *this;
+    }
+
+    bool intersects(const BasicDirectSegment &other) const;
+
+    Box boundingBox() const;
+
+    constexpr Point getBegin() const { return _begin_; }
+
+    constexpr Point getEnd() const { return _end_; }
+};
+
+using DirectSegment = BasicDirectSegment<double>;
+
+// enables the iterator range constructors for iterators over points of type P
+template<class InputIt, class P>
+using PointIterator = enable_if_t<is_convertible<typename iterator_traits<InputIt>::reference, const P &>::value>;
+
+// vertexes a line or polygon keeps inside the object before it allocates
+#ifndef GEOMETRY_INLINE_VERTEXES
+#define GEOMETRY_INLINE_VERTEXES 16
+#endif
+
+// Vertex storage of the lines and polygons. Up to GEOMETRY_INLINE_VERTEXES
+// vertexes sit inside the object, so building a small shape allocates
+// nothing; a longer line moves to a pmr::vector on the memory resource of the
+// buffer and stays there (clearing it keeps that allocation for reuse).
+//
+// Every shape draws its vertex buffer from a memory resource, the global heap
+// unless another one (an ArenaResource, a pool) is passed in. Moves keep the
+// resource of the source, copies go to the default resource unless given one,
+// and assignments keep the resource of the target.
+template<class T>
+class BasicVertexBuffer {
+public:
+    using Point = BasicPoint<T>;
+private:
+    static constexpr long long INLINE = GEOMETRY_INLINE_VERTEXES;
+    static_assert(INLINE >= 1, "the inline storage holds at least one vertex");
+
+    pmr::vector<Point> _heap_;
+    // number of inline vertexes, -1 once they live in _heap_
+    long long _inline_size_ = 0;
+    union {
+        Point _inline_[INLINE];
+    };
+
+    void spill(long long capacity) {
+        size_t before = _heap_.capacity();
+        _heap_.reserve(max(capacity, 2 * INLINE));
+        _heap_.assign(_inline_, _inline_ + _inline_size_);
+        _inline_size_ = -1;
+        counted(before);
+    }
+
+    // counts an allocation when the heap vector grew past the capacity it had before
+    void counted(size_t before) const {
+        if (GEOMETRY_STATS && _heap_.capacity() != before) {
+            GEOMETRY_COUNT(buffer_allocations, 1);
+            GEOMETRY_COUNT(buffer_bytes, _heap_.capacity() * sizeof(Point));
+        }
+    }
+
+public:
+    // constructor
+    BasicVertexBuffer() {}
+
+    explicit BasicVertexBuffer(pmr::memory_resource *resource) : _heap_(resource) {}
+
+    template<class InputIt>
+    BasicVertexBuffer(InputIt first, InputIt last, pmr::memory_resource *resource) : _heap_(resource) {
+        if constexpr (is_base_of<forward_iterator_tag, typename iterator_traits<InputIt>::iterator_category>::value) {
+            reserve((long long) distance(first, last));
+        }
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
 
-    double scalar(DirectSegment other);
+    // takes over the buffer (and its resource) without copying
+    BasicVertexBuffer(pmr::vector<Point> &&vertexes) noexcept: _heap_(move(vertexes)), _inline_size_(-1) {}
 
-    Point toVector();
+    // copy constructor
+    BasicVertexBuffer(const BasicVertexBuffer &buffer, pmr::memory_resource *resource = pmr::get_default_resource())
+            : _heap_(resource) {
+        assign(buffer.begin(), buffer.end());
+    }
+
+    // move constructor
+    BasicVertexBuffer(BasicVertexBuffer &&buffer) noexcept: _heap_(move(buffer._heap_)),
+                                                            _inline_size_(buffer._inline_size_) {
+        copy(buffer._inline_, buffer._inline_ + max(_inline_size_, 0LL), _inline_);
+        buffer._inline_size_ = 0;
+    }
+
+    // assignment operator (the buffer keeps its resource)
+    BasicVertexBuffer &operator=(const BasicVertexBuffer &buffer) {
+        if (this != &buffer) {
+            assign(buffer.begin(), buffer.end());
+        }
+        return *this;
+    }
+
+    BasicVertexBuffer &operator=(BasicVertexBuffer &&buffer) noexcept {
+        if (this == &buffer) {
+            return *this;
+        }
+        if (buffer._inline_size_ < 0 && resource()->is_equal(*buffer.resource())) {
+            _heap_ = move(buffer._heap_);
+            _inline_size_ = -1;
+            buffer._inline_size_ = 0;
+        } else {
+            assign(buffer.begin(), buffer.end());
+        }
+        return *this;
+    }
+
+    // indexing operator
+    Point &operator[](long long idx) { return data()[idx]; }
 
-    DirectSegment &reverse();
+    const Point &operator[](long long idx) const { return data()[idx]; }
 
-    bool intersects(DirectSegment other);
+    // ===== FUNCTIONS =====
+
+    long long size() const { return _inline_size_ >= 0 ? _inline_size_ : (long long) _heap_.size(); }
+
+    Point *data() { return _inline_size_ >= 0 ? _inline_ : _heap_.data(); }
+
+    const Point *data() const { return _inline_size_ >= 0 ? _inline_ : _heap_.data(); }
+
+    Point *begin() { return data(); }
+
+    Point *end() { return data() + size(); }
+
+    const Point *begin() const { return data(); }
+
+    const Point *end() const { return data() + size(); }
+
+    // true once the vertexes have outgrown the inline storage
+    bool isSpilled() const { return _inline_size_ < 0; }
+
+    pmr::memory_resource *resource() const { return _heap_.get_allocator().resource(); }
+
+    void reserve(long long capacity) {
+        if (_inline_size_ < 0) {
+            size_t before = _heap_.capacity();
+            _heap_.reserve(capacity);
+            counted(before);
+        } else if (capacity > INLINE) {
+            spill(capacity);
+        }
+    }
+
+    void push_back(const Point &vertex) {
+        if (_inline_size_ >= 0) {
+            if (_inline_size_ < INLINE) {
+                _inline_[_inline_size_++] = vertex;
+                return;
+            }
+            spill(2 * INLINE);
+        }
+        size_t before = _heap_.capacity();
+        _heap_.push_back(vertex);
+        counted(before);
+    }
+
+    void emplace_back(T x, T y) {
+        push_back(Point(x, y));
+    }
+
+    void assign(const Point *first, const Point *last) {
+        long long n = last - first;
+        if (_inline_size_ >= 0 && n <= INLINE) {
+            copy(first, last, _inline_);
+            _inline_size_ = n;
+        } else {
+            size_t before = _heap_.capacity();
+            _heap_.assign(first, last);
+            _inline_size_ = -1;
+            counted(before);
+        }
+    }
+
+    void assign(initializer_list<Point> vertexes) {
+        assign(vertexes.begin(), vertexes.end());
+    }
+
+    void clear() {
+        if (_inline_size_ >= 0) {
+            _inline_size_ = 0;
+        } else {
+            _heap_.clear();
+        }
+    }
 };
 
-class Polyline {
+using VertexBuffer = BasicVertexBuffer<double>;
+
+template<class T>
+class BasicPolyline {
+public:
+    using Point = BasicPoint<T>;
+    using Box = BasicBox<T>;
+    using Measure = typename CoordinateTraits<T>::Measure;
 private:
-    vector<Point> _vertexes_;
+    BasicVertexBuffer<T> _vertexes_;
+
+    template<class U>
+    friend class BasicPolyline;
+
 public:
     //constructor
-    Polyline() = default;
+    BasicPolyline() = default;
+
+    explicit BasicPolyline(pmr::memory_resource *resource) : _vertexes_(resource) {}
+
+    BasicPolyline(initializer_list<Point> vertexes, pmr::memory_resource *resource = pmr::get_default_resource())
+            : _vertexes_(vertexes.begin(), vertexes.end(), resource) {}
 
-    Polyline(initializer_list<Point> vertexes);
+    template<class InputIt, class = PointIterator<InputIt, Point>>
+    BasicPolyline(InputIt first, InputIt last, pmr::memory_resource *resource = pmr::get_default_resource())
+            : _vertexes_(first, last, resource) {}
+
+    BasicPolyline(const Point *vertexes, long long n, pmr::memory_resource *resource = pmr::get_default_resource())
+            : _vertexes_(vertexes, vertexes + n, resource) {}
+
+    // n vertexes given as interleaved x, y pairs
+    BasicPolyline(const T *coordinates, long long n, pmr::memory_resource *resource = pmr::get_default_resource());
+
+    BasicPolyline(const T *x, const T *y, long long n,
+                  pmr::memory_resource *resource = pmr::get_default_resource());
+
+    // copies the vertexes to the default resource
+    BasicPolyline(vector<Point> &&vertexes)
+            : _vertexes_(vertexes.data(), vertexes.data() + vertexes.size(), pmr::get_default_resource()) {}
+
+    // takes over the buffer (and its resource) without copying
+    BasicPolyline(pmr::vector<Point> &&vertexes) noexcept: _vertexes_(move(vertexes)) {}
+
+    // conversion from other coordinates, every vertex rounded to the nearest value of T
+    template<class U>
+    explicit BasicPolyline(const BasicPolyline<U> &line, pmr::memory_resource *resource = pmr::get_default_resource())
+            : _vertexes_(resource) {
+        _vertexes_.reserve(line._vertexes_.size());
+        for (const BasicPoint<U> &vertex: line._vertexes_) {
+            _vertexes_.push_back(Point(vertex));
+        }
+    }
 
     //copy constructor
-    Polyline(const Polyline &line);
+    BasicPolyline(const BasicPolyline &line);
+
+    BasicPolyline(const BasicPolyline &line, pmr::memory_resource *resource) : _vertexes_(line._vertexes_, resource) {}
+
+    // move constructor
+    BasicPolyline(BasicPolyline &&line) noexcept;
 
     // assignment operator
-    virtual Polyline &operator=(const Polyline &line);
+    virtual BasicPolyline &operator=(const BasicPolyline &line);
+
+    BasicPolyline &operator=(BasicPolyline &&line) noexcept;
 
-    virtual Polyline &operator=(initializer_list<Point> vertexes);
+    virtual BasicPolyline &operator=(initializer_list<Point> vertexes);
 
     // indexing operator
     virtual Point &operator[](const long long &idx);
 
+    // checked indexing that prints nothing, nullptr when idx is out of range
+    Point *tryAt(long long idx) { return idx >= 0 && idx < _vertexes_.size() ? &_vertexes_[idx] : nullptr; }
+
+    const Point *tryAt(long long idx) const {
+        return idx >= 0 && idx < _vertexes_.size() ? &_vertexes_[idx] : nullptr;
+    }
+
+    // unchecked indexing, idx must be in [0, size())
+    Point &uncheckedAt(long long idx) { return _vertexes_[idx]; }
+
+    const Point &uncheckedAt(long long idx) const { return _vertexes_[idx]; }
+
     //output operator
-    friend ostream &operator<<(ostream &out, Polyline &line);
+    friend ostream &operator<<(ostream &out, BasicPolyline &line) {
+        out << "[";
+        for (int i = 0; i < line.size(); i++) {
+            if (i != 0) {
+                out << ", ";
+            }
+            out << line[i];
+        }
+        out << "]";
+        return out;
+    }
 
     // ===== FUNCTIONS =====
 
@@ -115,121 +504,483 @@ public:
 
     virtual void elongate(const Point &vertex);
 
-    virtual double length();
+    virtual Measure length();
+
+    Box boundingBox();
+
+    // where the vertexes live
+    pmr::memory_resource *resource() const;
+
+protected:
+    // contiguous vertex buffer for the bulk kernels
+    const Point *data() const;
 };
 
-class ClosedPolyline : protected Polyline {
+using Polyline = BasicPolyline<double>;
+
+template<class T>
+class BasicClosedPolyline : protected BasicPolyline<T> {
+public:
+    using Point = BasicPoint<T>;
+    using Polyline = BasicPolyline<T>;
+    using Measure = typename CoordinateTraits<T>::Measure;
+private:
+    template<class U>
+    friend class BasicClosedPolyline;
+
 public:
     //constructor
-    ClosedPolyline() : Polyline() {}
+    BasicClosedPolyline() : Polyline() {}
+
+    explicit BasicClosedPolyline(pmr::memory_resource *resource) : Polyline(resource) {}
 
-    ClosedPolyline(const Polyline &_line_) : Polyline(_line_) {}
+    BasicClosedPolyline(const Polyline &_line_) : Polyline(_line_) {}
 
-    ClosedPolyline(initializer_list<Point> vertexes) : Polyline(vertexes) {}
+    BasicClosedPolyline(initializer_list<Point> vertexes,
+                        pmr::memory_resource *resource = pmr::get_default_resource())
+            : Polyline(vertexes, resource) {}
+
+    template<class InputIt, class = PointIterator<InputIt, Point>>
+    BasicClosedPolyline(InputIt first, InputIt last, pmr::memory_resource *resource = pmr::get_default_resource())
+            : Polyline(first, last, resource) {}
+
+    BasicClosedPolyline(const Point *vertexes, long long n,
+                        pmr::memory_resource *resource = pmr::get_default_resource())
+            : Polyline(vertexes, n, resource) {}
+
+    BasicClosedPolyline(const T *coordinates, long long n,
+                        pmr::memory_resource *resource = pmr::get_default_resource())
+            : Polyline(coordinates, n, resource) {}
+
+    BasicClosedPolyline(const T *x, const T *y, long long n,
+                        pmr::memory_resource *resource = pmr::get_default_resource())
+            : Polyline(x, y, n, resource) {}
+
+    BasicClosedPolyline(vector<Point> &&vertexes) : Polyline(move(vertexes)) {}
+
+    BasicClosedPolyline(pmr::vector<Point> &&vertexes) noexcept: Polyline(move(vertexes)) {}
+
+    template<class U>
+    explicit BasicClosedPolyline(const BasicClosedPolyline<U> &closed_line,
+                                 pmr::memory_resource *resource = pmr::get_default_resource())
+            : Polyline(static_cast<const BasicPolyline<U> &>(closed_line), resource) {}
 
     //copy constructor
-    ClosedPolyline(const ClosedPolyline &closed_line) : Polyline(closed_line) {}
+    BasicClosedPolyline(const BasicClosedPolyline &closed_line) : Polyline(closed_line) {}
+
+    BasicClosedPolyline(const BasicClosedPolyline &closed_line, pmr::memory_resource *resource)
+            : Polyline(closed_line, resource) {}
+
+    // move constructor
+    BasicClosedPolyline(BasicClosedPolyline &&closed_line) noexcept : Polyline(move(closed_line)) {}
 
     // assignment operator
-    ClosedPolyline &operator=(const ClosedPolyline &closed_line);
+    BasicClosedPolyline &operator=(const BasicClosedPolyline &closed_line);
 
-    ClosedPolyline &operator=(const Polyline &line) override;
+    BasicClosedPolyline &operator=(BasicClosedPolyline &&closed_line) noexcept;
 
-    ClosedPolyline &operator=(initializer_list<Point> vertexes) override;
+    BasicClosedPolyline &operator=(const Polyline &line) override;
+
+    BasicClosedPolyline &operator=(initializer_list<Point> vertexes) override;
 
     // indexing operator
     Point &operator[](const long long &idx) override;
 
     //output operator
-    friend ostream &operator<<(ostream &out, ClosedPolyline &closed_line);
+    friend ostream &operator<<(ostream &out, BasicClosedPolyline &closed_line) {
+        out << "[";
+        for (int i = 0; i < closed_line.size(); i++) {
+            if (i != 0) {
+                out << ", ";
+            }
+            out << closed_line[i];
+        }
+
+        out << " >>]";
+        return out;
+    }
 
     // ===== FUNCTIONS =====
 
     long long size() override;
 
-    virtual double perimeter();
+    virtual Measure perimeter();
+
+    using Polyline::resource;
+
+    // plain indexes, they do not wrap around as operator[] does
+    using Polyline::tryAt;
+
+    using Polyline::uncheckedAt;
+};
+
+using ClosedPolyline = BasicClosedPolyline<double>;
+
+template<class T>
+class BasicPolygon;
+
+template<class T>
+class BasicTriangle;
+
+using Polygon = BasicPolygon<double>;
+
+using Triangle = BasicTriangle<double>;
+
+template<size_t N>
+class FixedPolygon;
+
+// what a Polygon was built as, operator<< prints it as a tag
+enum class PolygonType : unsigned char {
+    POLYGON, TRIANGLE, TRAPEZOID, REGULAR
+};
+
+// why a tryMake factory refused its vertexes
+enum class ShapeError : unsigned char {
+    NONE,
+    // fewer than three vertexes
+    TOO_FEW_VERTEXES,
+    // a vertex equal to the one before it
+    REPEATED_VERTEX,
+    // two edges that touch or cross
+    EDGES_INTERSECT,
+    // a triangle without 3 or a trapezoid without 4 vertexes
+    WRONG_DEGREE,
+    // neither or both pairs of opposite sides are parallel
+    NOT_A_TRAPEZOID,
+    // a side of a regular polygon not as long as the first one
+    UNEQUAL_SIDES,
+    // a regular polygon of a side length that is not a positive number
+    INVALID_SIDE,
+    // a vertex that is not finite or does not fit the grid it is snapped to (see grid.h)
+    OUTSIDE_GRID
+};
+
+// what a tryMake factory reports instead of printing
+struct ShapeStatus {
+    ShapeError error = ShapeError::NONE;
+    // the offending vertex: the repeated one, the start of the first of two
+    // intersecting edges or the end of an unequal side; -1 when there is none
+    long long vertex = -1;
+    // the second of two intersecting edges (edge i goes from vertex i to i + 1), -1 otherwise
+    long long edge = -1;
+
+    explicit operator bool() const { return error == ShapeError::NONE; }
+};
+
+// a shape and its status, the shape is empty unless the status is NONE
+template<class Shape>
+struct Checked {
+    Shape shape;
+    ShapeStatus status;
 };
 
-class Polygon : protected ClosedPolyline {
+// the message the constructors print for the error, "" for NONE
+const char *describe(ShapeError error);
+
+template<class T>
+class BasicPolygon : protected BasicClosedPolyline<T> {
+public:
+    using Point = BasicPoint<T>;
+    using Box = BasicBox<T>;
+    using ClosedPolyline = BasicClosedPolyline<T>;
+    using Product = typename CoordinateTraits<T>::Product;
+    using Measure = typename CoordinateTraits<T>::Measure;
 private:
-    string _type_;
+    PolygonType _type_ = PolygonType::POLYGON;
+
+    // metrics computed on first use and kept until the vertexes change
+    enum : unsigned {
+        AREA_CACHED = 1, PERIMETER_CACHED = 2, BOX_CACHED = 4
+    };
+    unsigned _cached_ = 0;
+    Product _double_area_ = 0;
+    Measure _perimeter_ = 0;
+    Box _box_;
+
+    void invalidate();
+
+    void copyCache(const BasicPolygon &polygon);
 
-    bool isAdequate(const Point &new_vertex);
+    // drops the vertexes (and reports why) unless they form a simple polygon
+    void validate();
 
-    bool isClosed();
+    // Shamos-Hoey sweep over all edges, O(n log n). On failure the first
+    // offending pair of edge indexes (edge i goes from vertex i to i + 1)
+    // is written to first_edge and second_edge
+    bool isAdequate(long long &first_edge, long long &second_edge);
 
-    static double det(const Point &A, const Point &B);
+    template<class U>
+    friend class BasicPolygon;
+
+    template<class U>
+    friend class BasicTrapezoid;
+
+    template<class U>
+    friend class BasicRegularPolygon;
+
+    // reads the vertexes once to build its index
+    friend class PreparedPolygon;
+
+    // reads the vertexes of its operands and builds its results unchecked
+    friend class Overlay;
+
+    friend ::Polygon convexHull(const ::Point *points, long long n, unsigned threads);
+
+    friend void triangulate(::Polygon &polygon, vector<long long> &indexes);
+
+    friend void triangulate(::Polygon &polygon, vector<::Triangle> &triangles);
+
+    template<size_t N>
+    friend class FixedPolygon;
+
+    // snaps the vertexes to its steps and back
+    friend class Grid;
+
+    // reads the vertexes of its operands, builds convex sums unchecked
+    friend ::Polygon minkowskiSum(::Polygon &first, ::Polygon &second);
+
+    friend bool isConvex(::Polygon &polygon);
+
+    friend ::Polygon douglasPeucker(::Polygon &polygon, double tolerance);
+
+    friend ::Polygon visvalingam(::Polygon &polygon, double area);
 
 public:
     //constructor
-    Polygon() : ClosedPolyline() {}
+    BasicPolygon() : ClosedPolyline() {}
+
+    explicit BasicPolygon(pmr::memory_resource *resource) : ClosedPolyline(resource) {}
+
+    BasicPolygon(initializer_list<Point> vertexes, pmr::memory_resource *resource = pmr::get_default_resource());
+
+    template<class InputIt, class = PointIterator<InputIt, Point>>
+    BasicPolygon(InputIt first, InputIt last, pmr::memory_resource *resource = pmr::get_default_resource())
+            : ClosedPolyline(first, last, resource) {
+        validate();
+    }
+
+    BasicPolygon(const Point *vertexes, long long n, pmr::memory_resource *resource = pmr::get_default_resource());
+
+    BasicPolygon(const T *coordinates, long long n, pmr::memory_resource *resource = pmr::get_default_resource());
+
+    BasicPolygon(const T *x, const T *y, long long n,
+                 pmr::memory_resource *resource = pmr::get_default_resource());
+
+    BasicPolygon(vector<Point> &&vertexes);
+
+    BasicPolygon(pmr::vector<Point> &&vertexes);
+
+    // as the constructors, but the reason of a failure is returned instead of printed
+    static Checked<BasicPolygon> tryMake(const Point *vertexes, long long n,
+                                         pmr::memory_resource *resource = pmr::get_default_resource());
 
-    Polygon(initializer_list<Point> vertexes);
+    static Checked<BasicPolygon> tryMake(pmr::vector<Point> &&vertexes);
+
+    // conversion from other coordinates keeping the type tag; rounding to a
+    // narrower type may make edges touch, so the result is checked again then
+    template<class U>
+    explicit BasicPolygon(const BasicPolygon<U> &polygon, pmr::memory_resource *resource = pmr::get_default_resource())
+            : ClosedPolyline(static_cast<const BasicClosedPolyline<U> &>(polygon), resource),
+              _type_(polygon._type_) {
+        if constexpr (numeric_limits<U>::digits > numeric_limits<T>::digits ||
+                      numeric_limits<U>::max_exponent > numeric_limits<T>::max_exponent) {
+            validate();
+        }
+    }
 
     //copy constructor
-    Polygon(const Polygon &polygon) : ClosedPolyline(polygon) {}
+    BasicPolygon(const BasicPolygon &polygon);
+
+    BasicPolygon(const BasicPolygon &polygon, pmr::memory_resource *resource);
+
+    // move constructor
+    BasicPolygon(BasicPolygon &&polygon) noexcept;
 
     // assignment operator
-    Polygon &operator=(const Polygon &polygon);
+    BasicPolygon &operator=(const BasicPolygon &polygon);
+
+    BasicPolygon &operator=(BasicPolygon &&polygon) noexcept;
 
     // equality operator
-    friend bool operator==(Polygon &A, Polygon &B);
+    friend bool operator==(BasicPolygon &A, BasicPolygon &B) {
+        return A.area() == B.area();
+    }
 
     // inequality operator
-    friend bool operator!=(Polygon &A, Polygon &B);
+    friend bool operator!=(BasicPolygon &A, BasicPolygon &B) {
+        return A.area() != B.area();
+    }
 
     // less operator
-    friend bool operator<(Polygon &A, Polygon &B);
+    friend bool operator<(BasicPolygon &A, BasicPolygon &B) {
+        return A.area() < B.area();
+    }
 
     // greater operator
-    friend bool operator>(Polygon &A, Polygon &B);
+    friend bool operator>(BasicPolygon &A, BasicPolygon &B) {
+        return A.area() > B.area();
+    }
 
     // output operator
-    friend ostream &operator<<(ostream &out, Polygon &polygon);
+    friend ostream &operator<<(ostream &out, BasicPolygon &polygon) {
+        static const char *const TAGS[] = {"...", "tri", "tpz", "reg"};
+        out << "[" << TAGS[(int) polygon._type_] << "][";
+        for (int i = 0; i < polygon.degree(); i++) {
+            if (i != 0) {
+                out << ", ";
+            }
+            out << polygon.data()[i];
+        }
+
+        out << "]";
+        return out;
+    }
 
     // ===== FUNCTIONS =====
 
     long long degree();
 
-    double perimeter() override;
+    Measure perimeter() override;
+
+    Measure area();
+
+    // twice the signed area, exact for int64_t coordinates
+    Product doubleSignedArea();
 
-    double area();
+    // 1 for counterclockwise vertexes, -1 for clockwise, 0 for a degenerate polygon
+    int orientation();
+
+    Box boundingBox();
+
+    // true for points inside the polygon or on its boundary (a point on an
+    // edge touches it, as in DirectSegment::intersects), O(n)
+    bool contains(const Point &point);
+
+    using ClosedPolyline::resource;
+
+    PolygonType getType() const;
 
 protected:
-    void setType(const string &type_name);
+    // for vertexes that form a simple polygon by construction, nothing is checked
+    struct Trusted {
+    };
+
+    BasicPolygon(pmr::vector<Point> &&vertexes, Trusted) : ClosedPolyline(move(vertexes)) {}
+
+    BasicPolygon(const Point *vertexes, long long n, pmr::memory_resource *resource, Trusted)
+            : ClosedPolyline(vertexes, n, resource) {}
+
+    // validate() without the output: drops the vertexes and says why unless they form a simple polygon
+    ShapeStatus check();
+
+    // indexing operator (the vertex may be changed through the reference, so the cache is dropped)
+    Point &operator[](const long long &idx) override;
+
+    void setType(PolygonType type);
 
     void add(const Point &point);
+
+    void elongate(const Point &vertex) override;
+
+    void clear();
 };
 
-class Triangle : public Polygon {
+// Converted triangles, trapezoids and regular polygons keep their type tag. A
+// narrowing conversion checks the polygon again, the parallel or equal sides
+// only hold up to the rounding of the new coordinates.
+
+template<class T>
+class BasicTriangle : public BasicPolygon<T> {
 public:
-    Triangle();
+    using Point = BasicPoint<T>;
+    using Polygon = BasicPolygon<T>;
+private:
+    // The three corners as they are, nothing checked: the polygon check
+    // accepts any three vertexes, so this is what the checked constructors
+    // build too. Repeated and collinear corners stay; only triangulate, whose
+    // corners are counterclockwise and not collinear, promises more.
+    BasicTriangle(const Point &A, const Point &B, const Point &C, typename Polygon::Trusted);
+
+    friend void triangulate(::Polygon &polygon, vector<::Triangle> &triangles);
 
-    Triangle(initializer_list<Point> vertexes);
+public:
+    BasicTriangle();
+
+    BasicTriangle(initializer_list<Point> vertexes);
+
+    BasicTriangle(const Point *vertexes, long long n);
+
+    static Checked<BasicTriangle> tryMake(const Point *vertexes, long long n);
+
+    template<class U>
+    explicit BasicTriangle(const BasicTriangle<U> &triangle) : Polygon(triangle) {}
 };
 
-class Trapezoid : public Polygon {
+template<class T>
+class BasicTrapezoid : public BasicPolygon<T> {
 public:
-    Trapezoid();
+    using Point = BasicPoint<T>;
+    using Polygon = BasicPolygon<T>;
+
+    BasicTrapezoid();
 
-    Trapezoid(initializer_list<Point> vertexes);
+    BasicTrapezoid(initializer_list<Point> vertexes);
+
+    BasicTrapezoid(const Point *vertexes, long long n);
+
+    static Checked<BasicTrapezoid> tryMake(const Point *vertexes, long long n);
+
+    template<class U>
+    explicit BasicTrapezoid(const BasicTrapezoid<U> &trapezoid) : Polygon(trapezoid) {}
 };
 
-class RegularPolygon : public Polygon {
+using Trapezoid = BasicTrapezoid<double>;
+
+template<class T>
+class BasicRegularShape;
+
+template<class T>
+class BasicRegularPolygon : public BasicPolygon<T> {
+    static_assert(is_floating_point<T>::value, "the vertexes of a regular polygon are not on a grid");
+
 public:
+    using Point = BasicPoint<T>;
+    using Polygon = BasicPolygon<T>;
+
     // constructor
-    RegularPolygon();
+    BasicRegularPolygon();
+
+    BasicRegularPolygon(initializer_list<Point> vertexes);
+
+    BasicRegularPolygon(const Point *vertexes, long long n);
+
+    // rotation: counterclockwise in radians, with 0 the first edge is on top and horizontal
+    BasicRegularPolygon(int n, T side_len, const Point &center, T rotation = 0);
 
-    RegularPolygon(initializer_list<Point> vertexes);
+    // the vertexes of the shape, area and perimeter taken from its closed forms
+    explicit BasicRegularPolygon(const BasicRegularShape<T> &shape);
 
-    RegularPolygon(int n, double side_len, const Point &center);
+    static Checked<BasicRegularPolygon> tryMake(const Point *vertexes, long long n);
+
+    static Checked<BasicRegularPolygon> tryMake(int n, T side_len, const Point &center, T rotation = 0);
+
+    template<class U>
+    explicit BasicRegularPolygon(const BasicRegularPolygon<U> &polygon) : Polygon(polygon) {}
 
     // copy constructor
-    explicit RegularPolygon(const Polygon &polygon) : Polygon(polygon) {};
+    explicit BasicRegularPolygon(const Polygon &polygon) : Polygon(polygon) {};
+
+    BasicRegularPolygon(const BasicRegularPolygon &polygon) = default;
+
+    // move constructor
+    BasicRegularPolygon(BasicRegularPolygon &&polygon) noexcept = default;
 
     // assignment operator
-    RegularPolygon &operator=(const RegularPolygon &polygon);
+    BasicRegularPolygon &operator=(const BasicRegularPolygon &polygon);
+
+    BasicRegularPolygon &operator=(BasicRegularPolygon &&polygon) noexcept = default;
 };
 
+using RegularPolygon = BasicRegularPolygon<double>;
 
 #endif //PROGLAB_2_1_GEOMETRY_H
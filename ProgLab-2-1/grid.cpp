@@ -0,0 +1,127 @@
+#include "grid.h"
+#include <cmath>
+
+namespace {
+    // distance from the origin in steps, NaN for coordinates that are not finite
+    double steps(double coordinate, double step) {
+        return round(coordinate / step);
+    }
+
+    bool inRange(double steps) {
+        return abs(steps) <= (double) GRID_LIMIT;
+    }
+}
+
+// constructor
+Grid::Grid(double step) : _step_(step) {
+    if (!(step > 0) || !isfinite(step)) {
+        _step_ = 1;
+        _valid_ = false;
+    }
+}
+
+// ===== FUNCTIONS =====
+
+double Grid::getStep() const {
+    return _step_;
+}
+
+bool Grid::isValid() const {
+    return _valid_;
+}
+
+bool Grid::fits(const Point &point) const {
+    return inRange(steps(point.getX(), _step_)) && inRange(steps(point.getY(), _step_));
+}
+
+GridPoint Grid::snap(const Point &point) const {
+    if (!fits(point)) {
+        return GridPoint();
+    }
+    return GridPoint((int64_t) steps(point.getX(), _step_), (int64_t) steps(point.getY(), _step_));
+}
+
+GridPolyline Grid::snap(Polyline &line) const {
+    GridPolyline snapped;
+    for (long long i = 0; i < line.size(); i++) {
+        if (!fits(line[i])) {
+            return GridPolyline();
+        }
+        GridPoint vertex = snap(line[i]);
+        if (i == 0 || vertex != snapped[snapped.size() - 1]) {
+            snapped.elongate(vertex);
+        }
+    }
+    return snapped;
+}
+
+GridPolygon Grid::snap(Polygon &polygon) const {
+    return move(trySnap(polygon).shape);
+}
+
+Checked<GridPolygon> Grid::trySnap(Polygon &polygon) const {
+    const Point *vertexes = polygon.data();
+    long long n = polygon.degree();
+    pmr::vector<GridPoint> snapped;
+    snapped.reserve(n);
+    // origin[k]: the last vertex of the polygon merged into snapped[k], the one its edge starts at
+    vector<long long> origin;
+    origin.reserve(n);
+    for (long long i = 0; i < n; i++) {
+        if (!fits(vertexes[i])) {
+            Checked<GridPolygon> result;
+            result.status.error = ShapeError::OUTSIDE_GRID;
+            result.status.vertex = i;
+            return result;
+        }
+        GridPoint vertex = snap(vertexes[i]);
+        if (snapped.empty() || vertex != snapped.back()) {
+            snapped.push_back(vertex);
+            origin.push_back(i);
+        } else {
+            origin.back() = i;
+        }
+    }
+    while (snapped.size() > 1 && snapped.back() == snapped.front()) {
+        snapped.pop_back();
+    }
+    Checked<GridPolygon> result = GridPolygon::tryMake(move(snapped));
+    if (result.status) {
+        result.shape.setType(polygon.getType());
+    } else {
+        // the indexes of tryMake count the merged vertexes
+        if (result.status.vertex >= 0) {
+            result.status.vertex = origin[result.status.vertex];
+        }
+        if (result.status.edge >= 0) {
+            result.status.edge = origin[result.status.edge];
+        }
+    }
+    return result;
+}
+
+Point Grid::toPoint(const GridPoint &point) const {
+    return Point((double) point.getX() * _step_, (double) point.getY() * _step_);
+}
+
+Polyline Grid::toPolyline(GridPolyline &line) const {
+    Polyline converted;
+    for (long long i = 0; i < line.size(); i++) {
+        converted.elongate(toPoint(line[i]));
+    }
+    return converted;
+}
+
+Polygon Grid::toPolygon(GridPolygon &polygon) const {
+    const GridPoint *vertexes = polygon.data();
+    pmr::vector<Point> converted;
+    converted.reserve(polygon.degree());
+    for (long long i = 0; i < polygon.degree(); i++) {
+        converted.push_back(toPoint(vertexes[i]));
+    }
+    Checked<Polygon> result = Polygon::tryMake(move(converted));
+    if (result.status) {
+        result.shape.setType(polygon.getType());
+    }
+    return move(result.shape);
+}
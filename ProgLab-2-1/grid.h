@@ -0,0 +1,75 @@
+#ifndef PROGLAB_2_1_GRID_H
+#define PROGLAB_2_1_GRID_H
+
+#include "geometry.h"
+
+// Shapes on an integer grid, for data that is stored in fixed steps (a
+// millimetre grid, say). The coordinates are int64_t counts of steps, every
+// orientation test is exact in 128-bit arithmetic and so is twice the area,
+// so validating a polygon gives the same answer on every machine.
+//
+// Doubles never turn into grid coordinates on their own: a Grid snaps them to
+// the nearest step, and turns grid shapes back into doubles.
+
+using GridPoint = BasicPoint<int64_t>;
+
+using GridSegment = BasicDirectSegment<int64_t>;
+
+using GridPolyline = BasicPolyline<int64_t>;
+
+using GridPolygon = BasicPolygon<int64_t>;
+
+using GridTriangle = BasicTriangle<int64_t>;
+
+using GridTrapezoid = BasicTrapezoid<int64_t>;
+
+// grid coordinates stay within +-GRID_LIMIT, where the 128-bit predicates are
+// exact and twice the area of a polygon (at most 8 GRID_LIMIT^2 = 2^125) fits
+// __int128; at 2^62 the square of the grid would double to 2^127 and wrap
+const int64_t GRID_LIMIT = (int64_t) 1 << 61;
+
+class Grid {
+private:
+    double _step_;
+    bool _valid_ = true;
+public:
+    // constructor (step: the length of one grid step in the units of the doubles,
+    // 0.001 for millimetres); a step that is not a positive number gives a grid
+    // of step 1 without output, see isValid
+    explicit Grid(double step);
+
+    // ===== FUNCTIONS =====
+
+    double getStep() const;
+
+    // false when the step given to the constructor was replaced by 1
+    bool isValid() const;
+
+    // false when the point is not finite or falls outside +-GRID_LIMIT steps
+    bool fits(const Point &point) const;
+
+    // the nearest grid point (ties away from zero), the origin (without output)
+    // for a point that does not fit
+    GridPoint snap(const Point &point) const;
+
+    // every vertex snapped, vertexes landing on the previous one are merged;
+    // empty without output when a vertex does not fit
+    GridPolyline snap(Polyline &line) const;
+
+    // as for lines, then checked: snapping may make a polygon touch itself or
+    // collapse, it comes out empty then (without output, see trySnap)
+    GridPolygon snap(Polygon &polygon) const;
+
+    // as snap, but the reason of a failure is returned: OUTSIDE_GRID or an
+    // error of tryMake, with vertex and edge indexes of the polygon given
+    Checked<GridPolygon> trySnap(Polygon &polygon) const;
+
+    Point toPoint(const GridPoint &point) const;
+
+    Polyline toPolyline(GridPolyline &line) const;
+
+    // checked again, the scaled vertexes are rounded to doubles; empty without output when they touch
+    Polygon toPolygon(GridPolygon &polygon) const;
+};
+
+#endif //PROGLAB_2_1_GRID_H
@@ -0,0 +1,196 @@
+#include "hull.h"
+#include "parallel.h"
+#include "predicates.h"
+#include <algorithm>
+
+namespace {
+    // points per scheduling chunk of the filtering passes
+    const long long HULL_CHUNK = 1 << 16;
+
+    // the octagon directions, counterclockwise starting from the leftmost point
+    const int DIRECTIONS = 8;
+
+    bool lexLess(const Point &A, const Point &B) {
+        return A.getX() < B.getX() || (A.getX() == B.getX() && A.getY() < B.getY());
+    }
+
+    // how far the point reaches in each direction (the larger the better)
+    void reach(const Point &point, double *values) {
+        double x = point.getX(), y = point.getY();
+        values[0] = -x;
+        values[1] = -(x + y);
+        values[2] = -y;
+        values[3] = x - y;
+        values[4] = x;
+        values[5] = x + y;
+        values[6] = y;
+        values[7] = y - x;
+    }
+
+    // index of the extreme point in every direction, the first one on ties
+    vector<long long> extremes(const Point *points, long long n, unsigned threads) {
+        long long chunks = (n + HULL_CHUNK - 1) / HULL_CHUNK;
+        vector<long long> found(chunks * DIRECTIONS);
+        parallelFor(n, HULL_CHUNK, [&](long long begin, long long end) {
+            long long *best = &found[begin / HULL_CHUNK * DIRECTIONS];
+            double best_values[DIRECTIONS], values[DIRECTIONS];
+            reach(points[begin], best_values);
+            fill(best, best + DIRECTIONS, begin);
+            for (long long i = begin + 1; i < end; i++) {
+                reach(points[i], values);
+                for (int d = 0; d < DIRECTIONS; d++) {
+                    if (values[d] > best_values[d]) {
+                        best_values[d] = values[d];
+                        best[d] = i;
+                    }
+                }
+            }
+        }, threads);
+
+        // chunks are combined in order, so ties resolve the same way for any thread count
+        vector<long long> result(found.begin(), found.begin() + DIRECTIONS);
+        double best_values[DIRECTIONS], values[DIRECTIONS];
+        for (int d = 0; d < DIRECTIONS; d++) {
+            reach(points[result[d]], values);
+            best_values[d] = values[d];
+        }
+        for (long long chunk = 1; chunk < chunks; chunk++) {
+            for (int d = 0; d < DIRECTIONS; d++) {
+                long long candidate = found[chunk * DIRECTIONS + d];
+                reach(points[candidate], values);
+                if (values[d] > best_values[d]) {
+                    best_values[d] = values[d];
+                    result[d] = candidate;
+                }
+            }
+        }
+        return result;
+    }
+
+    // the points not strictly inside the octagon, in their original order
+    vector<Point> survivors(const Point *points, long long n, unsigned threads) {
+        vector<Point> octagon;
+        for (long long index: extremes(points, n, threads)) {
+            if (octagon.empty() || octagon.back() != points[index]) {
+                octagon.push_back(points[index]);
+            }
+        }
+        while (octagon.size() > 1 && octagon.front() == octagon.back()) {
+            octagon.pop_back();
+        }
+        long long corners = (long long) octagon.size();
+
+        // a point left of every edge of the counterclockwise octagon is inside it
+        auto inOctagon = [&](const Point &point, bool strict) {
+            bool inside = corners >= 3;
+            for (long long c = 0; c < corners && inside; c++) {
+                double side = orient2d(octagon[c], octagon[(c + 1) % corners], point);
+                inside = strict ? side > 0 : side >= 0;
+            }
+            return inside;
+        };
+
+        // An axis aligned box inside the octagon settles most points without any
+        // orientation test: when the octagon is convex and holds all four corners
+        // of the box, whatever lies strictly inside the box is strictly inside it.
+        double low_x = 0, low_y = 0, high_x = 0, high_y = 0;
+        if (corners == DIRECTIONS) {
+            bool convex = true;
+            for (long long c = 0; c < corners; c++) {
+                convex = convex && orient2d(octagon[c], octagon[(c + 1) % corners], octagon[(c + 2) % corners]) >= 0;
+            }
+            double x0 = max({octagon[7].getX(), octagon[0].getX(), octagon[1].getX()});
+            double y0 = max({octagon[1].getY(), octagon[2].getY(), octagon[3].getY()});
+            double x1 = min({octagon[3].getX(), octagon[4].getX(), octagon[5].getX()});
+            double y1 = min({octagon[5].getY(), octagon[6].getY(), octagon[7].getY()});
+            if (convex && inOctagon(Point(x0, y0), false) && inOctagon(Point(x1, y0), false) &&
+                inOctagon(Point(x1, y1), false) && inOctagon(Point(x0, y1), false)) {
+                low_x = x0, low_y = y0, high_x = x1, high_y = y1;
+            }
+        }
+        auto inBox = [&](const Point &point) {
+            return low_x < point.getX() && point.getX() < high_x && low_y < point.getY() && point.getY() < high_y;
+        };
+
+        long long chunks = (n + HULL_CHUNK - 1) / HULL_CHUNK;
+        vector<vector<Point>> kept(chunks);
+        parallelFor(n, HULL_CHUNK, [&](long long begin, long long end) {
+            vector<Point> &out = kept[begin / HULL_CHUNK];
+            for (long long i = begin; i < end; i++) {
+                if (!inBox(points[i]) && !inOctagon(points[i], true)) {
+                    out.push_back(points[i]);
+                }
+            }
+        }, threads);
+
+        long long total = 0;
+        for (const vector<Point> &part: kept) {
+            total += (long long) part.size();
+        }
+        vector<Point> result;
+        result.reserve(total);
+        for (vector<Point> &part: kept) {
+            result.insert(result.end(), part.begin(), part.end());
+            vector<Point>().swap(part);
+        }
+        return result;
+    }
+
+    // lexicographic sort: pieces are sorted side by side and then merged pairwise
+    void parallelSort(vector<Point> &points, unsigned threads) {
+        long long n = (long long) points.size();
+        long long pieces = min((long long) (threads == 0 ? defaultThreads() : threads), n / HULL_CHUNK + 1);
+        long long width = (n + pieces - 1) / pieces;
+        parallelFor(n, width, [&](long long begin, long long end) {
+            sort(points.begin() + begin, points.begin() + end, lexLess);
+        }, threads);
+
+        vector<Point> buffer(points.size());
+        for (; width < n; width *= 2) {
+            parallelFor((n + 2 * width - 1) / (2 * width), 1, [&](long long first, long long last) {
+                for (long long pair = first; pair < last; pair++) {
+                    long long begin = pair * 2 * width;
+                    long long middle = min(begin + width, n), end = min(begin + 2 * width, n);
+                    merge(points.begin() + begin, points.begin() + middle, points.begin() + middle,
+                          points.begin() + end, buffer.begin() + begin, lexLess);
+                }
+            }, threads);
+            points.swap(buffer);
+        }
+    }
+}
+
+Polygon convexHull(const Point *points, long long n, unsigned threads) {
+    vector<Point> candidates;
+    if (n > 0) {
+        candidates = survivors(points, n, threads);
+    }
+    parallelSort(candidates, threads);
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+    // Andrew's monotone chain: the lower hull left to right, then the upper one back
+    long long m = (long long) candidates.size();
+    pmr::vector<Point> hull;
+    hull.reserve(m + 1);
+    for (long long pass = 0; pass < 2 && m >= 2; pass++) {
+        size_t floor = hull.size();
+        for (long long k = 0; k < m; k++) {
+            const Point &point = candidates[pass == 0 ? k : m - 1 - k];
+            while (hull.size() >= floor + 2 && orient2d(hull[hull.size() - 2], hull.back(), point) <= 0) {
+                hull.pop_back();
+            }
+            hull.push_back(point);
+        }
+        // the last point of each chain starts the other one
+        hull.pop_back();
+    }
+
+    if (hull.size() < 3) {
+        return {};
+    }
+    return {move(hull), Polygon::Trusted()};
+}
+
+Polygon convexHull(const vector<Point> &points, unsigned threads) {
+    return convexHull(points.data(), (long long) points.size(), threads);
+}
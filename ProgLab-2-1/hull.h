@@ -0,0 +1,25 @@
+#ifndef PROGLAB_2_1_HULL_H
+#define PROGLAB_2_1_HULL_H
+
+#include "geometry.h"
+
+// Convex hull of a point cloud, built for clouds of many millions of points.
+//
+// Akl-Toussaint pre-filtering first finds the extreme points in eight
+// directions and drops every point strictly inside the octagon they span,
+// which for most clouds is nearly all of them. The survivors are sorted in
+// parallel and Andrew's monotone chain runs over them. The turns are decided
+// with the exact orient2d (the robust form of Point::operator*), so the hull is
+// convex and simple by construction and comes out as a Polygon without going
+// through validation.
+//
+// The hull is counterclockwise, starts at the lowest of the leftmost points and
+// has no collinear vertexes. Fewer than three points not on one line give an
+// empty Polygon. The result does not depend on the number of threads
+// (threads = 0 uses every hardware thread).
+
+Polygon convexHull(const Point *points, long long n, unsigned threads = 0);
+
+Polygon convexHull(const vector<Point> &points, unsigned threads = 0);
+
+#endif //PROGLAB_2_1_HULL_H
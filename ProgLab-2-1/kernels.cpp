@@ -0,0 +1,771 @@
+#include "kernels.h"
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// the vectorised kernels read the vertex buffer as interleaved x, y coordinates
+static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be two packed doubles");
+static_assert(sizeof(BasicPoint<float>) == 2 * sizeof(float), "BasicPoint<float> must be two packed floats");
+
+namespace {
+    struct Kernels {
+        double (*chain_length)(const Point *, long long);
+
+        double (*shoelace)(const Point *, long long);
+
+        float (*chain_length_float)(const BasicPoint<float> *, long long);
+
+        float (*shoelace_float)(const BasicPoint<float> *, long long);
+
+        void (*intersects_mask)(const double *, const SegmentPack &, long long, long long, uint64_t *);
+
+        void (*arc)(Point *, long long, long long, long long, const Point &, const Point &, const Point &);
+
+        const char *name;
+    };
+
+    template<class T>
+    inline T segmentLength(const BasicPoint<T> &A, const BasicPoint<T> &B) {
+        T dx = B.getX() - A.getX();
+        T dy = B.getY() - A.getY();
+        return sqrt(dx * dx + dy * dy);
+    }
+
+    // ===== SCALAR =====
+
+    template<class T>
+    T chainLengthScalar(const BasicPoint<T> *vertexes, long long n) {
+        const T *raw = reinterpret_cast<const T *>(vertexes);
+        T _length_ = 0;
+        for (long long i = 0; i + 1 < n; i++) {
+            T dx = raw[2 * i + 2] - raw[2 * i];
+            T dy = raw[2 * i + 3] - raw[2 * i + 1];
+            _length_ += sqrt(dx * dx + dy * dy);
+        }
+        return _length_;
+    }
+
+    template<class T>
+    T shoelaceScalar(const BasicPoint<T> *vertexes, long long n) {
+        const T *raw = reinterpret_cast<const T *>(vertexes);
+        T _area_ = 0;
+        for (long long i = 0; i + 1 < n; i++) {
+            _area_ += raw[2 * i] * raw[2 * i + 3] - raw[2 * i + 2] * raw[2 * i + 1];
+        }
+        return _area_;
+    }
+
+    const long double HALF_PI = 1.570796326794896619231321691639751442L;
+
+    // sin and cos on [-pi / 4, pi / 4] by the polynomials of fdlibm, both within one ulp
+    const double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03,
+            C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07,
+            C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+    const double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03,
+            S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06,
+            S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+
+    inline void sinCosScalar(double x, double &c, double &s) {
+        double z = x * x, w = z * z;
+        double rc = z * (C1 + z * (C2 + z * C3)) + w * w * (C4 + z * (C5 + z * C6));
+        double hz = 0.5 * z, head = 1.0 - hz;
+        c = head + (((1.0 - head) - hz) + z * rc);
+        double rs = S2 + z * (S3 + z * S4) + z * w * (S5 + z * S6);
+        s = x + z * x * (S1 + z * rs);
+    }
+
+    // vertexes[j] = center + c * a + s * b, (c, s) at the angle pi / 2 * (r + 4j) / n, for j < count
+    void arcScalar(Point *vertexes, long long count, long long r, long long n, const Point &a, const Point &b,
+                   const Point &center) {
+        for (long long j = 0; j < count; j++) {
+            double c, s;
+            sinCosScalar((double) HALF_PI * ((double) (r + 4 * j) / (double) n), c, s);
+            vertexes[j] = Point(center.getX() + (c * a.getX() + s * b.getX()),
+                                center.getY() + (c * a.getY() + s * b.getY()));
+        }
+    }
+
+    // the same with the sin and cos of the library, for float and long double
+    template<class T>
+    void arcLibm(BasicPoint<T> *vertexes, long long count, long long r, long long n, const BasicPoint<T> &a,
+                 const BasicPoint<T> &b, const BasicPoint<T> &center) {
+        for (long long j = 0; j < count; j++) {
+            T angle = (T) HALF_PI * ((T) (r + 4 * j) / (T) n);
+            T c = cos(angle), s = sin(angle);
+            vertexes[j] = BasicPoint<T>(center.getX() + (c * a.getX() + s * b.getX()),
+                                        center.getY() + (c * a.getY() + s * b.getY()));
+        }
+    }
+
+    // the first stage error bound of orient2d, lanes under it are decided by orient2d itself
+    const double ORIENT_ERROR_BOUND = (3.0 + 16.0 * 1.1102230246251565e-16) * 1.1102230246251565e-16;
+
+    // segment is {x0, y0, x1, y1}; tests pack[from, to) and ORs the hits into mask
+    void intersectsMaskScalar(const double *segment, const SegmentPack &pack, long long from, long long to,
+                              uint64_t *mask) {
+        DirectSegment tested(Point(segment[0], segment[1]), Point(segment[2], segment[3]));
+        for (long long i = from; i < to; i++) {
+            if (tested.intersects(pack[i])) {
+                mask[i >> 6] |= uint64_t(1) << (i & 63);
+            }
+        }
+    }
+
+#ifdef GEOMETRY_X86_KERNELS
+
+    // ===== SSE2 =====
+
+    double chainLengthSSE2(const Point *vertexes, long long n) {
+        const double *raw = reinterpret_cast<const double *>(vertexes);
+        __m128d acc = _mm_setzero_pd();
+        long long i = 0;
+        for (; i + 2 < n; i += 2) {
+            __m128d p0 = _mm_loadu_pd(raw + 2 * i);
+            __m128d p1 = _mm_loadu_pd(raw + 2 * i + 2);
+            __m128d p2 = _mm_loadu_pd(raw + 2 * i + 4);
+            __m128d d0 = _mm_sub_pd(p1, p0);
+            __m128d d1 = _mm_sub_pd(p2, p1);
+            d0 = _mm_mul_pd(d0, d0);
+            d1 = _mm_mul_pd(d1, d1);
+            // (dx0^2 + dy0^2, dx1^2 + dy1^2)
+            __m128d sq = _mm_add_pd(_mm_unpacklo_pd(d0, d1), _mm_unpackhi_pd(d0, d1));
+            acc = _mm_add_pd(acc, _mm_sqrt_pd(sq));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, acc);
+        return lanes[0] + lanes[1] + chainLengthScalar(vertexes + i, n - i);
+    }
+
+    double shoelaceSSE2(const Point *vertexes, long long n) {
+        const double *raw = reinterpret_cast<const double *>(vertexes);
+        __m128d acc = _mm_setzero_pd();
+        long long i = 0;
+        for (; i + 2 < n; i += 2) {
+            __m128d p0 = _mm_loadu_pd(raw + 2 * i);
+            __m128d p1 = _mm_loadu_pd(raw + 2 * i + 2);
+            __m128d p2 = _mm_loadu_pd(raw + 2 * i + 4);
+            // (x0 * y1, y0 * x1) and (x1 * y2, y1 * x2)
+            __m128d m0 = _mm_mul_pd(p0, _mm_shuffle_pd(p1, p1, 1));
+            __m128d m1 = _mm_mul_pd(p1, _mm_shuffle_pd(p2, p2, 1));
+            acc = _mm_add_pd(acc, _mm_sub_pd(_mm_unpacklo_pd(m0, m1), _mm_unpackhi_pd(m0, m1)));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, acc);
+        return lanes[0] + lanes[1] + shoelaceScalar(vertexes + i, n - i);
+    }
+
+    float chainLengthSSE2(const BasicPoint<float> *vertexes, long long n) {
+        const float *raw = reinterpret_cast<const float *>(vertexes);
+        __m128 acc = _mm_setzero_ps();
+        long long i = 0;
+        for (; i + 4 < n; i += 4) {
+            __m128 d0 = _mm_sub_ps(_mm_loadu_ps(raw + 2 * i + 2), _mm_loadu_ps(raw + 2 * i));
+            __m128 d1 = _mm_sub_ps(_mm_loadu_ps(raw + 2 * i + 6), _mm_loadu_ps(raw + 2 * i + 4));
+            d0 = _mm_mul_ps(d0, d0);
+            d1 = _mm_mul_ps(d1, d1);
+            // dx^2 + dy^2 of segments i to i + 3
+            __m128 sq = _mm_add_ps(_mm_shuffle_ps(d0, d1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                   _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 1, 3, 1)));
+            acc = _mm_add_ps(acc, _mm_sqrt_ps(sq));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + chainLengthScalar(vertexes + i, n - i);
+    }
+
+    float shoelaceSSE2(const BasicPoint<float> *vertexes, long long n) {
+        const float *raw = reinterpret_cast<const float *>(vertexes);
+        __m128 acc = _mm_setzero_ps();
+        long long i = 0;
+        for (; i + 4 < n; i += 4) {
+            __m128 b0 = _mm_loadu_ps(raw + 2 * i + 2);
+            __m128 b1 = _mm_loadu_ps(raw + 2 * i + 6);
+            // (x0 * y1, y0 * x1, x1 * y2, y1 * x2) and the same for the next two segments
+            __m128 m0 = _mm_mul_ps(_mm_loadu_ps(raw + 2 * i), _mm_shuffle_ps(b0, b0, _MM_SHUFFLE(2, 3, 0, 1)));
+            __m128 m1 = _mm_mul_ps(_mm_loadu_ps(raw + 2 * i + 4), _mm_shuffle_ps(b1, b1, _MM_SHUFFLE(2, 3, 0, 1)));
+            acc = _mm_add_ps(acc, _mm_sub_ps(_mm_shuffle_ps(m0, m1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                             _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + shoelaceScalar(vertexes + i, n - i);
+    }
+
+    // orient2d(A, B, C) for two lanes; certain is all ones where the sign of det is final
+    inline __m128d orientSSE2(__m128d ax, __m128d ay, __m128d bx, __m128d by, __m128d cx, __m128d cy,
+                              __m128d &certain) {
+        __m128d left = _mm_mul_pd(_mm_sub_pd(ax, cx), _mm_sub_pd(by, cy));
+        __m128d right = _mm_mul_pd(_mm_sub_pd(ay, cy), _mm_sub_pd(bx, cx));
+        __m128d det = _mm_sub_pd(left, right);
+        __m128d sign_bit = _mm_set1_pd(-0.0);
+        __m128d sum = _mm_add_pd(_mm_andnot_pd(sign_bit, left), _mm_andnot_pd(sign_bit, right));
+        certain = _mm_cmpge_pd(_mm_andnot_pd(sign_bit, det), _mm_mul_pd(_mm_set1_pd(ORIENT_ERROR_BOUND), sum));
+        return det;
+    }
+
+    inline __m128d sameSideSSE2(__m128d first, __m128d second) {
+        __m128d zero = _mm_setzero_pd();
+        return _mm_or_pd(_mm_and_pd(_mm_cmpgt_pd(first, zero), _mm_cmpgt_pd(second, zero)),
+                         _mm_and_pd(_mm_cmplt_pd(first, zero), _mm_cmplt_pd(second, zero)));
+    }
+
+    void intersectsMaskSSE2(const double *segment, const SegmentPack &pack, long long from, long long to,
+                            uint64_t *mask) {
+        __m128d ax0 = _mm_set1_pd(segment[0]), ay0 = _mm_set1_pd(segment[1]);
+        __m128d ax1 = _mm_set1_pd(segment[2]), ay1 = _mm_set1_pd(segment[3]);
+        __m128d a_min_x = _mm_min_pd(ax0, ax1), a_max_x = _mm_max_pd(ax0, ax1);
+        __m128d a_min_y = _mm_min_pd(ay0, ay1), a_max_y = _mm_max_pd(ay0, ay1);
+        const double *x0 = pack.x0(), *y0 = pack.y0(), *x1 = pack.x1(), *y1 = pack.y1();
+
+        long long i = from;
+        for (; i + 2 <= to; i += 2) {
+            __m128d bx0 = _mm_loadu_pd(x0 + i), by0 = _mm_loadu_pd(y0 + i);
+            __m128d bx1 = _mm_loadu_pd(x1 + i), by1 = _mm_loadu_pd(y1 + i);
+
+            __m128d apart = _mm_or_pd(_mm_cmplt_pd(a_max_x, _mm_min_pd(bx0, bx1)),
+                                      _mm_cmplt_pd(_mm_max_pd(bx0, bx1), a_min_x));
+            apart = _mm_or_pd(apart, _mm_cmplt_pd(a_max_y, _mm_min_pd(by0, by1)));
+            apart = _mm_or_pd(apart, _mm_cmplt_pd(_mm_max_pd(by0, by1), a_min_y));
+            int apart_bits = _mm_movemask_pd(apart);
+            if (apart_bits == 0x3) {
+                continue;
+            }
+
+            __m128d certain1, certain2, certain3, certain4;
+            __m128d d1 = orientSSE2(ax0, ay0, ax1, ay1, bx0, by0, certain1);
+            __m128d d2 = orientSSE2(ax0, ay0, ax1, ay1, bx1, by1, certain2);
+            __m128d d3 = orientSSE2(bx0, by0, bx1, by1, ax0, ay0, certain3);
+            __m128d d4 = orientSSE2(bx0, by0, bx1, by1, ax1, ay1, certain4);
+            __m128d certain = _mm_and_pd(_mm_and_pd(certain1, certain2), _mm_and_pd(certain3, certain4));
+            __m128d rejected = _mm_or_pd(apart, _mm_or_pd(sameSideSSE2(d1, d2), sameSideSSE2(d3, d4)));
+
+            uint64_t hits = ~_mm_movemask_pd(rejected) & 0x3;
+            uint64_t unsure = ~(_mm_movemask_pd(certain) | apart_bits) & 0x3;
+            hits &= ~unsure;
+            mask[i >> 6] |= hits << (i & 63);
+            for (int lane = 0; lane < 2; lane++) {
+                if (unsure & (1u << lane)) {
+                    intersectsMaskScalar(segment, pack, i + lane, i + lane + 1, mask);
+                }
+            }
+        }
+        intersectsMaskScalar(segment, pack, i, to, mask);
+    }
+
+    inline void sinCosSSE2(__m128d x, __m128d &c, __m128d &s) {
+        __m128d z = _mm_mul_pd(x, x), w = _mm_mul_pd(z, z);
+        __m128d rc = _mm_add_pd(
+                _mm_mul_pd(z, _mm_add_pd(_mm_set1_pd(C1), _mm_mul_pd(z, _mm_add_pd(_mm_set1_pd(C2),
+                                                                                  _mm_mul_pd(z, _mm_set1_pd(C3)))))),
+                _mm_mul_pd(_mm_mul_pd(w, w), _mm_add_pd(_mm_set1_pd(C4), _mm_mul_pd(z, _mm_add_pd(
+                        _mm_set1_pd(C5), _mm_mul_pd(z, _mm_set1_pd(C6)))))));
+        __m128d one = _mm_set1_pd(1.0);
+        __m128d hz = _mm_mul_pd(_mm_set1_pd(0.5), z), head = _mm_sub_pd(one, hz);
+        c = _mm_add_pd(head, _mm_add_pd(_mm_sub_pd(_mm_sub_pd(one, head), hz), _mm_mul_pd(z, rc)));
+        __m128d rs = _mm_add_pd(
+                _mm_add_pd(_mm_set1_pd(S2), _mm_mul_pd(z, _mm_add_pd(_mm_set1_pd(S3), _mm_mul_pd(z, _mm_set1_pd(S4))))),
+                _mm_mul_pd(_mm_mul_pd(z, w), _mm_add_pd(_mm_set1_pd(S5), _mm_mul_pd(z, _mm_set1_pd(S6)))));
+        s = _mm_add_pd(x, _mm_mul_pd(_mm_mul_pd(z, x), _mm_add_pd(_mm_set1_pd(S1), _mm_mul_pd(z, rs))));
+    }
+
+    void arcSSE2(Point *vertexes, long long count, long long r, long long n, const Point &a, const Point &b,
+                 const Point &center) {
+        double *raw = reinterpret_cast<double *>(vertexes);
+        __m128d ax = _mm_set1_pd(a.getX()), ay = _mm_set1_pd(a.getY());
+        __m128d bx = _mm_set1_pd(b.getX()), by = _mm_set1_pd(b.getY());
+        __m128d cx = _mm_set1_pd(center.getX()), cy = _mm_set1_pd(center.getY());
+        __m128d half_pi = _mm_set1_pd((double) HALF_PI), divisor = _mm_set1_pd((double) n);
+        // the numerators are integers far below 2^53, exact in doubles
+        __m128d numerator = _mm_setr_pd((double) r, (double) (r + 4)), stride = _mm_set1_pd(8);
+        long long j = 0;
+        for (; j + 2 <= count; j += 2) {
+            __m128d c, s;
+            sinCosSSE2(_mm_mul_pd(half_pi, _mm_div_pd(numerator, divisor)), c, s);
+            __m128d x = _mm_add_pd(cx, _mm_add_pd(_mm_mul_pd(c, ax), _mm_mul_pd(s, bx)));
+            __m128d y = _mm_add_pd(cy, _mm_add_pd(_mm_mul_pd(c, ay), _mm_mul_pd(s, by)));
+            _mm_storeu_pd(raw + 2 * j, _mm_unpacklo_pd(x, y));
+            _mm_storeu_pd(raw + 2 * j + 2, _mm_unpackhi_pd(x, y));
+            numerator = _mm_add_pd(numerator, stride);
+        }
+        arcScalar(vertexes + j, count - j, r + 4 * j, n, a, b, center);
+    }
+
+    // ===== AVX2 =====
+
+    __attribute__((target("avx2")))
+    double chainLengthAVX2(const Point *vertexes, long long n) {
+        const double *raw = reinterpret_cast<const double *>(vertexes);
+        __m256d acc = _mm256_setzero_pd();
+        long long i = 0;
+        for (; i + 4 < n; i += 4) {
+            __m256d a0 = _mm256_loadu_pd(raw + 2 * i);
+            __m256d a1 = _mm256_loadu_pd(raw + 2 * i + 4);
+            __m256d b0 = _mm256_loadu_pd(raw + 2 * i + 2);
+            __m256d b1 = _mm256_loadu_pd(raw + 2 * i + 6);
+            __m256d d0 = _mm256_sub_pd(b0, a0);
+            __m256d d1 = _mm256_sub_pd(b1, a1);
+            d0 = _mm256_mul_pd(d0, d0);
+            d1 = _mm256_mul_pd(d1, d1);
+            // squared lengths of segments i, i + 2, i + 1, i + 3
+            acc = _mm256_add_pd(acc, _mm256_sqrt_pd(_mm256_hadd_pd(d0, d1)));
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, acc);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + chainLengthScalar(vertexes + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    double shoelaceAVX2(const Point *vertexes, long long n) {
+        const double *raw = reinterpret_cast<const double *>(vertexes);
+        __m256d acc = _mm256_setzero_pd();
+        long long i = 0;
+        for (; i + 4 < n; i += 4) {
+            __m256d a0 = _mm256_loadu_pd(raw + 2 * i);
+            __m256d a1 = _mm256_loadu_pd(raw + 2 * i + 4);
+            __m256d b0 = _mm256_loadu_pd(raw + 2 * i + 2);
+            __m256d b1 = _mm256_loadu_pd(raw + 2 * i + 6);
+            // (x0 * y1, y0 * x1, x1 * y2, y1 * x2) and the same for the next two segments
+            __m256d m0 = _mm256_mul_pd(a0, _mm256_permute_pd(b0, 0x5));
+            __m256d m1 = _mm256_mul_pd(a1, _mm256_permute_pd(b1, 0x5));
+            acc = _mm256_add_pd(acc, _mm256_hsub_pd(m0, m1));
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, acc);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + shoelaceScalar(vertexes + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    float reduceAVX2(__m256 acc) {
+        float lanes[8];
+        _mm256_storeu_ps(lanes, acc);
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    __attribute__((target("avx2")))
+    float chainLengthAVX2(const BasicPoint<float> *vertexes, long long n) {
+        const float *raw = reinterpret_cast<const float *>(vertexes);
+        __m256 acc = _mm256_setzero_ps();
+        long long i = 0;
+        for (; i + 8 < n; i += 8) {
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(raw + 2 * i + 2), _mm256_loadu_ps(raw + 2 * i));
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(raw + 2 * i + 10), _mm256_loadu_ps(raw + 2 * i + 8));
+            d0 = _mm256_mul_ps(d0, d0);
+            d1 = _mm256_mul_ps(d1, d1);
+            // squared lengths of segments i to i + 7, out of order
+            acc = _mm256_add_ps(acc, _mm256_sqrt_ps(_mm256_hadd_ps(d0, d1)));
+        }
+        return reduceAVX2(acc) + chainLengthScalar(vertexes + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    float shoelaceAVX2(const BasicPoint<float> *vertexes, long long n) {
+        const float *raw = reinterpret_cast<const float *>(vertexes);
+        __m256 acc = _mm256_setzero_ps();
+        long long i = 0;
+        for (; i + 8 < n; i += 8) {
+            __m256 m0 = _mm256_mul_ps(_mm256_loadu_ps(raw + 2 * i),
+                                      _mm256_permute_ps(_mm256_loadu_ps(raw + 2 * i + 2), 0xB1));
+            __m256 m1 = _mm256_mul_ps(_mm256_loadu_ps(raw + 2 * i + 8),
+                                      _mm256_permute_ps(_mm256_loadu_ps(raw + 2 * i + 10), 0xB1));
+            acc = _mm256_add_ps(acc, _mm256_hsub_ps(m0, m1));
+        }
+        return reduceAVX2(acc) + shoelaceScalar(vertexes + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256d orientAVX2(__m256d ax, __m256d ay, __m256d bx, __m256d by, __m256d cx, __m256d cy,
+                              __m256d &certain) {
+        __m256d left = _mm256_mul_pd(_mm256_sub_pd(ax, cx), _mm256_sub_pd(by, cy));
+        __m256d right = _mm256_mul_pd(_mm256_sub_pd(ay, cy), _mm256_sub_pd(bx, cx));
+        __m256d det = _mm256_sub_pd(left, right);
+        __m256d sign_bit = _mm256_set1_pd(-0.0);
+        __m256d sum = _mm256_add_pd(_mm256_andnot_pd(sign_bit, left), _mm256_andnot_pd(sign_bit, right));
+        certain = _mm256_cmp_pd(_mm256_andnot_pd(sign_bit, det),
+                                _mm256_mul_pd(_mm256_set1_pd(ORIENT_ERROR_BOUND), sum), _CMP_GE_OQ);
+        return det;
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256d sameSideAVX2(__m256d first, __m256d second) {
+        __m256d zero = _mm256_setzero_pd();
+        return _mm256_or_pd(_mm256_and_pd(_mm256_cmp_pd(first, zero, _CMP_GT_OQ),
+                                          _mm256_cmp_pd(second, zero, _CMP_GT_OQ)),
+                            _mm256_and_pd(_mm256_cmp_pd(first, zero, _CMP_LT_OQ),
+                                          _mm256_cmp_pd(second, zero, _CMP_LT_OQ)));
+    }
+
+    __attribute__((target("avx2")))
+    void intersectsMaskAVX2(const double *segment, const SegmentPack &pack, long long from, long long to,
+                            uint64_t *mask) {
+        __m256d ax0 = _mm256_set1_pd(segment[0]), ay0 = _mm256_set1_pd(segment[1]);
+        __m256d ax1 = _mm256_set1_pd(segment[2]), ay1 = _mm256_set1_pd(segment[3]);
+        __m256d a_min_x = _mm256_min_pd(ax0, ax1), a_max_x = _mm256_max_pd(ax0, ax1);
+        __m256d a_min_y = _mm256_min_pd(ay0, ay1), a_max_y = _mm256_max_pd(ay0, ay1);
+        const double *x0 = pack.x0(), *y0 = pack.y0(), *x1 = pack.x1(), *y1 = pack.y1();
+
+        long long i = from;
+        for (; i + 4 <= to; i += 4) {
+            __m256d bx0 = _mm256_loadu_pd(x0 + i), by0 = _mm256_loadu_pd(y0 + i);
+            __m256d bx1 = _mm256_loadu_pd(x1 + i), by1 = _mm256_loadu_pd(y1 + i);
+
+            __m256d apart = _mm256_or_pd(_mm256_cmp_pd(a_max_x, _mm256_min_pd(bx0, bx1), _CMP_LT_OQ),
+                                         _mm256_cmp_pd(_mm256_max_pd(bx0, bx1), a_min_x, _CMP_LT_OQ));
+            apart = _mm256_or_pd(apart, _mm256_cmp_pd(a_max_y, _mm256_min_pd(by0, by1), _CMP_LT_OQ));
+            apart = _mm256_or_pd(apart, _mm256_cmp_pd(_mm256_max_pd(by0, by1), a_min_y, _CMP_LT_OQ));
+            int apart_bits = _mm256_movemask_pd(apart);
+            if (apart_bits == 0xF) {
+                continue;
+            }
+
+            __m256d certain1, certain2, certain3, certain4;
+            __m256d d1 = orientAVX2(ax0, ay0, ax1, ay1, bx0, by0, certain1);
+            __m256d d2 = orientAVX2(ax0, ay0, ax1, ay1, bx1, by1, certain2);
+            __m256d d3 = orientAVX2(bx0, by0, bx1, by1, ax0, ay0, certain3);
+            __m256d d4 = orientAVX2(bx0, by0, bx1, by1, ax1, ay1, certain4);
+            __m256d certain = _mm256_and_pd(_mm256_and_pd(certain1, certain2), _mm256_and_pd(certain3, certain4));
+            __m256d rejected = _mm256_or_pd(apart, _mm256_or_pd(sameSideAVX2(d1, d2), sameSideAVX2(d3, d4)));
+
+            uint64_t hits = ~_mm256_movemask_pd(rejected) & 0xF;
+            uint64_t unsure = ~(_mm256_movemask_pd(certain) | apart_bits) & 0xF;
+            hits &= ~unsure;
+            mask[i >> 6] |= hits << (i & 63);
+            for (int lane = 0; lane < 4; lane++) {
+                if (unsure & (1u << lane)) {
+                    intersectsMaskScalar(segment, pack, i + lane, i + lane + 1, mask);
+                }
+            }
+        }
+        intersectsMaskScalar(segment, pack, i, to, mask);
+    }
+
+    __attribute__((target("avx2")))
+    inline void sinCosAVX2(__m256d x, __m256d &c, __m256d &s) {
+        __m256d z = _mm256_mul_pd(x, x), w = _mm256_mul_pd(z, z);
+        __m256d rc = _mm256_add_pd(
+                _mm256_mul_pd(z, _mm256_add_pd(_mm256_set1_pd(C1), _mm256_mul_pd(z, _mm256_add_pd(
+                        _mm256_set1_pd(C2), _mm256_mul_pd(z, _mm256_set1_pd(C3)))))),
+                _mm256_mul_pd(_mm256_mul_pd(w, w), _mm256_add_pd(_mm256_set1_pd(C4), _mm256_mul_pd(z, _mm256_add_pd(
+                        _mm256_set1_pd(C5), _mm256_mul_pd(z, _mm256_set1_pd(C6)))))));
+        __m256d one = _mm256_set1_pd(1.0);
+        __m256d hz = _mm256_mul_pd(_mm256_set1_pd(0.5), z), head = _mm256_sub_pd(one, hz);
+        c = _mm256_add_pd(head, _mm256_add_pd(_mm256_sub_pd(_mm256_sub_pd(one, head), hz), _mm256_mul_pd(z, rc)));
+        __m256d low = _mm256_add_pd(_mm256_set1_pd(S3), _mm256_mul_pd(z, _mm256_set1_pd(S4)));
+        __m256d high = _mm256_add_pd(_mm256_set1_pd(S5), _mm256_mul_pd(z, _mm256_set1_pd(S6)));
+        __m256d rs = _mm256_add_pd(_mm256_add_pd(_mm256_set1_pd(S2), _mm256_mul_pd(z, low)),
+                                   _mm256_mul_pd(_mm256_mul_pd(z, w), high));
+        s = _mm256_add_pd(x, _mm256_mul_pd(_mm256_mul_pd(z, x), _mm256_add_pd(_mm256_set1_pd(S1),
+                                                                              _mm256_mul_pd(z, rs))));
+    }
+
+    __attribute__((target("avx2")))
+    void arcAVX2(Point *vertexes, long long count, long long r, long long n, const Point &a, const Point &b,
+                 const Point &center) {
+        double *raw = reinterpret_cast<double *>(vertexes);
+        __m256d ax = _mm256_set1_pd(a.getX()), ay = _mm256_set1_pd(a.getY());
+        __m256d bx = _mm256_set1_pd(b.getX()), by = _mm256_set1_pd(b.getY());
+        __m256d cx = _mm256_set1_pd(center.getX()), cy = _mm256_set1_pd(center.getY());
+        __m256d half_pi = _mm256_set1_pd((double) HALF_PI), divisor = _mm256_set1_pd((double) n);
+        __m256d numerator = _mm256_setr_pd((double) r, (double) (r + 4), (double) (r + 8), (double) (r + 12));
+        __m256d stride = _mm256_set1_pd(16);
+        long long j = 0;
+        for (; j + 4 <= count; j += 4) {
+            __m256d c, s;
+            sinCosAVX2(_mm256_mul_pd(half_pi, _mm256_div_pd(numerator, divisor)), c, s);
+            __m256d x = _mm256_add_pd(cx, _mm256_add_pd(_mm256_mul_pd(c, ax), _mm256_mul_pd(s, bx)));
+            __m256d y = _mm256_add_pd(cy, _mm256_add_pd(_mm256_mul_pd(c, ay), _mm256_mul_pd(s, by)));
+            // [x0 y0 x2 y2] and [x1 y1 x3 y3] back into vertex order
+            __m256d even = _mm256_unpacklo_pd(x, y), odd = _mm256_unpackhi_pd(x, y);
+            _mm256_storeu_pd(raw + 2 * j, _mm256_permute2f128_pd(even, odd, 0x20));
+            _mm256_storeu_pd(raw + 2 * j + 4, _mm256_permute2f128_pd(even, odd, 0x31));
+            numerator = _mm256_add_pd(numerator, stride);
+        }
+        arcScalar(vertexes + j, count - j, r + 4 * j, n, a, b, center);
+    }
+
+#endif
+
+    Kernels pickKernels() {
+#ifdef GEOMETRY_X86_KERNELS
+        // GEOMETRY_KERNELS=sse2 or scalar caps the choice, any other value is ignored
+        const char *cap = getenv("GEOMETRY_KERNELS");
+        bool sse2_only = cap != nullptr && strcmp(cap, "sse2") == 0;
+        bool scalar_only = cap != nullptr && strcmp(cap, "scalar") == 0;
+        __builtin_cpu_init();
+        if (!sse2_only && !scalar_only && __builtin_cpu_supports("avx2")) {
+            return {chainLengthAVX2, shoelaceAVX2, chainLengthAVX2, shoelaceAVX2, intersectsMaskAVX2, arcAVX2,
+                    "avx2"};
+        }
+        if (!scalar_only && __builtin_cpu_supports("sse2")) {
+            return {chainLengthSSE2, shoelaceSSE2, chainLengthSSE2, shoelaceSSE2, intersectsMaskSSE2, arcSSE2,
+                    "sse2"};
+        }
+#endif
+        return {chainLengthScalar<double>, shoelaceScalar<double>, chainLengthScalar<float>, shoelaceScalar<float>,
+                intersectsMaskScalar, arcScalar, "scalar"};
+    }
+
+    const Kernels &kernels() {
+        static const Kernels _kernels_ = pickKernels();
+        return _kernels_;
+    }
+}
+
+double chainLength(const Point *vertexes, long long n) {
+    if (n < 2) {
+        return 0;
+    }
+    return kernels().chain_length(vertexes, n);
+}
+
+double loopLength(const Point *vertexes, long long n) {
+    if (n < 2) {
+        return 0;
+    }
+    return kernels().chain_length(vertexes, n) + segmentLength(vertexes[n - 1], vertexes[0]);
+}
+
+double shoelace(const Point *vertexes, long long n) {
+    if (n < 3) {
+        return 0;
+    }
+    return kernels().shoelace(vertexes, n) + vertexes[n - 1] * vertexes[0];
+}
+
+float chainLength(const BasicPoint<float> *vertexes, long long n) {
+    if (n < 2) {
+        return 0;
+    }
+    return kernels().chain_length_float(vertexes, n);
+}
+
+float loopLength(const BasicPoint<float> *vertexes, long long n) {
+    if (n < 2) {
+        return 0;
+    }
+    return kernels().chain_length_float(vertexes, n) + segmentLength(vertexes[n - 1], vertexes[0]);
+}
+
+float shoelace(const BasicPoint<float> *vertexes, long long n) {
+    if (n < 3) {
+        return 0;
+    }
+    return kernels().shoelace_float(vertexes, n) + vertexes[n - 1] * vertexes[0];
+}
+
+long double chainLength(const BasicPoint<long double> *vertexes, long long n) {
+    return chainLengthScalar(vertexes, n);
+}
+
+long double loopLength(const BasicPoint<long double> *vertexes, long long n) {
+    if (n < 2) {
+        return 0;
+    }
+    return chainLengthScalar(vertexes, n) + segmentLength(vertexes[n - 1], vertexes[0]);
+}
+
+long double shoelace(const BasicPoint<long double> *vertexes, long long n) {
+    if (n < 3) {
+        return 0;
+    }
+    return shoelaceScalar(vertexes, n) + vertexes[n - 1] * vertexes[0];
+}
+
+namespace {
+    // Vertex k lies (n + 4k - 2) / n quarter turns from the x axis before the
+    // rotation. Split into the nearest whole quarter q and r / n quarters
+    // with |r| <= n / 2, the rest is an angle of at most pi / 4; the quarter
+    // turns are exact sign changes of the axes. r grows by 4 from one vertex to
+    // the next, so the vertexes come in runs sharing q, each one arc call.
+    template<class T, class Arc>
+    void regularVertexesBy(long long n, T radius, T rotation, const BasicPoint<T> &center,
+                           BasicPoint<T> *vertexes, Arc arc) {
+        T c = cos(rotation), s = sin(rotation);
+        BasicPoint<T> a(radius * c, radius * s), b(-radius * s, radius * c);
+        BasicPoint<T> minus_a(-a.getX(), -a.getY()), minus_b(-b.getX(), -b.getY());
+        const BasicPoint<T> axes[4][2] = {{a, b}, {b, minus_a}, {minus_a, minus_b}, {minus_b, a}};
+        long long r = n - 2, quarter = 0;
+        for (long long k = 0; k < n;) {
+            while (2 * r > n) {
+                r -= n;
+                quarter++;
+            }
+            long long count = min(n - k, (n - 2 * r) / 8 + 1);
+            arc(vertexes + k, count, r, n, axes[quarter & 3][0], axes[quarter & 3][1], center);
+            k += count;
+            r += 4 * count;
+        }
+    }
+}
+
+void regularVertexes(long long n, double radius, double rotation, const Point &center, Point *vertexes) {
+    regularVertexesBy(n, radius, rotation, center, vertexes, kernels().arc);
+}
+
+void regularVertexes(long long n, float radius, float rotation, const BasicPoint<float> &center,
+                     BasicPoint<float> *vertexes) {
+    regularVertexesBy(n, radius, rotation, center, vertexes, arcLibm<float>);
+}
+
+void regularVertexes(long long n, long double radius, long double rotation, const BasicPoint<long double> &center,
+                     BasicPoint<long double> *vertexes) {
+    regularVertexesBy(n, radius, rotation, center, vertexes, arcLibm<long double>);
+}
+
+namespace {
+    // widened before they are subtracted, as in orient2d: differences of up to 2^63 do not fit int64_t
+    inline double segmentLength(const BasicPoint<int64_t> &A, const BasicPoint<int64_t> &B) {
+        double dx = (double) ((__int128) B.getX() - A.getX());
+        double dy = (double) ((__int128) B.getY() - A.getY());
+        return sqrt(dx * dx + dy * dy);
+    }
+}
+
+double chainLength(const BasicPoint<int64_t> *vertexes, long long n) {
+    double _length_ = 0;
+    for (long long i = 0; i + 1 < n; i++) {
+        _length_ += segmentLength(vertexes[i], vertexes[i + 1]);
+    }
+    return _length_;
+}
+
+double loopLength(const BasicPoint<int64_t> *vertexes, long long n) {
+    if (n < 2) {
+        return 0;
+    }
+    return chainLength(vertexes, n) + segmentLength(vertexes[n - 1], vertexes[0]);
+}
+
+__int128 shoelace(const BasicPoint<int64_t> *vertexes, long long n) {
+    if (n < 3) {
+        return 0;
+    }
+    // unsigned, so that partial sums may wrap around
+    unsigned __int128 _area_ = 0;
+    for (long long i = 0; i < n; i++) {
+        const BasicPoint<int64_t> &A = vertexes[i];
+        const BasicPoint<int64_t> &B = vertexes[i + 1 == n ? 0 : i + 1];
+        _area_ += (unsigned __int128) ((__int128) A.getX() * B.getY());
+        _area_ -= (unsigned __int128) ((__int128) B.getX() * A.getY());
+    }
+    return (__int128) _area_;
+}
+
+SegmentPack::SegmentPack(initializer_list<DirectSegment> segments) {
+    reserve((long long) segments.size());
+    for (const DirectSegment &segment: segments) {
+        add(segment);
+    }
+}
+
+// indexing operator
+DirectSegment SegmentPack::operator[](const long long &idx) const {
+    return DirectSegment(Point(_x0_[idx], _y0_[idx]), Point(_x1_[idx], _y1_[idx]));
+}
+
+long long SegmentPack::size() const {
+    return (long long) _x0_.size();
+}
+
+void SegmentPack::reserve(long long n) {
+    _x0_.reserve(n);
+    _y0_.reserve(n);
+    _x1_.reserve(n);
+    _y1_.reserve(n);
+}
+
+void SegmentPack::clear() {
+    _x0_.clear();
+    _y0_.clear();
+    _x1_.clear();
+    _y1_.clear();
+}
+
+void SegmentPack::add(const DirectSegment &segment) {
+    add(segment.getBegin(), segment.getEnd());
+}
+
+void SegmentPack::add(const Point &begin, const Point &end) {
+    _x0_.push_back(begin.getX());
+    _y0_.push_back(begin.getY());
+    _x1_.push_back(end.getX());
+    _y1_.push_back(end.getY());
+}
+
+const double *SegmentPack::x0() const {
+    return _x0_.data();
+}
+
+const double *SegmentPack::y0() const {
+    return _y0_.data();
+}
+
+const double *SegmentPack::x1() const {
+    return _x1_.data();
+}
+
+const double *SegmentPack::y1() const {
+    return _y1_.data();
+}
+
+void intersectsMask(const DirectSegment &segment, const SegmentPack &pack, vector<uint64_t> &mask) {
+    mask.assign((pack.size() + 63) / 64, 0);
+    Point begin = segment.getBegin(), end = segment.getEnd();
+    double coordinates[4] = {begin.getX(), begin.getY(), end.getX(), end.getY()};
+    kernels().intersects_mask(coordinates, pack, 0, pack.size(), mask.data());
+}
+
+namespace {
+    int lowestBit(uint64_t bits) {
+#ifdef __GNUC__
+        return __builtin_ctzll(bits);
+#else
+        int bit = 0;
+        while (!(bits & 1)) {
+            bits >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    void appendHits(const vector<uint64_t> &mask, vector<long long> &indexes) {
+        for (long long word = 0; word < (long long) mask.size(); word++) {
+            uint64_t bits = mask[word];
+            while (bits) {
+                indexes.push_back(word * 64 + lowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+void intersectsList(const DirectSegment &segment, const SegmentPack &pack, vector<long long> &indexes) {
+    vector<uint64_t> mask;
+    intersectsMask(segment, pack, mask);
+    indexes.clear();
+    appendHits(mask, indexes);
+}
+
+void intersectsPairs(const SegmentPack &A, const SegmentPack &B, vector<pair<long long, long long>> &pairs) {
+    vector<uint64_t> mask;
+    vector<long long> hits;
+    pairs.clear();
+    for (long long i = 0; i < A.size(); i++) {
+        intersectsMask(A[i], B, mask);
+        hits.clear();
+        appendHits(mask, hits);
+        for (long long j: hits) {
+            pairs.emplace_back(i, j);
+        }
+    }
+}
+
+const char *kernelsName() {
+    return kernels().name;
+}
@@ -0,0 +1,114 @@
+#ifndef PROGLAB_2_1_KERNELS_H
+#define PROGLAB_2_1_KERNELS_H
+
+#include "geometry.h"
+#include <cstdint>
+#include <utility>
+
+// Reductions over a contiguous run of vertexes. The best implementation for the
+// running CPU (AVX2, SSE2 or plain scalar) is picked on the first call; the
+// environment variable GEOMETRY_KERNELS=sse2 or GEOMETRY_KERNELS=scalar caps
+// it, so that all of them can be compared on one machine.
+
+// sum of the lengths of the n - 1 segments between consecutive vertexes
+double chainLength(const Point *vertexes, long long n);
+
+// chainLength plus the segment closing the last vertex to the first one
+double loopLength(const Point *vertexes, long long n);
+
+// shoelace sum of the closed loop, twice the signed area
+double shoelace(const Point *vertexes, long long n);
+
+// float versions, sums kept in float: twice as many vertexes per vector as the double ones
+float chainLength(const BasicPoint<float> *vertexes, long long n);
+
+float loopLength(const BasicPoint<float> *vertexes, long long n);
+
+float shoelace(const BasicPoint<float> *vertexes, long long n);
+
+// long double versions, plain loops (there are no long double vector units)
+long double chainLength(const BasicPoint<long double> *vertexes, long long n);
+
+long double loopLength(const BasicPoint<long double> *vertexes, long long n);
+
+long double shoelace(const BasicPoint<long double> *vertexes, long long n);
+
+// int64_t versions. The shoelace sum is exact: products are taken in 128 bits
+// and summed modulo 2^128, which gives the true sum whenever it fits (twice
+// the area of a polygon within +-GRID_LIMIT = +-2^61 is at most 2^125; the
+// square of +-2^62 would double to 2^127 and wrap). AVX2 has neither 64-bit
+// multiplies nor int64 to double conversions, so these are scalar loops.
+double chainLength(const BasicPoint<int64_t> *vertexes, long long n);
+
+double loopLength(const BasicPoint<int64_t> *vertexes, long long n);
+
+__int128 shoelace(const BasicPoint<int64_t> *vertexes, long long n);
+
+// The n vertexes of a regular polygon with the given circumradius, vertex k at
+// the angle rotation + pi / 2 + pi (2k - 1) / n around the center (edge 0 on
+// top and horizontal for rotation 0). Every angle is reduced in integers to a
+// quarter turn and an angle of at most pi / 4, so no vertex inherits the
+// error of another; the sin and cos of the double version are polynomials
+// evaluated on the vector units together with the rotation and translation.
+void regularVertexes(long long n, double radius, double rotation, const Point &center, Point *vertexes);
+
+void regularVertexes(long long n, float radius, float rotation, const BasicPoint<float> &center,
+                     BasicPoint<float> *vertexes);
+
+void regularVertexes(long long n, long double radius, long double rotation, const BasicPoint<long double> &center,
+                     BasicPoint<long double> *vertexes);
+
+// Segments stored as four separate coordinate arrays, the layout the batch
+// intersection kernels stream over.
+class SegmentPack {
+private:
+    vector<double> _x0_;
+    vector<double> _y0_;
+    vector<double> _x1_;
+    vector<double> _y1_;
+public:
+    // constructor
+    SegmentPack() = default;
+
+    SegmentPack(initializer_list<DirectSegment> segments);
+
+    // indexing operator
+    DirectSegment operator[](const long long &idx) const;
+
+    // ===== FUNCTIONS =====
+
+    long long size() const;
+
+    void reserve(long long n);
+
+    void clear();
+
+    void add(const DirectSegment &segment);
+
+    void add(const Point &begin, const Point &end);
+
+    const double *x0() const;
+
+    const double *y0() const;
+
+    const double *x1() const;
+
+    const double *y1() const;
+};
+
+// Batch versions of DirectSegment::intersects. Every answer is bit-for-bit the
+// one the scalar test gives, touching and collinear segments included.
+
+// bit i % 64 of mask[i / 64] is set when segment intersects pack[i]
+void intersectsMask(const DirectSegment &segment, const SegmentPack &pack, vector<uint64_t> &mask);
+
+// indexes of the segments of pack intersecting segment, in increasing order
+void intersectsList(const DirectSegment &segment, const SegmentPack &pack, vector<long long> &indexes);
+
+// every pair (i, j) with A[i] intersecting B[j], ordered by i, then j
+void intersectsPairs(const SegmentPack &A, const SegmentPack &B, vector<pair<long long, long long>> &pairs);
+
+// name of the implementation in use: "avx2", "sse2" or "scalar"
+const char *kernelsName();
+
+#endif //PROGLAB_2_1_KERNELS_H
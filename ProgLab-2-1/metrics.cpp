@@ -0,0 +1,17 @@
+#include "metrics.h"
+#include "kernels.h"
+#include <cmath>
+
+ShapeMetrics metricsOf(Polygon &polygon) {
+    return {polygon.area(), polygon.perimeter(), polygon.degree()};
+}
+
+ShapeMetrics metricsOf(ClosedPolyline &closed_line) {
+    long long n = closed_line.size();
+    if (n == 0) {
+        return {0, 0, 0};
+    }
+    // the vertexes are contiguous, so the first one gives the whole buffer
+    const Point *vertexes = &closed_line[0];
+    return {abs(shoelace(vertexes, n)) / 2, loopLength(vertexes, n), n};
+}
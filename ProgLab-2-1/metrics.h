@@ -0,0 +1,39 @@
+#ifndef PROGLAB_2_1_METRICS_H
+#define PROGLAB_2_1_METRICS_H
+
+#include "geometry.h"
+#include "parallel.h"
+
+// Batch metrics for whole collections of shapes, computed on all cores. Every
+// shape is measured on its own and its result goes to its own slot, so the
+// output is the same whatever the number of threads.
+
+struct ShapeMetrics {
+    double area;
+    double perimeter;
+    long long degree;
+};
+
+// shapes per scheduling chunk: large enough to keep the hand out cheap, small
+// enough to balance collections mixing tiny and huge shapes
+const long long METRICS_CHUNK = 256;
+
+// a Polygon (or Triangle, Trapezoid, RegularPolygon) fills its metric cache on the way
+ShapeMetrics metricsOf(Polygon &polygon);
+
+// area of the loop the closed line draws, its perimeter and its number of vertexes
+ShapeMetrics metricsOf(ClosedPolyline &closed_line);
+
+// metrics[i] describes shapes[i]; threads = 0 uses every hardware thread
+template<class Shape>
+vector<ShapeMetrics> batchMetrics(vector<Shape> &shapes, unsigned threads = 0) {
+    vector<ShapeMetrics> metrics(shapes.size());
+    parallelFor((long long) shapes.size(), METRICS_CHUNK, [&](long long begin, long long end) {
+        for (long long i = begin; i < end; i++) {
+            metrics[i] = metricsOf(shapes[i]);
+        }
+    }, threads);
+    return metrics;
+}
+
+#endif //PROGLAB_2_1_METRICS_H
@@ -0,0 +1,192 @@
+#include "minkowski.h"
+#include "overlay.h"
+#include "predicates.h"
+#include "triangulate.h"
+#include <algorithm>
+
+namespace {
+    bool turnsOneWay(const Point *vertexes, long long n) {
+        bool left = false, right = false;
+        for (long long i = 0; i < n; i++) {
+            double turn = orient2d(vertexes[(i + n - 1) % n], vertexes[i], vertexes[(i + 1) % n]);
+            left |= turn > 0;
+            right |= turn < 0;
+        }
+        return !(left && right);
+    }
+
+    // the vertexes counterclockwise, starting from the lowest (then leftmost) one
+    vector<Point> fromLowest(const Point *vertexes, long long n, bool reversed) {
+        vector<Point> ordered(n);
+        for (long long i = 0; i < n; i++) {
+            ordered[i] = vertexes[reversed ? n - 1 - i : i];
+        }
+        auto lowest = min_element(ordered.begin(), ordered.end(), [](const Point &A, const Point &B) {
+            return A.getY() < B.getY() || (A.getY() == B.getY() && A.getX() < B.getX());
+        });
+        rotate(ordered.begin(), lowest, ordered.end());
+        return ordered;
+    }
+
+    // the polygon itself when it is convex, its triangles otherwise
+    void convexPieces(Polygon &polygon, const Point *vertexes, vector<vector<Point>> &pieces) {
+        long long n = polygon.degree();
+        if (turnsOneWay(vertexes, n)) {
+            pieces.push_back(fromLowest(vertexes, n, polygon.orientation() < 0));
+            return;
+        }
+        vector<long long> indexes;
+        triangulate(polygon, indexes);
+        for (size_t i = 0; i < indexes.size(); i += 3) {
+            Point corners[3] = {vertexes[indexes[i]], vertexes[indexes[i + 1]], vertexes[indexes[i + 2]]};
+            pieces.push_back(fromLowest(corners, 3, false));
+        }
+    }
+
+    // The edges of both loops taken in the order of their angles. Each edge
+    // turns left by less than pi from the one before, so the two edges
+    // compared never differ by pi or more and the sign of their cross product
+    // orders them. With keep_straight the vertex sums inside straight runs of
+    // the boundary stay, so a union of such pieces still passes through every
+    // a + b on its boundary instead of a rounded crossing next to it.
+    pmr::vector<Point> mergeConvex(const vector<Point> &first, const vector<Point> &second, bool keep_straight) {
+        long long n = (long long) first.size(), m = (long long) second.size();
+        pmr::vector<Point> sum;
+        sum.reserve(n + m);
+        // B does not turn left from A -> B towards C (nor go straight on, with keep_straight)
+        auto dropped = [keep_straight](const Point &A, const Point &B, const Point &C) {
+            double turn = orient2d(A, B, C);
+            if (turn != 0 || !keep_straight) {
+                return turn <= 0;
+            }
+            return (B - A).getX() * (C - B).getX() + (B - A).getY() * (C - B).getY() <= 0;
+        };
+        auto push = [&](const Point &point) {
+            while (sum.size() >= 2 && dropped(sum[sum.size() - 2], sum.back(), point)) {
+                sum.pop_back();
+            }
+            if (sum.empty() || sum.back() != point) {
+                sum.push_back(point);
+            }
+        };
+        long long i = 0, j = 0;
+        while (i < n || j < m) {
+            push(first[i % n] + second[j % m]);
+            int turn;
+            if (i == n) {
+                turn = -1;
+            } else if (j == m) {
+                turn = 1;
+            } else {
+                turn = crossSign(first[i], first[(i + 1) % n], second[j], second[(j + 1) % m]);
+            }
+            // parallel edges one after the other, so the sum between them is visited
+            if (turn > 0 || (turn == 0 && keep_straight)) {
+                i++;
+            } else if (turn < 0) {
+                j++;
+            } else {
+                i++;
+                j++;
+            }
+        }
+
+        // the turns around the first vertex
+        size_t front = 0;
+        if (sum.size() - front >= 2 && sum.back() == sum[front]) {
+            sum.pop_back();
+        }
+        while (sum.size() - front >= 3) {
+            if (dropped(sum[sum.size() - 2], sum.back(), sum[front])) {
+                sum.pop_back();
+            } else if (dropped(sum.back(), sum[front], sum[front + 1])) {
+                front++;
+            } else {
+                break;
+            }
+        }
+        sum.erase(sum.begin(), sum.begin() + (long long) front);
+        if (sum.size() < 3) {
+            sum.clear();
+        }
+        return sum;
+    }
+}
+
+// ===== FUNCTIONS =====
+
+bool isConvex(Polygon &polygon) {
+    return turnsOneWay(polygon.data(), polygon.degree());
+}
+
+Polygon minkowskiSum(Polygon &first, Polygon &second) {
+    if (first.degree() == 0 || second.degree() == 0) {
+        return {};
+    }
+    vector<vector<Point>> first_pieces, second_pieces;
+    convexPieces(first, first.data(), first_pieces);
+    convexPieces(second, second.data(), second_pieces);
+    if (first_pieces.size() == 1 && second_pieces.size() == 1) {
+        return {mergeConvex(first_pieces[0], second_pieces[0], false), Polygon::Trusted()};
+    }
+
+    // the union of the sums of the pieces, kept as connected components while it grows
+    vector<Polygon> components;
+    for (const vector<Point> &first_piece: first_pieces) {
+        for (const vector<Point> &second_piece: second_pieces) {
+            Polygon merged(mergeConvex(first_piece, second_piece, true), Polygon::Trusted());
+            if (merged.degree() == 0) {
+                continue;
+            }
+            Box box = merged.boundingBox();
+            for (size_t k = 0; k < components.size();) {
+                if (!box.intersects(components[k].boundingBox())) {
+                    k++;
+                    continue;
+                }
+                vector<PolygonWithHoles> united = Overlay(merged, components[k]).result(BooleanOperation::UNION, true);
+                if (united.size() != 1) {
+                    k++;
+                    continue;
+                }
+                merged = move(united[0].outer);
+                box = merged.boundingBox();
+                components.erase(components.begin() + (long long) k);
+                k = 0;
+            }
+            components.push_back(move(merged));
+        }
+    }
+
+    // pieces of a connected sum overlap, only degenerate ones can stay apart: the largest component is the sum
+    if (components.empty()) {
+        return {};
+    }
+    size_t largest = 0;
+    for (size_t k = 1; k < components.size(); k++) {
+        if (components[k].area() > components[largest].area()) {
+            largest = k;
+        }
+    }
+    // the vertexes kept on straight runs while merging lie exactly on their edges
+    Polygon &sum = components[largest];
+    long long n = sum.degree();
+    const Point *vertexes = sum.data();
+    pmr::vector<Point> corners;
+    corners.reserve(n);
+    for (long long i = 0; i < n; i++) {
+        if (orient2d(vertexes[(i + n - 1) % n], vertexes[i], vertexes[(i + 1) % n]) != 0) {
+            corners.push_back(vertexes[i]);
+        }
+    }
+    if (corners.size() < 3) {
+        corners.clear();
+    }
+    return {move(corners), Polygon::Trusted()};
+}
+
+Polygon minkowskiSum(Polygon &polygon, const RegularShape &disc) {
+    RegularPolygon centered = RegularShape::tryMake(disc.degree(), disc.getSide(), Point(),
+                                                    disc.getRotation()).shape.toPolygon();
+    return minkowskiSum(polygon, centered);
+}
@@ -0,0 +1,36 @@
+#ifndef PROGLAB_2_1_MINKOWSKI_H
+#define PROGLAB_2_1_MINKOWSKI_H
+
+#include "geometry.h"
+#include "regular.h"
+
+// Minkowski sums, the set of all a + b for a in the first polygon and b in the
+// second one: the footprint of a robot grown by an obstacle, or the other way
+// round.
+//
+// Two convex polygons are summed by walking both counterclockwise from their
+// lowest vertexes and merging the edges in the order of their angles, O(n + m)
+// with every angle comparison done by the exact crossSign. The vertex sums are
+// rounded, so every turn of the result is checked again with the exact
+// orient2d and straight or inverted ones are dropped; the result is convex,
+// counterclockwise and has no collinear vertexes.
+//
+// A polygon that is not convex is cut into triangles (see triangulate.h), the
+// convex sums of the pieces are merged with the union of an Overlay: O(n m)
+// pieces for two non-convex polygons, O(n) against a convex one. The pieces
+// and the unions keep the vertexes on straight runs of their boundaries, so no
+// a + b of the vertexes is traded for a rounded crossing next to it while
+// merging: each ends up inside the sum or on its boundary. A sum of non-convex
+// polygons may enclose holes; they are filled, the outer boundary is returned.
+
+// true when no two turns of the polygon go opposite ways, O(n)
+bool isConvex(Polygon &polygon);
+
+// an empty polygon gives an empty sum
+Polygon minkowskiSum(Polygon &first, Polygon &second);
+
+// the polygon grown by a regular polygon standing in for a disc: the sum with
+// the vertexes of the shape taken around its center, so the polygon does not move
+Polygon minkowskiSum(Polygon &polygon, const RegularShape &disc);
+
+#endif //PROGLAB_2_1_MINKOWSKI_H
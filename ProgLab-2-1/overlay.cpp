@@ -0,0 +1,596 @@
+#include "overlay.h"
+#include "predicates.h"
+#include "rtree.h"
+#include "sweep.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <set>
+
+namespace {
+    // gives up on cutting after this many rounds, each round only moves points by their rounding
+    const int MAX_ROUNDS = 64;
+    // an end this many ulps (of the largest coordinate) from a segment is taken to lie on it
+    const double SNAP_ULPS = 8;
+
+    bool lexLess(const Point &A, const Point &B) {
+        return A.getX() < B.getX() || (A.getX() == B.getX() && A.getY() < B.getY());
+    }
+
+    int orient(const Point &A, const Point &B, const Point &C) {
+        double det = orient2d(A, B, C);
+        return (det > 0) - (det < 0);
+    }
+
+    // the point lies on the closed segment AB
+    bool onSegment(const Point &A, const Point &B, const Point &point) {
+        return orient(A, B, point) == 0 &&
+               min(A.getX(), B.getX()) <= point.getX() && point.getX() <= max(A.getX(), B.getX()) &&
+               min(A.getY(), B.getY()) <= point.getY() && point.getY() <= max(A.getY(), B.getY());
+    }
+
+    // The point lies inside AB up to the rounding of an earlier cut: a crossing
+    // rounded to a point next to AB would otherwise leave a new crossing one
+    // ulp further on, round after round. Routing AB through the point instead,
+    // like a hot pixel of snap rounding, keeps the cuts on existing vertexes.
+    bool nearSegment(const Point &A, const Point &B, const Point &point) {
+        double dx = B.getX() - A.getX(), dy = B.getY() - A.getY();
+        double along = (point.getX() - A.getX()) * dx + (point.getY() - A.getY()) * dy;
+        if (along <= 0 || along >= dx * dx + dy * dy) {
+            return false;
+        }
+        double scale = max({abs(A.getX()), abs(A.getY()), abs(B.getX()), abs(B.getY()),
+                            abs(point.getX()), abs(point.getY())});
+        return abs(orient2d(A, B, point)) <= SNAP_ULPS * DBL_EPSILON * scale * sqrt(dx * dx + dy * dy);
+    }
+
+    // Crossings a few ulps apart are one point rounded two ways, as where an
+    // edge runs through a spike of the other polygon. Every crossing is mapped
+    // to the first one (in sweep order) of its cluster, so all the segments
+    // through the point are cut at the same place.
+    void mergeCrossings(vector<Point> &crossings, vector<Point> &representatives) {
+        sort(crossings.begin(), crossings.end(), lexLess);
+        crossings.erase(unique(crossings.begin(), crossings.end()), crossings.end());
+        representatives.resize(crossings.size());
+        for (size_t k = 0; k < crossings.size(); k++) {
+            const Point &point = crossings[k];
+            double tolerance = SNAP_ULPS * DBL_EPSILON * max(abs(point.getX()), abs(point.getY()));
+            representatives[k] = point;
+            for (size_t l = k; l-- > 0 && point.getX() - crossings[l].getX() <= tolerance;) {
+                if (abs(point.getY() - crossings[l].getY()) <= tolerance) {
+                    representatives[k] = representatives[l];
+                    break;
+                }
+            }
+        }
+    }
+
+    // the double nearest to N / W (W > 0), stepped to from a guess a few ulps off
+    double nearest(const Expansion &N, const Expansion &W, double guess) {
+        Expansion twice = N + N;
+        for (;;) {
+            double below = nextafter(guess, -DBL_MAX), above = nextafter(guess, DBL_MAX);
+            if ((twice - W * (Expansion(below) + Expansion(guess))).sign() < 0) {
+                guess = below;
+            } else if ((twice - W * (Expansion(guess) + Expansion(above))).sign() > 0) {
+                guess = above;
+            } else {
+                return guess;
+            }
+        }
+    }
+
+    // The proper crossing of AB and CD rounded to the nearest double. The sweep
+    // only places it within a few ulps, which would move a crossing doubles hold
+    // exactly (common for integer input) off the straight edges through it.
+    Point nearestCrossing(const Point &A, const Point &B, const Point &C, const Point &D, const Point &estimate) {
+        Expansion ex = Expansion::difference(B.getX(), A.getX()), ey = Expansion::difference(B.getY(), A.getY());
+        Expansion fx = Expansion::difference(D.getX(), C.getX()), fy = Expansion::difference(D.getY(), C.getY());
+        Expansion gx = Expansion::difference(C.getX(), A.getX()), gy = Expansion::difference(C.getY(), A.getY());
+        // A + (N / W) (B - A)
+        Expansion W = ex * fy - ey * fx;
+        Expansion N = gx * fy - gy * fx;
+        Expansion X = Expansion(A.getX()) * W + N * ex;
+        Expansion Y = Expansion(A.getY()) * W + N * ey;
+        if (W.sign() < 0) {
+            X = -X, Y = -Y, W = -W;
+        }
+        return Point(nearest(X, W, estimate.getX()), nearest(Y, W, estimate.getY()));
+    }
+
+    // Records where two intersecting segments have to be cut so that they only
+    // share ends. An end lying inside the other segment (or next to it) cuts it
+    // there, a proper crossing cuts both at the rounded crossing point.
+    void cutPair(const vector<DirectSegment> &segments, const SegmentIntersection &intersection,
+                 vector<vector<Point>> &cuts, vector<Point> &crossings) {
+        long long i = intersection.first, j = intersection.second;
+        Point A = segments[i].getBegin(), B = segments[i].getEnd();
+        Point C = segments[j].getBegin(), D = segments[j].getEnd();
+        bool shares = A == C || A == D || B == C || B == D;
+        if (shares && ((A == C && B == D) || (A == D && B == C))) {
+            return;
+        }
+
+        bool touches = false;
+        for (const Point &end: {A, B}) {
+            if (end != C && end != D && (onSegment(C, D, end) || nearSegment(C, D, end))) {
+                cuts[j].push_back(end);
+                touches = true;
+            }
+        }
+        for (const Point &end: {C, D}) {
+            if (end != A && end != B && (onSegment(A, B, end) || nearSegment(A, B, end))) {
+                cuts[i].push_back(end);
+                touches = true;
+            }
+        }
+        // segments with a common end and no other end on each other meet only there
+        if (touches || shares) {
+            return;
+        }
+
+        Point crossing = nearestCrossing(A, B, C, D, intersection.point);
+        crossings.push_back(crossing);
+        if (crossing != A && crossing != B) {
+            cuts[i].push_back(crossing);
+        }
+        if (crossing != C && crossing != D) {
+            cuts[j].push_back(crossing);
+        }
+    }
+
+    // order around a vertex, counterclockwise from the direction of the positive x-axis
+    struct AngleOrder {
+        const Point *center;
+
+        int half(const Point &point) const {
+            return point.getY() > center->getY() || (point.getY() == center->getY() && point.getX() > center->getX())
+                   ? 0 : 1;
+        }
+
+        bool operator()(const Point &A, const Point &B) const {
+            int half_a = half(A), half_b = half(B);
+            if (half_a != half_b) {
+                return half_a < half_b;
+            }
+            return orient(*center, A, B) > 0;
+        }
+    };
+
+    // the status order of the sweeps, the same as in Polygon::isAdequate
+    struct OverlayOrder {
+        const vector<Point> *lefts;
+        const vector<Point> *rights;
+
+        // position of edge b relative to edge a just right of the sweep line, a starting no later than b
+        int sideOf(long long a, long long b) const {
+            int side = orient((*lefts)[a], (*rights)[a], (*lefts)[b]);
+            if (side == 0) {
+                side = orient((*lefts)[a], (*rights)[a], (*rights)[b]);
+            }
+            return side;
+        }
+
+        bool operator()(long long a, long long b) const {
+            if (a == b) {
+                return false;
+            }
+            int side = lexLess((*lefts)[b], (*lefts)[a]) ? -sideOf(b, a) : sideOf(a, b);
+            if (side != 0) {
+                return side > 0;
+            }
+            return a < b;
+        }
+    };
+}
+
+// constructor
+Overlay::Overlay(Polygon &first, Polygon &second) {
+    vector<DirectSegment> segments;
+    vector<unsigned> owners;
+    addRing(first, 1, segments, owners);
+    addRing(second, 2, segments, owners);
+    if (!makePlanar(segments, owners)) {
+        _planar_ = false;
+        return;
+    }
+
+    // every edge from its left end to its right end, a piece of both polygons only once
+    vector<Edge> edges;
+    edges.reserve(segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        Point A = segments[i].getBegin(), B = segments[i].getEnd();
+        if (lexLess(B, A)) {
+            swap(A, B);
+        }
+        edges.push_back({A, B, -1, -1, owners[i], 0});
+    }
+    sort(edges.begin(), edges.end(), [](const Edge &A, const Edge &B) {
+        if (A.left != B.left) {
+            return lexLess(A.left, B.left);
+        }
+        return lexLess(A.right, B.right);
+    });
+    for (const Edge &edge: edges) {
+        if (!_edges_.empty() && _edges_.back().left == edge.left && _edges_.back().right == edge.right) {
+            // a boundary run through twice cancels out
+            _edges_.back().owners ^= edge.owners;
+            if (_edges_.back().owners == 0) {
+                _edges_.pop_back();
+            }
+        } else {
+            _edges_.push_back(edge);
+        }
+    }
+
+    // edges starting at the same vertex from the bottom up, none of them overlap
+    sort(_edges_.begin(), _edges_.end(), [](const Edge &A, const Edge &B) {
+        if (A.left != B.left) {
+            return lexLess(A.left, B.left);
+        }
+        return orient(A.left, A.right, B.right) > 0;
+    });
+
+    for (const Edge &edge: _edges_) {
+        _vertexes_.push_back(edge.left);
+        _vertexes_.push_back(edge.right);
+    }
+    sort(_vertexes_.begin(), _vertexes_.end(), lexLess);
+    _vertexes_.erase(unique(_vertexes_.begin(), _vertexes_.end()), _vertexes_.end());
+    auto vertex = [&](const Point &point) {
+        return (long long) (lower_bound(_vertexes_.begin(), _vertexes_.end(), point, lexLess) - _vertexes_.begin());
+    };
+    for (Edge &edge: _edges_) {
+        edge.left_vertex = vertex(edge.left);
+        edge.right_vertex = vertex(edge.right);
+    }
+
+    // at every vertex the edges ending there leave the status before the ones starting there come in
+    long long m = (long long) _edges_.size();
+    vector<long long> removals(m);
+    for (long long i = 0; i < m; i++) {
+        removals[i] = i;
+    }
+    sort(removals.begin(), removals.end(), [&](long long a, long long b) {
+        return _edges_[a].right_vertex < _edges_[b].right_vertex;
+    });
+    _steps_.reserve(2 * m);
+    long long next_insertion = 0;
+    for (long long removal: removals) {
+        while (next_insertion < m && _edges_[next_insertion].left_vertex < _edges_[removal].right_vertex) {
+            _steps_.push_back({next_insertion++, true});
+        }
+        _steps_.push_back({removal, false});
+    }
+
+    classify();
+}
+
+void Overlay::addRing(Polygon &polygon, unsigned owner, vector<DirectSegment> &segments, vector<unsigned> &owners) {
+    long long n = polygon.degree();
+    const Point *vertexes = polygon.data();
+    for (long long i = 0; i < n; i++) {
+        // a repeated vertex adds nothing to the boundary
+        if (vertexes[i] == vertexes[(i + 1) % n]) {
+            continue;
+        }
+        segments.emplace_back(vertexes[i], vertexes[(i + 1) % n]);
+        owners.push_back(owner);
+    }
+}
+
+bool Overlay::makePlanar(vector<DirectSegment> &segments, vector<unsigned> &owners) {
+    // segments cut in the previous round, only they can meet anything new
+    vector<uint8_t> is_new;
+    vector<SegmentIntersection> intersections;
+    for (int round = 0; round < MAX_ROUNDS; round++) {
+        if (round == 0) {
+            allIntersections(segments, intersections);
+        } else {
+            // the new segments and everything near them
+            RTree tree(segments.begin(), segments.end());
+            vector<uint8_t> is_near(segments.size(), 0);
+            vector<long long> near, items;
+            for (size_t i = 0; i < segments.size(); i++) {
+                if (!is_new[i]) {
+                    continue;
+                }
+                tree.candidates(segments[i], items);
+                for (long long item: items) {
+                    if (!is_near[item]) {
+                        is_near[item] = 1;
+                        near.push_back(item);
+                    }
+                }
+            }
+            vector<DirectSegment> local;
+            local.reserve(near.size());
+            for (long long item: near) {
+                local.push_back(segments[item]);
+            }
+            allIntersections(local, intersections);
+            long long kept = 0;
+            for (const SegmentIntersection &intersection: intersections) {
+                long long a = near[intersection.first], b = near[intersection.second];
+                if (is_new[a] || is_new[b]) {
+                    intersections[kept++] = {min(a, b), max(a, b), intersection.point};
+                }
+            }
+            intersections.resize(kept);
+        }
+
+        vector<vector<Point>> cuts(segments.size());
+        vector<Point> crossings, representatives;
+        bool any = false;
+        for (const SegmentIntersection &intersection: intersections) {
+            cutPair(segments, intersection, cuts, crossings);
+        }
+        mergeCrossings(crossings, representatives);
+        is_new.assign(segments.size(), 0);
+        for (size_t i = 0; i < cuts.size(); i++) {
+            if (cuts[i].empty()) {
+                continue;
+            }
+            Point A = segments[i].getBegin(), B = segments[i].getEnd();
+            for (Point &cut: cuts[i]) {
+                auto it = lower_bound(crossings.begin(), crossings.end(), cut, lexLess);
+                if (it != crossings.end() && *it == cut) {
+                    cut = representatives[it - crossings.begin()];
+                }
+            }
+            // a crossing merged into an end of the segment leaves nothing to cut there
+            cuts[i].erase(remove_if(cuts[i].begin(), cuts[i].end(),
+                                    [&](const Point &cut) { return cut == A || cut == B; }), cuts[i].end());
+            if (cuts[i].empty()) {
+                continue;
+            }
+            any = true;
+            // along the longer axis of the segment, from its beginning
+            bool along_x = abs(B.getX() - A.getX()) >= abs(B.getY() - A.getY());
+            bool increasing = along_x ? A.getX() < B.getX() : A.getY() < B.getY();
+            sort(cuts[i].begin(), cuts[i].end(), [&](const Point &P, const Point &Q) {
+                double p = along_x ? P.getX() : P.getY(), q = along_x ? Q.getX() : Q.getY();
+                if (p != q) {
+                    return increasing ? p < q : p > q;
+                }
+                return lexLess(P, Q);
+            });
+            cuts[i].erase(unique(cuts[i].begin(), cuts[i].end()), cuts[i].end());
+
+            Point begin = A;
+            bool first_piece = true;
+            for (const Point &cut: cuts[i]) {
+                if (first_piece) {
+                    segments[i] = DirectSegment(begin, cut);
+                    is_new[i] = 1;
+                    first_piece = false;
+                } else {
+                    segments.emplace_back(begin, cut);
+                    owners.push_back(owners[i]);
+                    is_new.push_back(1);
+                }
+                begin = cut;
+            }
+            segments.emplace_back(begin, B);
+            owners.push_back(owners[i]);
+            is_new.push_back(1);
+        }
+        if (!any) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Overlay::classify() {
+    vector<Point> lefts, rights;
+    lefts.reserve(_edges_.size());
+    rights.reserve(_edges_.size());
+    for (const Edge &edge: _edges_) {
+        lefts.push_back(edge.left);
+        rights.push_back(edge.right);
+    }
+    set<long long, OverlayOrder> status(OverlayOrder{&lefts, &rights});
+    vector<set<long long, OverlayOrder>::iterator> position(_edges_.size());
+
+    // the region below an edge is the region above the edge below it
+    for (const SweepStep &step: _steps_) {
+        if (!step.is_insertion) {
+            status.erase(position[step.edge]);
+            continue;
+        }
+        auto it = status.insert(step.edge).first;
+        position[step.edge] = it;
+        if (it != status.begin()) {
+            const Edge &below = _edges_[*prev(it)];
+            _edges_[step.edge].below = below.below ^ below.owners;
+        }
+    }
+}
+
+long long Overlay::size() const {
+    return (long long) _edges_.size();
+}
+
+bool Overlay::isPlanar() const {
+    return _planar_;
+}
+
+vector<PolygonWithHoles> Overlay::result(BooleanOperation operation, bool keep_straight) const {
+    auto inside = [operation](unsigned polygons) {
+        bool first = polygons & 1, second = polygons & 2;
+        switch (operation) {
+            case BooleanOperation::INTERSECTION:
+                return first && second;
+            case BooleanOperation::UNION:
+                return first || second;
+            case BooleanOperation::DIFFERENCE:
+                return first && !second;
+            default:
+                return first != second;
+        }
+    };
+
+    // the result edges, directed with the inside of the result on their left
+    long long m = (long long) _edges_.size();
+    long long v = (long long) _vertexes_.size();
+    vector<uint8_t> in_result(m, 0), forward(m, 0);
+    vector<long long> from(m, -1), to(m, -1);
+    vector<long long> out_starts(v + 1, 0);
+    for (long long i = 0; i < m; i++) {
+        const Edge &edge = _edges_[i];
+        bool below = inside(edge.below), above = inside(edge.below ^ edge.owners);
+        if (below == above) {
+            continue;
+        }
+        in_result[i] = 1;
+        forward[i] = above;
+        from[i] = above ? edge.left_vertex : edge.right_vertex;
+        to[i] = above ? edge.right_vertex : edge.left_vertex;
+        out_starts[from[i] + 1]++;
+    }
+    for (long long i = 0; i < v; i++) {
+        out_starts[i + 1] += out_starts[i];
+    }
+    vector<long long> outgoing(out_starts[v]);
+    vector<long long> filled(out_starts.begin(), out_starts.end() - 1);
+    for (long long i = 0; i < m; i++) {
+        if (in_result[i]) {
+            outgoing[filled[from[i]]++] = i;
+        }
+    }
+    for (long long vertex = 0; vertex < v; vertex++) {
+        if (out_starts[vertex + 1] - out_starts[vertex] > 1) {
+            AngleOrder order{&_vertexes_[vertex]};
+            sort(outgoing.begin() + out_starts[vertex], outgoing.begin() + out_starts[vertex + 1],
+                 [&](long long a, long long b) { return order(_vertexes_[to[a]], _vertexes_[to[b]]); });
+        }
+    }
+
+    // Walks around every face of the result. After coming in along u -> v the
+    // walk leaves along the first edge clockwise from v -> u; where a face
+    // touches itself at a vertex the walk passes it twice and is split there
+    // into separate rings.
+    vector<uint8_t> used(m, 0);
+    vector<long long> ring_of(m, -1);
+    vector<vector<long long>> rings;
+    vector<long long> stack_position(v, -1);
+    vector<long long> stack;
+    for (long long start = 0; start < m; start++) {
+        if (!in_result[start] || used[start]) {
+            continue;
+        }
+        stack.clear();
+        long long edge = start;
+        do {
+            used[edge] = 1;
+            long long vertex = from[edge];
+            if (stack_position[vertex] >= 0) {
+                long long first = stack_position[vertex];
+                rings.emplace_back(stack.begin() + first, stack.end());
+                for (auto it = stack.begin() + first; it != stack.end(); ++it) {
+                    stack_position[from[*it]] = -1;
+                    ring_of[*it] = (long long) rings.size() - 1;
+                }
+                stack.resize(first);
+            }
+            stack_position[vertex] = (long long) stack.size();
+            stack.push_back(edge);
+
+            long long next_vertex = to[edge];
+            long long first_out = out_starts[next_vertex], last_out = out_starts[next_vertex + 1];
+            if (last_out - first_out == 1) {
+                edge = outgoing[first_out];
+            } else {
+                AngleOrder order{&_vertexes_[next_vertex]};
+                const Point &back = _vertexes_[vertex];
+                auto after = partition_point(outgoing.begin() + first_out, outgoing.begin() + last_out,
+                                             [&](long long out) { return order(_vertexes_[to[out]], back); });
+                edge = after == outgoing.begin() + first_out ? outgoing[last_out - 1] : *prev(after);
+            }
+            // every edge bounds one face, a walk entering another one has left a broken arrangement
+            if (edge != start && used[edge]) {
+                return {};
+            }
+        } while (edge != start);
+        rings.emplace_back(stack.begin(), stack.end());
+        for (long long ring_edge: stack) {
+            stack_position[from[ring_edge]] = -1;
+            ring_of[ring_edge] = (long long) rings.size() - 1;
+        }
+    }
+
+    // A ring is outer when the inside lies above its first edge in sweep order.
+    // A hole belongs to the ring of the result edge right below it, or, when that
+    // is a hole as well, to the outer ring of that hole.
+    vector<PolygonWithHoles> pieces;
+    vector<long long> piece_of(rings.size(), -1);
+    vector<uint8_t> seen(rings.size(), 0);
+    vector<Point> lefts, rights;
+    lefts.reserve(m);
+    rights.reserve(m);
+    for (const Edge &edge: _edges_) {
+        lefts.push_back(edge.left);
+        rights.push_back(edge.right);
+    }
+    set<long long, OverlayOrder> status(OverlayOrder{&lefts, &rights});
+    vector<set<long long, OverlayOrder>::iterator> position(m);
+
+    auto ringPolygon = [&](long long ring) {
+        pmr::vector<Point> vertexes;
+        const vector<long long> &edges = rings[ring];
+        long long n = (long long) edges.size();
+        for (long long i = 0; i < n; i++) {
+            const Point &previous = _vertexes_[from[edges[(i + n - 1) % n]]];
+            const Point &vertex = _vertexes_[from[edges[i]]];
+            const Point &next = _vertexes_[to[edges[i]]];
+            // cuts on straight runs are dropped
+            if (keep_straight || orient(previous, vertex, next) != 0) {
+                vertexes.push_back(vertex);
+            }
+        }
+        return Polygon(move(vertexes), Polygon::Trusted());
+    };
+
+    for (const SweepStep &step: _steps_) {
+        if (!in_result[step.edge]) {
+            continue;
+        }
+        if (!step.is_insertion) {
+            status.erase(position[step.edge]);
+            continue;
+        }
+        auto it = status.insert(step.edge).first;
+        position[step.edge] = it;
+        long long ring = ring_of[step.edge];
+        if (seen[ring]) {
+            continue;
+        }
+        seen[ring] = 1;
+        if (forward[step.edge]) {
+            piece_of[ring] = (long long) pieces.size();
+            pieces.push_back({ringPolygon(ring), {}});
+        } else {
+            long long outer = piece_of[ring_of[*prev(it)]];
+            piece_of[ring] = outer;
+            pieces[outer].holes.push_back(ringPolygon(ring));
+        }
+    }
+    return pieces;
+}
+
+vector<PolygonWithHoles> polygonIntersection(Polygon &first, Polygon &second) {
+    return Overlay(first, second).result(BooleanOperation::INTERSECTION);
+}
+
+vector<PolygonWithHoles> polygonUnion(Polygon &first, Polygon &second) {
+    return Overlay(first, second).result(BooleanOperation::UNION);
+}
+
+vector<PolygonWithHoles> polygonDifference(Polygon &first, Polygon &second) {
+    return Overlay(first, second).result(BooleanOperation::DIFFERENCE);
+}
+
+vector<PolygonWithHoles> polygonXor(Polygon &first, Polygon &second) {
+    return Overlay(first, second).result(BooleanOperation::XOR);
+}
@@ -0,0 +1,99 @@
+#ifndef PROGLAB_2_1_OVERLAY_H
+#define PROGLAB_2_1_OVERLAY_H
+
+#include "geometry.h"
+
+// Boolean operations between two polygons.
+//
+// The edges of both polygons are cut wherever they meet (found with the
+// Bentley-Ottmann sweep of allIntersections) until no two of them cross, and
+// the pieces shared by both polygons are merged. One more sweep over this
+// planar arrangement finds for every edge whether the region just below it is
+// inside each of the polygons, so an operation only picks the edges that
+// separate its inside from its outside and links them into rings:
+// O((n + k) log n) for n vertexes with k crossings.
+//
+// Crossings are rounded to the nearest double, an edge passing within a few
+// ulps of an end of another is cut at that end, and the edges moved by the
+// rounding are checked again, so the rings that come out are simple. All the
+// other decisions are exact. Edges that still cross after MAX_ROUNDS of this
+// leave the overlay empty without output (see isPlanar), it never links rings
+// out of an arrangement that is not planar.
+
+enum class BooleanOperation {
+    INTERSECTION, UNION, DIFFERENCE, XOR
+};
+
+// A piece of the result: the outer ring is counterclockwise, the holes are
+// clockwise and lie inside it. Rings of one result may touch at vertexes, but
+// never cross.
+struct PolygonWithHoles {
+    Polygon outer;
+    vector<Polygon> holes;
+};
+
+// the arrangement of two polygons, any number of operations can be run on it
+class Overlay {
+private:
+    struct Edge {
+        Point left;
+        Point right;
+        // ends as indexes into _vertexes_
+        long long left_vertex;
+        long long right_vertex;
+        // bit 0 for an edge of the first polygon, bit 1 for the second one
+        unsigned owners;
+        // the same bits for the polygons containing the region just below the edge
+        unsigned below;
+    };
+
+    struct SweepStep {
+        long long edge;
+        bool is_insertion;
+    };
+
+    // distinct ends of the edges, in sweep order
+    vector<Point> _vertexes_;
+    // in the order the sweep meets them, from the left and from the bottom up
+    vector<Edge> _edges_;
+    vector<SweepStep> _steps_;
+    // false when the edges could not be cut into a planar arrangement
+    bool _planar_ = true;
+
+    static void addRing(Polygon &polygon, unsigned owner, vector<DirectSegment> &segments,
+                        vector<unsigned> &owners);
+
+    // cuts the segments until they meet only at their ends (or coincide), false when they never do
+    static bool makePlanar(vector<DirectSegment> &segments, vector<unsigned> &owners);
+
+    void classify();
+
+public:
+    // constructor
+    Overlay() = default;
+
+    Overlay(Polygon &first, Polygon &second);
+
+    // ===== FUNCTIONS =====
+
+    // number of edges in the arrangement
+    long long size() const;
+
+    // false when the polygons could not be overlaid, every result is empty then
+    bool isPlanar() const;
+
+    // first (operation) second, an empty result for an empty region; with
+    // keep_straight the vertexes inside straight runs of a ring stay, so
+    // exact input vertexes are not lost to the next overlay of the result
+    vector<PolygonWithHoles> result(BooleanOperation operation, bool keep_straight = false) const;
+};
+
+vector<PolygonWithHoles> polygonIntersection(Polygon &first, Polygon &second);
+
+vector<PolygonWithHoles> polygonUnion(Polygon &first, Polygon &second);
+
+vector<PolygonWithHoles> polygonDifference(Polygon &first, Polygon &second);
+
+vector<PolygonWithHoles> polygonXor(Polygon &first, Polygon &second);
+
+#endif //PROGLAB_2_1_OVERLAY_H
@@ -0,0 +1,62 @@
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+unsigned defaultThreads() {
+    return max(thread::hardware_concurrency(), 1U);
+}
+
+void parallelFor(long long n, long long chunk, const function<void(long long, long long)> &body, unsigned threads) {
+    if (n <= 0) {
+        return;
+    }
+    chunk = max(chunk, 1LL);
+    long long chunks = (n + chunk - 1) / chunk;
+    if (threads == 0) {
+        threads = defaultThreads();
+    }
+    long long workers = min((long long) threads, chunks);
+
+    if (workers <= 1) {
+        for (long long begin = 0; begin < n; begin += chunk) {
+            body(begin, min(begin + chunk, n));
+        }
+        return;
+    }
+
+    atomic<long long> next(0);
+    exception_ptr failure;
+    mutex failure_lock;
+    auto work = [&]() {
+        try {
+            for (long long index = next++; index < chunks; index = next++) {
+                long long begin = index * chunk;
+                body(begin, min(begin + chunk, n));
+            }
+        } catch (...) {
+            lock_guard<mutex> guard(failure_lock);
+            if (!failure) {
+                failure = current_exception();
+            }
+            // nobody else needs to start a new chunk
+            next = chunks;
+        }
+    };
+
+    vector<thread> pool;
+    pool.reserve(workers - 1);
+    for (long long i = 1; i < workers; i++) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (thread &worker: pool) {
+        worker.join();
+    }
+    if (failure) {
+        rethrow_exception(failure);
+    }
+}
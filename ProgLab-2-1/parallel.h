@@ -0,0 +1,20 @@
+#ifndef PROGLAB_2_1_PARALLEL_H
+#define PROGLAB_2_1_PARALLEL_H
+
+#include <functional>
+
+using namespace std;
+
+// number of workers used when 0 threads are asked for: one per hardware thread
+unsigned defaultThreads();
+
+// Calls body(begin, end) for consecutive chunks of [0, n), each at most chunk
+// long, from up to threads workers (the calling thread is one of them). Chunks
+// are handed out one by one as workers become free, so uneven chunks balance
+// out. The chunk boundaries depend on n and chunk only, never on the number of
+// threads. The first exception thrown by body is rethrown once all workers
+// are done.
+void parallelFor(long long n, long long chunk, const function<void(long long, long long)> &body,
+                 unsigned threads = 0);
+
+#endif //PROGLAB_2_1_PARALLEL_H
@@ -0,0 +1,408 @@
+#include "predicates.h"
+#include <cmath>
+#include <limits>
+
+// Everything here relies on every operation being rounded on its own, so the
+// file is built with floating point contraction disabled (see CMakeLists.txt).
+
+namespace {
+    // half an ulp of 1 and the Dekker splitter for 53 bit mantissas
+    const double EPSILON = 1.1102230246251565e-16;
+    const double SPLITTER = 134217729.0;
+
+    const double RESULT_ERROR_BOUND = (3.0 + 8.0 * EPSILON) * EPSILON;
+    const double CCW_ERROR_BOUND_B = (2.0 + 12.0 * EPSILON) * EPSILON;
+    const double CCW_ERROR_BOUND_C = (9.0 + 64.0 * EPSILON) * EPSILON * EPSILON;
+    const double CROSS_ERROR_BOUND = 8.0 * EPSILON;
+
+    // ===== ERROR FREE TRANSFORMATIONS =====
+
+    inline void fastTwoSum(double a, double b, double &x, double &y) {
+        x = a + b;
+        double b_virtual = x - a;
+        y = b - b_virtual;
+    }
+
+    inline void twoSum(double a, double b, double &x, double &y) {
+        x = a + b;
+        double b_virtual = x - a;
+        double a_virtual = x - b_virtual;
+        y = (a - a_virtual) + (b - b_virtual);
+    }
+
+    inline void twoDiffTail(double a, double b, double x, double &y) {
+        double b_virtual = a - x;
+        double a_virtual = x + b_virtual;
+        y = (a - a_virtual) + (b_virtual - b);
+    }
+
+    inline void twoDiff(double a, double b, double &x, double &y) {
+        x = a - b;
+        twoDiffTail(a, b, x, y);
+    }
+
+    inline void split(double a, double &high, double &low) {
+        double c = SPLITTER * a;
+        double a_big = c - a;
+        high = c - a_big;
+        low = a - high;
+    }
+
+    inline void twoProduct(double a, double b, double &x, double &y) {
+        x = a * b;
+        double a_high, a_low, b_high, b_low;
+        split(a, a_high, a_low);
+        split(b, b_high, b_low);
+        double error1 = x - (a_high * b_high);
+        double error2 = error1 - (a_low * b_high);
+        double error3 = error2 - (a_high * b_low);
+        y = (a_low * b_low) - error3;
+    }
+
+    // (a1 + a0) - (b1 + b0) as the four component expansion x
+    inline void twoTwoDiff(double a1, double a0, double b1, double b0, double *x) {
+        double i, j, k;
+        twoDiff(a0, b0, i, x[0]);
+        twoSum(a1, i, j, k);
+        twoDiff(k, b1, i, x[1]);
+        twoSum(j, i, x[3], x[2]);
+    }
+
+    // ===== EXPANSIONS =====
+
+    double estimate(int length, const double *e) {
+        double sum = e[0];
+        for (int i = 1; i < length; i++) {
+            sum += e[i];
+        }
+        return sum;
+    }
+
+    // h = e + f with zero components removed, returns the length of h
+    int expansionSum(int e_length, const double *e, int f_length, const double *f, double *h) {
+        double e_now = e[0], f_now = f[0];
+        int e_index = 0, f_index = 0, h_index = 0;
+        double q, q_new, hh;
+
+        auto nextE = [&]() { e_now = (++e_index < e_length) ? e[e_index] : 0; };
+        auto nextF = [&]() { f_now = (++f_index < f_length) ? f[f_index] : 0; };
+
+        if ((f_now > e_now) == (f_now > -e_now)) {
+            q = e_now;
+            nextE();
+        } else {
+            q = f_now;
+            nextF();
+        }
+        if (e_index < e_length && f_index < f_length) {
+            if ((f_now > e_now) == (f_now > -e_now)) {
+                fastTwoSum(e_now, q, q_new, hh);
+                nextE();
+            } else {
+                fastTwoSum(f_now, q, q_new, hh);
+                nextF();
+            }
+            q = q_new;
+            if (hh != 0) {
+                h[h_index++] = hh;
+            }
+            while (e_index < e_length && f_index < f_length) {
+                if ((f_now > e_now) == (f_now > -e_now)) {
+                    twoSum(q, e_now, q_new, hh);
+                    nextE();
+                } else {
+                    twoSum(q, f_now, q_new, hh);
+                    nextF();
+                }
+                q = q_new;
+                if (hh != 0) {
+                    h[h_index++] = hh;
+                }
+            }
+        }
+        while (e_index < e_length) {
+            twoSum(q, e_now, q_new, hh);
+            nextE();
+            q = q_new;
+            if (hh != 0) {
+                h[h_index++] = hh;
+            }
+        }
+        while (f_index < f_length) {
+            twoSum(q, f_now, q_new, hh);
+            nextF();
+            q = q_new;
+            if (hh != 0) {
+                h[h_index++] = hh;
+            }
+        }
+        if (q != 0 || h_index == 0) {
+            h[h_index++] = q;
+        }
+        return h_index;
+    }
+
+    // h = e * b with zero components removed, returns the length of h
+    int scaleExpansion(int e_length, const double *e, double b, double *h) {
+        double b_high, b_low;
+        split(b, b_high, b_low);
+
+        auto product = [&](double a, double &x, double &y) {
+            x = a * b;
+            double a_high, a_low;
+            split(a, a_high, a_low);
+            double error1 = x - (a_high * b_high);
+            double error2 = error1 - (a_low * b_high);
+            double error3 = error2 - (a_high * b_low);
+            y = (a_low * b_low) - error3;
+        };
+
+        double q, hh, sum, product1, product0;
+        int h_index = 0;
+        product(e[0], q, hh);
+        if (hh != 0) {
+            h[h_index++] = hh;
+        }
+        for (int i = 1; i < e_length; i++) {
+            product(e[i], product1, product0);
+            twoSum(q, product0, sum, hh);
+            if (hh != 0) {
+                h[h_index++] = hh;
+            }
+            fastTwoSum(product1, sum, q, hh);
+            if (hh != 0) {
+                h[h_index++] = hh;
+            }
+        }
+        if (q != 0 || h_index == 0) {
+            h[h_index++] = q;
+        }
+        return h_index;
+    }
+
+    int sign(double value) {
+        return (value > 0) - (value < 0);
+    }
+
+    int crossSignExact(const Point &A, const Point &B, const Point &C, const Point &D) {
+        // every coordinate difference is an exact two component expansion
+        double ex[2], ey[2], fx[2], fy[2];
+        twoDiff(B.getX(), A.getX(), ex[1], ex[0]);
+        twoDiff(B.getY(), A.getY(), ey[1], ey[0]);
+        twoDiff(D.getX(), C.getX(), fx[1], fx[0]);
+        twoDiff(D.getY(), C.getY(), fy[1], fy[0]);
+
+        double part0[4], part1[4], left[8], right[8], difference[16];
+        int length0, length1;
+
+        // ex * fy
+        length0 = scaleExpansion(2, ex, fy[0], part0);
+        length1 = scaleExpansion(2, ex, fy[1], part1);
+        int left_length = expansionSum(length0, part0, length1, part1, left);
+
+        // -(ey * fx)
+        double minus_fx[2] = {-fx[0], -fx[1]};
+        length0 = scaleExpansion(2, ey, minus_fx[0], part0);
+        length1 = scaleExpansion(2, ey, minus_fx[1], part1);
+        int right_length = expansionSum(length0, part0, length1, part1, right);
+
+        int length = expansionSum(left_length, left, right_length, right, difference);
+        return sign(difference[length - 1]);
+    }
+}
+
+// ===== ADAPTIVE STAGES =====
+
+double orient2dAdapt(const Point &A, const Point &B, const Point &C, double det_sum) {
+    double acx = A.getX() - C.getX();
+    double bcx = B.getX() - C.getX();
+    double acy = A.getY() - C.getY();
+    double bcy = B.getY() - C.getY();
+
+    double det_left, det_left_tail, det_right, det_right_tail;
+    twoProduct(acx, bcy, det_left, det_left_tail);
+    twoProduct(acy, bcx, det_right, det_right_tail);
+
+    double b[4];
+    twoTwoDiff(det_left, det_left_tail, det_right, det_right_tail, b);
+
+    double det = estimate(4, b);
+    double error_bound = CCW_ERROR_BOUND_B * det_sum;
+    if (det >= error_bound || -det >= error_bound) {
+        return det;
+    }
+
+    double acx_tail, bcx_tail, acy_tail, bcy_tail;
+    twoDiffTail(A.getX(), C.getX(), acx, acx_tail);
+    twoDiffTail(B.getX(), C.getX(), bcx, bcx_tail);
+    twoDiffTail(A.getY(), C.getY(), acy, acy_tail);
+    twoDiffTail(B.getY(), C.getY(), bcy, bcy_tail);
+
+    if (acx_tail == 0 && acy_tail == 0 && bcx_tail == 0 && bcy_tail == 0) {
+        return det;
+    }
+
+    error_bound = CCW_ERROR_BOUND_C * det_sum + RESULT_ERROR_BOUND * abs(det);
+    det += (acx * bcy_tail + bcy * acx_tail) - (acy * bcx_tail + bcx * acy_tail);
+    if (det >= error_bound || -det >= error_bound) {
+        return det;
+    }
+
+    double s1, s0, t1, t0, u[4];
+    double c1[8], c2[12], d[16];
+
+    twoProduct(acx_tail, bcy, s1, s0);
+    twoProduct(acy_tail, bcx, t1, t0);
+    twoTwoDiff(s1, s0, t1, t0, u);
+    int c1_length = expansionSum(4, b, 4, u, c1);
+
+    twoProduct(acx, bcy_tail, s1, s0);
+    twoProduct(acy, bcx_tail, t1, t0);
+    twoTwoDiff(s1, s0, t1, t0, u);
+    int c2_length = expansionSum(c1_length, c1, 4, u, c2);
+
+    twoProduct(acx_tail, bcy_tail, s1, s0);
+    twoProduct(acy_tail, bcx_tail, t1, t0);
+    twoTwoDiff(s1, s0, t1, t0, u);
+    int d_length = expansionSum(c2_length, c2, 4, u, d);
+
+    return d[d_length - 1];
+}
+
+int crossSign(const Point &A, const Point &B, const Point &C, const Point &D) {
+    double ex = B.getX() - A.getX(), ey = B.getY() - A.getY();
+    double fx = D.getX() - C.getX(), fy = D.getY() - C.getY();
+    double det_left = ex * fy;
+    double det_right = ey * fx;
+    double det = det_left - det_right;
+
+    double error_bound = CROSS_ERROR_BOUND * (abs(det_left) + abs(det_right));
+    if ((det > error_bound || -det > error_bound) && isfinite(det)) {
+        return sign(det);
+    }
+    return crossSignExact(A, B, C, D);
+}
+
+
+// ===== EXPANSION =====
+
+Expansion Expansion::difference(double a, double b) {
+    Expansion result;
+    result._terms_.resize(2);
+    twoDiff(a, b, result._terms_[1], result._terms_[0]);
+    return result;
+}
+
+Expansion Expansion::product(double a, double b) {
+    Expansion result;
+    result._terms_.resize(2);
+    twoProduct(a, b, result._terms_[1], result._terms_[0]);
+    return result;
+}
+
+Expansion operator+(const Expansion &A, const Expansion &B) {
+    Expansion result;
+    result._terms_.resize(A._terms_.size() + B._terms_.size());
+    int length = expansionSum((int) A._terms_.size(), A._terms_.data(), (int) B._terms_.size(), B._terms_.data(),
+                              result._terms_.data());
+    result._terms_.resize(length);
+    return result;
+}
+
+Expansion operator-(const Expansion &A, const Expansion &B) {
+    return A + (-B);
+}
+
+Expansion operator*(const Expansion &A, const Expansion &B) {
+    // one scaled copy of A per term of B, summed up
+    Expansion result;
+    vector<double> scaled(2 * A._terms_.size());
+    for (double term: B._terms_) {
+        Expansion part;
+        int length = scaleExpansion((int) A._terms_.size(), A._terms_.data(), term, scaled.data());
+        part._terms_.assign(scaled.begin(), scaled.begin() + length);
+        result = result + part;
+    }
+    return result;
+}
+
+Expansion Expansion::operator-() const {
+    Expansion result = *this;
+    for (double &term: result._terms_) {
+        term = -term;
+    }
+    return result;
+}
+
+int Expansion::sign() const {
+    return ::sign(_terms_.back());
+}
+
+double Expansion::estimate() const {
+    return ::estimate((int) _terms_.size(), _terms_.data());
+}
+
+
+// ===== LONG DOUBLE =====
+
+namespace {
+    // half an ulp of 1 in long double
+    const long double LONG_EPSILON = numeric_limits<long double>::epsilon() / 2;
+
+    const long double LONG_ORIENT_ERROR_BOUND = (3 + 16 * LONG_EPSILON) * LONG_EPSILON;
+    const long double LONG_CROSS_ERROR_BOUND = 8 * LONG_EPSILON;
+
+    // value as an exact sum of doubles: one term when long double is double,
+    // two for the x87 format, three for quadruple precision
+    Expansion split(long double value) {
+        const int MAX_TERMS = numeric_limits<long double>::digits / numeric_limits<double>::digits + 2;
+        Expansion sum;
+        for (int i = 0; i < MAX_TERMS && value != 0; i++) {
+            double head = (double) value;
+            sum = sum + Expansion(head);
+            value -= head;
+        }
+        return sum;
+    }
+
+    int sign(long double value) {
+        return (value > 0) - (value < 0);
+    }
+}
+
+long double orient2d(const BasicPoint<long double> &A, const BasicPoint<long double> &B,
+                     const BasicPoint<long double> &C) {
+    long double det_left = (A.getX() - C.getX()) * (B.getY() - C.getY());
+    long double det_right = (A.getY() - C.getY()) * (B.getX() - C.getX());
+    long double det = det_left - det_right;
+
+    if ((det_left > 0 && det_right <= 0) || (det_left < 0 && det_right >= 0) || det_left == 0) {
+        return det;
+    }
+    long double error_bound = LONG_ORIENT_ERROR_BOUND * (abs(det_left) + abs(det_right));
+    if ((det >= error_bound || -det >= error_bound) && isfinite(det)) {
+        return det;
+    }
+
+    Expansion cx = split(C.getX()), cy = split(C.getY());
+    Expansion exact = (split(A.getX()) - cx) * (split(B.getY()) - cy) - (split(A.getY()) - cy) * (split(B.getX()) - cx);
+    return exact.estimate();
+}
+
+int crossSign(const BasicPoint<long double> &A, const BasicPoint<long double> &B, const BasicPoint<long double> &C,
+              const BasicPoint<long double> &D) {
+    long double ex = B.getX() - A.getX(), ey = B.getY() - A.getY();
+    long double fx = D.getX() - C.getX(), fy = D.getY() - C.getY();
+    long double det_left = ex * fy;
+    long double det_right = ey * fx;
+    long double det = det_left - det_right;
+
+    long double error_bound = LONG_CROSS_ERROR_BOUND * (abs(det_left) + abs(det_right));
+    if ((det > error_bound || -det > error_bound) && isfinite(det)) {
+        return sign(det);
+    }
+
+    Expansion exact = (split(B.getX()) - split(A.getX())) * (split(D.getY()) - split(C.getY())) -
+                      (split(B.getY()) - split(A.getY())) * (split(D.getX()) - split(C.getX()));
+    return exact.sign();
+}
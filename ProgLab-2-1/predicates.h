@@ -0,0 +1,119 @@
+#ifndef PROGLAB_2_1_PREDICATES_H
+#define PROGLAB_2_1_PREDICATES_H
+
+#include "geometry.h"
+
+// Adaptive precision predicates after J. R. Shewchuk, "Adaptive Precision
+// Floating-Point Arithmetic and Fast Robust Geometric Predicates" (1997).
+// The sign of every result is exact. A floating point filter settles almost
+// all calls at the cost of a plain determinant, the exact expansion
+// arithmetic only runs when the filter cannot decide.
+
+// exact stages of orient2d, only called when the filter below cannot decide
+double orient2dAdapt(const Point &A, const Point &B, const Point &C, double det_sum);
+
+// positive when C lies to the left of the directed line A -> B, negative when
+// it lies to the right and 0 when the three points are collinear
+inline double orient2d(const Point &A, const Point &B, const Point &C) {
+    // (3 + 16 eps) eps for eps = 2^-53
+    const double ERROR_BOUND = 3.3306690738754716e-16;
+
+    double det_left = (A.getX() - C.getX()) * (B.getY() - C.getY());
+    double det_right = (A.getY() - C.getY()) * (B.getX() - C.getX());
+    double det = det_left - det_right;
+    double det_sum;
+
+    if (det_left > 0) {
+        if (det_right <= 0) {
+            return det;
+        }
+        det_sum = det_left + det_right;
+    } else if (det_left < 0) {
+        if (det_right >= 0) {
+            return det;
+        }
+        det_sum = -det_left - det_right;
+    } else {
+        return det;
+    }
+
+    if (det >= ERROR_BOUND * det_sum || -det >= ERROR_BOUND * det_sum) {
+        return det;
+    }
+    return orient2dAdapt(A, B, C, det_sum);
+}
+
+// sign of the pseudo scalar product (B - A) * (D - C): 1, -1 or 0
+int crossSign(const Point &A, const Point &B, const Point &C, const Point &D);
+
+// An exact real number kept as a sum of doubles (a nonoverlapping expansion,
+// smallest term first), for predicates of higher degree than the ones above.
+// Every operation is exact; the number of terms grows with the degree.
+class Expansion {
+private:
+    vector<double> _terms_;
+public:
+    // constructor
+    Expansion(double value = 0) : _terms_{value} {}
+
+    // exact a - b and a * b
+    static Expansion difference(double a, double b);
+
+    static Expansion product(double a, double b);
+
+    friend Expansion operator+(const Expansion &A, const Expansion &B);
+
+    friend Expansion operator-(const Expansion &A, const Expansion &B);
+
+    friend Expansion operator*(const Expansion &A, const Expansion &B);
+
+    Expansion operator-() const;
+
+    // ===== FUNCTIONS =====
+
+    int sign() const;
+
+    // the nearest double, up to the rounding of the final sum
+    double estimate() const;
+};
+
+// ===== OTHER COORDINATE TYPES =====
+
+// every float is exactly a double, so the double predicates decide float coordinates
+inline double orient2d(const BasicPoint<float> &A, const BasicPoint<float> &B, const BasicPoint<float> &C) {
+    return orient2d(Point(A), Point(B), Point(C));
+}
+
+inline int crossSign(const BasicPoint<float> &A, const BasicPoint<float> &B, const BasicPoint<float> &C,
+                     const BasicPoint<float> &D) {
+    return crossSign(Point(A), Point(B), Point(C), Point(D));
+}
+
+// The same filter in long double arithmetic; the exact stage writes every
+// coordinate as a sum of doubles and evaluates the determinant as an
+// Expansion. Exact for coordinates in the range of double.
+long double orient2d(const BasicPoint<long double> &A, const BasicPoint<long double> &B,
+                     const BasicPoint<long double> &C);
+
+int crossSign(const BasicPoint<long double> &A, const BasicPoint<long double> &B, const BasicPoint<long double> &C,
+              const BasicPoint<long double> &D);
+
+// Integer coordinates are decided in 128-bit arithmetic, exactly for
+// coordinates within +-2^62: no filter and no rounding. The coordinates are
+// widened before they are subtracted, differences of up to 2^63 do not fit
+// int64_t.
+inline __int128 orient2d(const BasicPoint<int64_t> &A, const BasicPoint<int64_t> &B, const BasicPoint<int64_t> &C) {
+    // twice the area of a triangle inside the 2^63 wide square of the grid, at most 2^126
+    return ((__int128) A.getX() - C.getX()) * ((__int128) B.getY() - C.getY()) -
+           ((__int128) A.getY() - C.getY()) * ((__int128) B.getX() - C.getX());
+}
+
+inline int crossSign(const BasicPoint<int64_t> &A, const BasicPoint<int64_t> &B, const BasicPoint<int64_t> &C,
+                     const BasicPoint<int64_t> &D) {
+    // each product is at most 2^126, their difference may not fit: they are compared instead
+    __int128 left = ((__int128) B.getX() - A.getX()) * ((__int128) D.getY() - C.getY());
+    __int128 right = ((__int128) B.getY() - A.getY()) * ((__int128) D.getX() - C.getX());
+    return (left > right) - (left < right);
+}
+
+#endif //PROGLAB_2_1_PREDICATES_H
@@ -0,0 +1,183 @@
+#include "prepared.h"
+#include "parallel.h"
+#include "predicates.h"
+#include <algorithm>
+
+namespace {
+    // points per scheduling chunk of the batch queries
+    const long long QUERY_CHUNK = 4096;
+}
+
+// constructor
+PreparedPolygon::PreparedPolygon(Polygon &polygon) {
+    long long n = polygon.degree();
+    if (n == 0) {
+        return;
+    }
+    const Point *vertexes = polygon.data();
+    _box_ = polygon.boundingBox();
+
+    _levels_.reserve(n);
+    for (long long i = 0; i < n; i++) {
+        _levels_.push_back(vertexes[i].getY());
+    }
+    sort(_levels_.begin(), _levels_.end());
+    _levels_.erase(unique(_levels_.begin(), _levels_.end()), _levels_.end());
+    auto level = [&](double y) {
+        return (long long) (lower_bound(_levels_.begin(), _levels_.end(), y) - _levels_.begin());
+    };
+
+    long long slabs = (long long) _levels_.size() - 1;
+    _leaves_ = 1;
+    while (_leaves_ < slabs) {
+        _leaves_ *= 2;
+    }
+
+    // calls add(node) for the nodes whose slab ranges make up [first, last)
+    auto forNodes = [&](long long first, long long last, auto &&add) {
+        for (first += _leaves_, last += _leaves_; first < last; first /= 2, last /= 2) {
+            if (first % 2 == 1) {
+                add(first++);
+            }
+            if (last % 2 == 1) {
+                add(--last);
+            }
+        }
+    };
+
+    // counted first so that every node can be filled in place
+    vector<Edge> edges;
+    edges.reserve(n);
+    _node_starts_.assign(2 * _leaves_ + 1, 0);
+    for (long long i = 0; i < n; i++) {
+        Point lower = vertexes[i], upper = vertexes[(i + 1) % n];
+        if (lower.getY() == upper.getY()) {
+            if (lower.getX() > upper.getX()) {
+                swap(lower, upper);
+            }
+            _horizontal_edges_.push_back({lower, upper});
+            continue;
+        }
+        if (lower.getY() > upper.getY()) {
+            swap(lower, upper);
+        }
+        edges.push_back({lower, upper});
+        forNodes(level(lower.getY()), level(upper.getY()), [&](long long node) { _node_starts_[node + 1]++; });
+    }
+    for (long long node = 0; node < 2 * _leaves_; node++) {
+        _node_starts_[node + 1] += _node_starts_[node];
+    }
+    _node_edges_.resize(_node_starts_.back());
+    vector<long long> filled(_node_starts_.begin(), _node_starts_.end() - 1);
+    for (const Edge &edge: edges) {
+        forNodes(level(edge.lower.getY()), level(edge.upper.getY()),
+                 [&](long long node) { _node_edges_[filled[node]++] = edge; });
+    }
+
+    // edges of a node do not cross inside its height, so their order halfway up is their order everywhere there
+    for (long long node = 1; node < 2 * _leaves_; node++) {
+        if (_node_starts_[node] == _node_starts_[node + 1]) {
+            continue;
+        }
+        // the node lies depth levels below the root and covers width slabs from slab first on
+        long long depth = 0;
+        while ((node >> (depth + 1)) > 0) {
+            depth++;
+        }
+        long long width = _leaves_ >> depth, first = (node - (1LL << depth)) * width;
+        double middle = (_levels_[first] + _levels_[min(first + width, slabs)]) / 2;
+        auto xAt = [middle](const Edge &edge) {
+            double t = (middle - edge.lower.getY()) / (edge.upper.getY() - edge.lower.getY());
+            return edge.lower.getX() + t * (edge.upper.getX() - edge.lower.getX());
+        };
+        sort(_node_edges_.begin() + _node_starts_[node], _node_edges_.begin() + _node_starts_[node + 1],
+             [&](const Edge &A, const Edge &B) { return xAt(A) < xAt(B); });
+    }
+
+    sort(_horizontal_edges_.begin(), _horizontal_edges_.end(), [](const Edge &A, const Edge &B) {
+        return A.lower.getY() < B.lower.getY() || (A.lower.getY() == B.lower.getY() && A.lower.getX() < B.lower.getX());
+    });
+}
+
+long long PreparedPolygon::edgesLeftOf(long long node, const Point &point) const {
+    auto first = _node_edges_.begin() + _node_starts_[node];
+    auto last = _node_edges_.begin() + _node_starts_[node + 1];
+    auto found = partition_point(first, last, [&](const Edge &edge) {
+        return orient2d(edge.lower, edge.upper, point) < 0;
+    });
+    if (found != last && orient2d(found->lower, found->upper, point) == 0) {
+        return -1;
+    }
+    return found - first;
+}
+
+long long PreparedPolygon::edgesLeftInSlab(long long slab, const Point &point) const {
+    long long total = 0;
+    for (long long node = slab + _leaves_; node > 0; node /= 2) {
+        long long left = edgesLeftOf(node, point);
+        if (left == -1) {
+            return -1;
+        }
+        total += left;
+    }
+    return total;
+}
+
+bool PreparedPolygon::onHorizontalEdge(const Point &point) const {
+    // the last edge on the point's level starting at or before it
+    auto found = upper_bound(_horizontal_edges_.begin(), _horizontal_edges_.end(), point,
+                             [](const Point &P, const Edge &edge) {
+                                 return P.getY() < edge.lower.getY() ||
+                                        (P.getY() == edge.lower.getY() && P.getX() < edge.lower.getX());
+                             });
+    if (found == _horizontal_edges_.begin()) {
+        return false;
+    }
+    --found;
+    return found->lower.getY() == point.getY() && point.getX() <= found->upper.getX();
+}
+
+// ===== FUNCTIONS =====
+
+bool PreparedPolygon::contains(const Point &point) const {
+    if (!_box_.contains(point)) {
+        return false;
+    }
+    long long slabs = (long long) _levels_.size() - 1;
+    long long k = lower_bound(_levels_.begin(), _levels_.end(), point.getY()) - _levels_.begin();
+    if (_levels_[k] != point.getY()) {
+        // strictly inside slab k - 1
+        long long left = edgesLeftInSlab(k - 1, point);
+        return left == -1 || left % 2 == 1;
+    }
+
+    // on the level of some vertexes: the point may sit on a horizontal edge or on
+    // the top end of an edge of the slab below, otherwise the slab above decides
+    if (onHorizontalEdge(point) || (k > 0 && edgesLeftInSlab(k - 1, point) == -1)) {
+        return true;
+    }
+    if (k == slabs) {
+        return false;
+    }
+    long long left = edgesLeftInSlab(k, point);
+    return left == -1 || left % 2 == 1;
+}
+
+void PreparedPolygon::contains(const Point *points, long long n, vector<uint8_t> &inside, unsigned threads) const {
+    inside.resize(n);
+    parallelFor(n, QUERY_CHUNK, [&](long long begin, long long end) {
+        for (long long i = begin; i < end; i++) {
+            inside[i] = contains(points[i]);
+        }
+    }, threads);
+}
+
+void PreparedPolygon::contains(const double *x, const double *y, long long n, vector<uint8_t> &inside,
+                               unsigned threads) const {
+    inside.resize(n);
+    parallelFor(n, QUERY_CHUNK, [&](long long begin, long long end) {
+        for (long long i = begin; i < end; i++) {
+            inside[i] = contains(Point(x[i], y[i]));
+        }
+    }, threads);
+}
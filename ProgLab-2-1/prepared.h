@@ -0,0 +1,64 @@
+#ifndef PROGLAB_2_1_PREPARED_H
+#define PROGLAB_2_1_PREPARED_H
+
+#include "geometry.h"
+#include <cstdint>
+
+// A Polygon preprocessed for point containment queries.
+//
+// The horizontal lines through the vertexes cut the plane into slabs, and a
+// segment tree over the slabs keeps every edge in the O(log n) nodes whose
+// slab ranges together make up the edge's height. The edges of one node span
+// the whole height of the node, so no two of them cross there and they are
+// kept ordered from left to right. A query walks from its slab up to the root
+// with one binary search per node: O(log^2 n) per point, O(n log n) memory
+// whatever the shape of the polygon.
+//
+// Points on the boundary count as contained, the same way touching segments
+// intersect for DirectSegment::intersects. Every side test is the exact orient2d,
+// so the answers match Polygon::contains.
+class PreparedPolygon {
+private:
+    // lower and upper end of an edge, left and right end for horizontal ones
+    struct Edge {
+        Point lower;
+        Point upper;
+    };
+
+    Box _box_;
+    // distinct y of the vertexes, increasing; slab k lies between _levels_[k] and _levels_[k + 1]
+    vector<double> _levels_;
+    // number of leaves of the segment tree (a power of two), node i has children 2i and 2i + 1
+    long long _leaves_ = 0;
+    // the edges of node i are _node_edges_[_node_starts_[i]] ... _node_edges_[_node_starts_[i + 1] - 1]
+    vector<long long> _node_starts_;
+    vector<Edge> _node_edges_;
+    // ordered by y, then by x
+    vector<Edge> _horizontal_edges_;
+
+    // number of edges of the node strictly left of the point, -1 when the point is on one of them
+    long long edgesLeftOf(long long node, const Point &point) const;
+
+    // edges left of the point over all the nodes above the slab, -1 when the point is on one of them
+    long long edgesLeftInSlab(long long slab, const Point &point) const;
+
+    bool onHorizontalEdge(const Point &point) const;
+
+public:
+    // constructor
+    PreparedPolygon() = default;
+
+    explicit PreparedPolygon(Polygon &polygon);
+
+    // ===== FUNCTIONS =====
+
+    bool contains(const Point &point) const;
+
+    // inside[i] is 1 when points[i] is contained and 0 otherwise, threads = 0 uses every hardware thread
+    void contains(const Point *points, long long n, vector<uint8_t> &inside, unsigned threads = 0) const;
+
+    void contains(const double *x, const double *y, long long n, vector<uint8_t> &inside,
+                  unsigned threads = 0) const;
+};
+
+#endif //PROGLAB_2_1_PREPARED_H
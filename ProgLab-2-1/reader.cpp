@@ -0,0 +1,746 @@
+#include "reader.h"
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+long long GeometryBatch::size() const {
+    return (long long) (polylines.size() + polygons.size() + errors.size());
+}
+
+void GeometryBatch::clear() {
+    polylines.clear();
+    polyline_features.clear();
+    polygons.clear();
+    polygon_features.clear();
+    errors.clear();
+}
+
+
+// constructor
+MappedFile::MappedFile(const string &path) {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+// ===== FUNCTIONS =====
+
+bool MappedFile::open(const string &path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    _size_ = size.QuadPart;
+    if (_size_ > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (view != nullptr) {
+                _data_ = static_cast<const char *>(view);
+                _mapped_ = true;
+            }
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat info{};
+    if (fstat(file, &info) != 0) {
+        ::close(file);
+        return false;
+    }
+    _size_ = (long long) info.st_size;
+    if (S_ISREG(info.st_mode) && _size_ > 0) {
+        void *view = mmap(nullptr, (size_t) _size_, PROT_READ, MAP_PRIVATE, file, 0);
+        if (view != MAP_FAILED) {
+            madvise(view, (size_t) _size_, MADV_SEQUENTIAL);
+            _data_ = static_cast<const char *>(view);
+            _mapped_ = true;
+        }
+    }
+    ::close(file);
+#endif
+    if (!_mapped_) {
+        // mapping is not possible (pipes, special files), read the whole stream instead
+        ifstream stream(path, ios::binary);
+        if (!stream) {
+            _size_ = 0;
+            return false;
+        }
+        _buffer_.assign(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+        _size_ = (long long) _buffer_.size();
+        _data_ = _buffer_.data();
+    }
+    if (_size_ == 0) {
+        _data_ = "";
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (_mapped_) {
+#ifdef _WIN32
+        UnmapViewOfFile(_data_);
+#else
+        munmap(const_cast<char *>(_data_), (size_t) _size_);
+#endif
+    }
+    _buffer_.clear();
+    _buffer_.shrink_to_fit();
+    _data_ = nullptr;
+    _size_ = 0;
+    _mapped_ = false;
+}
+
+bool MappedFile::isOpen() const {
+    return _data_ != nullptr;
+}
+
+const char *MappedFile::data() const {
+    return _data_;
+}
+
+long long MappedFile::size() const {
+    return _size_;
+}
+
+
+namespace {
+    // why a ring was refused, in lower case as the other messages, with the vertex or edges at fault
+    string ringError(const ShapeStatus &status) {
+        string message = describe(status.error);
+        message[0] = (char) tolower(message[0]);
+        if (status.edge >= 0) {
+            message += ": edges " + to_string(status.vertex) + " and " + to_string(status.edge);
+        } else if (status.vertex >= 0) {
+            message += ": vertex " + to_string(status.vertex);
+        }
+        return message;
+    }
+
+    // collects shapes and errors and hands them to the callback batch by batch
+    class Emitter {
+    private:
+        const BatchCallback &_callback_;
+        long long _batch_size_;
+        GeometryBatch _batch_;
+
+        void maybeFlush() {
+            if (_batch_.size() >= _batch_size_) {
+                flush();
+            }
+        }
+
+    public:
+        Emitter(const BatchCallback &callback, long long batch_size)
+                : _callback_(callback), _batch_size_(max(batch_size, 1LL)) {}
+
+        void polyline(pmr::vector<Point> &&points, long long feature) {
+            _batch_.polylines.emplace_back(move(points));
+            _batch_.polyline_features.push_back(feature);
+            maybeFlush();
+        }
+
+        void polygon(pmr::vector<Point> &&points, long long feature, long long offset) {
+            // rings in both formats repeat the first vertex at the end
+            if (points.size() > 1 && points.front() == points.back()) {
+                points.pop_back();
+            }
+            Checked<Polygon> made = Polygon::tryMake(move(points));
+            if (!made.status) {
+                error(feature, offset, ringError(made.status));
+                return;
+            }
+            _batch_.polygons.push_back(move(made.shape));
+            _batch_.polygon_features.push_back(feature);
+            maybeFlush();
+        }
+
+        void error(long long feature, long long offset, string message) {
+            _batch_.errors.push_back({feature, offset, move(message)});
+            maybeFlush();
+        }
+
+        void flush() {
+            if (_batch_.size() > 0) {
+                _callback_(_batch_);
+                _batch_.clear();
+            }
+        }
+    };
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    // ===== WKT =====
+
+    class WKTParser {
+    private:
+        const char *_begin_;
+        const char *_at_;
+        const char *_end_;
+        Emitter &_emitter_;
+        long long _feature_ = -1;
+
+        long long offset() const {
+            return _at_ - _begin_;
+        }
+
+        bool fail(const string &message) {
+            _emitter_.error(_feature_, offset(), message);
+            return false;
+        }
+
+        void skipSpaces() {
+            while (_at_ < _end_ && isSpace(*_at_)) {
+                _at_++;
+            }
+        }
+
+        bool accept(char c) {
+            skipSpaces();
+            if (_at_ < _end_ && *_at_ == c) {
+                _at_++;
+                return true;
+            }
+            return false;
+        }
+
+        bool expect(char c) {
+            return accept(c) || fail(string("expected '") + c + "'");
+        }
+
+        string word() {
+            skipSpaces();
+            string result;
+            while (_at_ < _end_ && isalpha((unsigned char) *_at_)) {
+                result += (char) toupper((unsigned char) *_at_);
+                _at_++;
+            }
+            return result;
+        }
+
+        bool number(double &value) {
+            skipSpaces();
+            auto parsed = from_chars(_at_, _end_, value);
+            if (parsed.ec != errc()) {
+                return fail("expected a number");
+            }
+            _at_ = parsed.ptr;
+            return true;
+        }
+
+        bool point(Point &point) {
+            double x, y, extra;
+            if (!number(x) || !number(y)) {
+                return false;
+            }
+            // Z and M ordinates are read and dropped
+            skipSpaces();
+            while (_at_ < _end_ && *_at_ != ',' && *_at_ != ')') {
+                if (!number(extra)) {
+                    return false;
+                }
+                skipSpaces();
+            }
+            point = Point(x, y);
+            return true;
+        }
+
+        // "(x y, x y, ...)"
+        bool pointList(pmr::vector<Point> &points) {
+            if (!expect('(')) {
+                return false;
+            }
+            long long commas = 0;
+            for (const char *scan = _at_; scan < _end_ && *scan != ')'; scan++) {
+                commas += *scan == ',';
+            }
+            points.clear();
+            points.reserve(commas + 1);
+            do {
+                Point vertex;
+                if (!point(vertex)) {
+                    return false;
+                }
+                points.push_back(vertex);
+            } while (accept(','));
+            return expect(')');
+        }
+
+        // "((x y, ...))", only the outer ring
+        bool polygonBody() {
+            long long start = offset();
+            pmr::vector<Point> ring;
+            if (!expect('(') || !pointList(ring)) {
+                return false;
+            }
+            if (accept(',')) {
+                return fail("polygon holes are not supported");
+            }
+            if (!expect(')')) {
+                return false;
+            }
+            _emitter_.polygon(move(ring), _feature_, start);
+            return true;
+        }
+
+        bool geometry() {
+            string type = word();
+            if (type.empty()) {
+                return fail("expected a geometry type");
+            }
+            string next = word();
+            if (next == "Z" || next == "M" || next == "ZM") {
+                next = word();
+            }
+            if (next == "EMPTY") {
+                return true;
+            }
+            if (!next.empty()) {
+                return fail("unexpected " + next);
+            }
+
+            if (type == "LINESTRING") {
+                pmr::vector<Point> points;
+                if (!pointList(points)) {
+                    return false;
+                }
+                _emitter_.polyline(move(points), _feature_);
+                return true;
+            }
+            if (type == "POLYGON") {
+                return polygonBody();
+            }
+            if (type == "MULTILINESTRING") {
+                if (!expect('(')) {
+                    return false;
+                }
+                do {
+                    pmr::vector<Point> points;
+                    if (!pointList(points)) {
+                        return false;
+                    }
+                    _emitter_.polyline(move(points), _feature_);
+                } while (accept(','));
+                return expect(')');
+            }
+            if (type == "MULTIPOLYGON") {
+                if (!expect('(')) {
+                    return false;
+                }
+                do {
+                    if (!polygonBody()) {
+                        return false;
+                    }
+                } while (accept(','));
+                return expect(')');
+            }
+            return fail("unsupported geometry type " + type);
+        }
+
+        // true at the end of the line, spaces and tabs are skipped
+        bool atLineEnd() {
+            while (_at_ < _end_ && *_at_ != '\n' && isSpace(*_at_)) {
+                _at_++;
+            }
+            return _at_ >= _end_ || *_at_ == '\n';
+        }
+
+        // continues after a broken geometry with the next line
+        void skipLine() {
+            while (_at_ < _end_ && *_at_ != '\n') {
+                _at_++;
+            }
+        }
+
+    public:
+        WKTParser(const char *text, long long length, Emitter &emitter)
+                : _begin_(text), _at_(text), _end_(text + length), _emitter_(emitter) {}
+
+        long long parse() {
+            while (true) {
+                skipSpaces();
+                if (_at_ >= _end_) {
+                    break;
+                }
+                _feature_++;
+                if (!geometry()) {
+                    skipLine();
+                    continue;
+                }
+                // a ';' may end the geometry, any other text after it breaks this geometry only
+                if (!atLineEnd() && !accept(';')) {
+                    fail("unexpected text after the geometry");
+                    skipLine();
+                }
+            }
+            return _feature_ + 1;
+        }
+    };
+
+    // ===== GeoJSON =====
+
+    class GeoJSONParser {
+    private:
+        const char *_begin_;
+        const char *_at_;
+        const char *_end_;
+        Emitter &_emitter_;
+        long long _features_ = 0;
+        long long _errors_ = 0;
+
+        long long offset() const {
+            return _at_ - _begin_;
+        }
+
+        bool fail(long long feature, const string &message) {
+            _emitter_.error(feature, offset(), message);
+            _errors_++;
+            return false;
+        }
+
+        void skipSpaces() {
+            while (_at_ < _end_ && isSpace(*_at_)) {
+                _at_++;
+            }
+        }
+
+        bool accept(char c) {
+            skipSpaces();
+            if (_at_ < _end_ && *_at_ == c) {
+                _at_++;
+                return true;
+            }
+            return false;
+        }
+
+        bool peek(char c) {
+            skipSpaces();
+            return _at_ < _end_ && *_at_ == c;
+        }
+
+        // raw contents of a string, escapes are kept as they are
+        bool text(string_view &value) {
+            if (!accept('"')) {
+                return false;
+            }
+            const char *start = _at_;
+            while (_at_ < _end_ && *_at_ != '"') {
+                // an escape skips the next character, unless the input ends before it
+                if (*_at_ == '\\' && _at_ + 1 < _end_) {
+                    _at_ += 2;
+                } else {
+                    _at_++;
+                }
+            }
+            if (_at_ >= _end_) {
+                return false;
+            }
+            value = string_view(start, _at_ - start);
+            _at_++;
+            return true;
+        }
+
+        bool skipValue() {
+            skipSpaces();
+            if (_at_ >= _end_) {
+                return false;
+            }
+            char c = *_at_;
+            if (c == '"') {
+                string_view ignored;
+                return text(ignored);
+            }
+            if (c == '{' || c == '[') {
+                char close = (c == '{') ? '}' : ']';
+                _at_++;
+                if (accept(close)) {
+                    return true;
+                }
+                do {
+                    if (c == '{') {
+                        string_view key;
+                        if (!text(key) || !accept(':')) {
+                            return false;
+                        }
+                    }
+                    if (!skipValue()) {
+                        return false;
+                    }
+                } while (accept(','));
+                return accept(close);
+            }
+            const char *start = _at_;
+            while (_at_ < _end_ && (isalnum((unsigned char) *_at_) || *_at_ == '-' || *_at_ == '+' || *_at_ == '.')) {
+                _at_++;
+            }
+            return _at_ > start;
+        }
+
+        // ===== COORDINATES =====
+
+        bool number(double &value) {
+            skipSpaces();
+            auto parsed = from_chars(_at_, _end_, value);
+            if (parsed.ec != errc()) {
+                return false;
+            }
+            _at_ = parsed.ptr;
+            return true;
+        }
+
+        // [x, y, ...], further ordinates are dropped
+        bool position(Point &point) {
+            double x, y, extra;
+            if (!accept('[') || !number(x) || !accept(',') || !number(y)) {
+                return false;
+            }
+            while (accept(',')) {
+                if (!number(extra)) {
+                    return false;
+                }
+            }
+            point = Point(x, y);
+            return accept(']');
+        }
+
+        // [[x, y], [x, y], ...]
+        bool positions(pmr::vector<Point> &points) {
+            if (!accept('[')) {
+                return false;
+            }
+            long long opened = 0;
+            for (const char *scan = _at_; scan < _end_ && *scan != ']'; scan++) {
+                if (*scan == '[') {
+                    opened++;
+                    while (scan < _end_ && *scan != ']') {
+                        scan++;
+                    }
+                }
+            }
+            points.clear();
+            points.reserve(opened);
+            if (accept(']')) {
+                return true;
+            }
+            do {
+                Point point;
+                if (!position(point)) {
+                    return false;
+                }
+                points.push_back(point);
+            } while (accept(','));
+            return accept(']');
+        }
+
+        bool polygonRings(long long feature) {
+            long long start = offset();
+            pmr::vector<Point> ring;
+            if (!accept('[') || !positions(ring)) {
+                return false;
+            }
+            if (accept(',')) {
+                return fail(feature, "polygon holes are not supported");
+            }
+            if (!accept(']')) {
+                return false;
+            }
+            _emitter_.polygon(move(ring), feature, start);
+            return true;
+        }
+
+        template<class Part>
+        bool partList(const Part &part) {
+            if (!accept('[')) {
+                return false;
+            }
+            if (accept(']')) {
+                return true;
+            }
+            do {
+                if (!part()) {
+                    return false;
+                }
+            } while (accept(','));
+            return accept(']');
+        }
+
+        // reads the coordinates value at the current position, a malformed value
+        // only costs this feature; false when the value is not even valid JSON
+        bool coordinates(string_view type, long long feature) {
+            const char *from = _at_;
+            long long errors = _errors_;
+
+            bool ok = true;
+            if (type == "LineString") {
+                pmr::vector<Point> points;
+                ok = positions(points);
+                if (ok) {
+                    _emitter_.polyline(move(points), feature);
+                }
+            } else if (type == "Polygon") {
+                ok = polygonRings(feature);
+            } else if (type == "MultiLineString") {
+                ok = partList([&]() {
+                    pmr::vector<Point> points;
+                    if (!positions(points)) {
+                        return false;
+                    }
+                    _emitter_.polyline(move(points), feature);
+                    return true;
+                });
+            } else if (type == "MultiPolygon") {
+                ok = partList([&]() { return polygonRings(feature); });
+            } else {
+                ok = false;
+                fail(feature, "unsupported geometry type " + string(type));
+            }
+            if (ok) {
+                return true;
+            }
+            if (errors == _errors_) {
+                fail(feature, "malformed coordinates");
+            }
+            _at_ = from;
+            return skipValue();
+        }
+
+        // any object: a geometry, a Feature or a FeatureCollection
+        bool object(long long feature, string_view &type) {
+            if (!accept('{')) {
+                return fail(feature, "expected an object");
+            }
+            type = string_view();
+            // "type" usually comes first, otherwise the coordinates are read at the end
+            const char *coordinates_from = nullptr;
+            if (!accept('}')) {
+                do {
+                    string_view key;
+                    if (!text(key) || !accept(':')) {
+                        return fail(feature, "expected a member name");
+                    }
+                    if (key == "type" && peek('"')) {
+                        text(type);
+                    } else if (key == "coordinates") {
+                        skipSpaces();
+                        if (type.empty()) {
+                            coordinates_from = _at_;
+                            if (!skipValue()) {
+                                return fail(feature, "malformed value");
+                            }
+                        } else if (!coordinates(type, feature)) {
+                            // coordinates() has reported this feature already
+                            return false;
+                        }
+                    } else if (key == "geometry" && peek('{')) {
+                        string_view geometry_type;
+                        if (!object(feature, geometry_type)) {
+                            return false;
+                        }
+                    } else if (key == "geometries" || key == "features") {
+                        bool is_collection = key == "features";
+                        if (!accept('[')) {
+                            return fail(feature, "expected an array");
+                        }
+                        if (!accept(']')) {
+                            do {
+                                string_view member_type;
+                                if (!object(is_collection ? _features_++ : feature, member_type)) {
+                                    return false;
+                                }
+                            } while (accept(','));
+                            if (!accept(']')) {
+                                return fail(feature, "expected ']'");
+                            }
+                        }
+                    } else if (!skipValue()) {
+                        return fail(feature, "malformed value");
+                    }
+                } while (accept(','));
+                if (!accept('}')) {
+                    return fail(feature, "expected '}'");
+                }
+            }
+            if (coordinates_from != nullptr) {
+                const char *end = _at_;
+                _at_ = coordinates_from;
+                coordinates(type, feature);
+                _at_ = end;
+            }
+            return true;
+        }
+
+    public:
+        GeoJSONParser(const char *text, long long length, Emitter &emitter)
+                : _begin_(text), _at_(text), _end_(text + length), _emitter_(emitter) {}
+
+        long long parse() {
+            string_view type;
+            if (!object(0, type)) {
+                // the structure is broken, nothing after this point can be trusted
+                return max(_features_, 1LL);
+            }
+            skipSpaces();
+            if (_at_ < _end_) {
+                fail(0, "unexpected text after the document");
+            }
+            return type == "FeatureCollection" ? _features_ : 1;
+        }
+    };
+}
+
+long long parseWKT(const char *text, long long length, const BatchCallback &callback, long long batch_size) {
+    Emitter emitter(callback, batch_size);
+    long long features = WKTParser(text, length, emitter).parse();
+    emitter.flush();
+    return features;
+}
+
+long long parseGeoJSON(const char *text, long long length, const BatchCallback &callback, long long batch_size) {
+    Emitter emitter(callback, batch_size);
+    long long features = GeoJSONParser(text, length, emitter).parse();
+    emitter.flush();
+    return features;
+}
+
+long long readWKT(const string &path, const BatchCallback &callback, long long batch_size) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return -1;
+    }
+    return parseWKT(file.data(), file.size(), callback, batch_size);
+}
+
+long long readGeoJSON(const string &path, const BatchCallback &callback, long long batch_size) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return -1;
+    }
+    return parseGeoJSON(file.data(), file.size(), callback, batch_size);
+}
@@ -0,0 +1,87 @@
+#ifndef PROGLAB_2_1_READER_H
+#define PROGLAB_2_1_READER_H
+
+#include "geometry.h"
+#include <functional>
+
+// Streaming WKT and GeoJSON input. The text is scanned once, coordinates are
+// converted with from_chars straight into vertex buffers and the resulting
+// shapes are handed out in batches, no document tree is ever built.
+//
+// WKT input is one geometry per line: LINESTRING, POLYGON, MULTILINESTRING
+// and MULTIPOLYGON, optionally with Z, M or ZM coordinates (extra ordinates
+// are dropped). GeoJSON input is a FeatureCollection, a single Feature or a
+// bare geometry; LineString, Polygon, MultiLineString, MultiPolygon and
+// GeometryCollection geometries are read. Polygon rings may repeat their first
+// vertex at the end, holes are not supported. Text after a WKT geometry on its
+// line, or after the GeoJSON document, is reported as an error.
+
+// a problem with one feature, the rest of the input is still read
+struct ParseError {
+    // zero based index of the WKT geometry / GeoJSON feature
+    long long feature;
+    // byte offset in the input where the problem was found
+    long long offset;
+    string message;
+};
+
+// the shapes read since the previous batch, the callback may move them out
+struct GeometryBatch {
+    vector<Polyline> polylines;
+    vector<long long> polyline_features;
+    vector<Polygon> polygons;
+    vector<long long> polygon_features;
+    vector<ParseError> errors;
+
+    long long size() const;
+
+    void clear();
+};
+
+using BatchCallback = function<void(GeometryBatch &batch)>;
+
+// read-only view of a whole file, memory mapped where the platform allows it
+class MappedFile {
+private:
+    const char *_data_ = nullptr;
+    long long _size_ = 0;
+    bool _mapped_ = false;
+    vector<char> _buffer_;
+public:
+    // constructor
+    MappedFile() = default;
+
+    explicit MappedFile(const string &path);
+
+    MappedFile(const MappedFile &file) = delete;
+
+    MappedFile &operator=(const MappedFile &file) = delete;
+
+    ~MappedFile();
+
+    // ===== FUNCTIONS =====
+
+    bool open(const string &path);
+
+    void close();
+
+    bool isOpen() const;
+
+    const char *data() const;
+
+    long long size() const;
+};
+
+// All of these return the number of features seen, or -1 when the file can
+// not be opened. batch_size is the number of shapes and errors per callback.
+
+long long parseWKT(const char *text, long long length, const BatchCallback &callback, long long batch_size = 4096);
+
+long long parseGeoJSON(const char *text, long long length, const BatchCallback &callback,
+                       long long batch_size = 4096);
+
+long long readWKT(const string &path, const BatchCallback &callback, long long batch_size = 4096);
+
+long long readGeoJSON(const string &path, const BatchCallback &callback, long long batch_size = 4096);
+
+#endif //PROGLAB_2_1_READER_H
@@ -0,0 +1,144 @@
+#include "regular.h"
+#include "kernels.h"
+#include <cmath>
+
+namespace {
+    template<class T>
+    const T PI = (T) 3.141592653589793238462643383279502884L;
+
+    template<class T>
+    ShapeStatus checkParameters(long long n, T side_len) {
+        ShapeStatus status;
+        if (n <= 2) {
+            status.error = ShapeError::TOO_FEW_VERTEXES;
+        } else if (!(side_len > 0) || !isfinite(side_len)) {
+            status.error = ShapeError::INVALID_SIDE;
+        }
+        return status;
+    }
+
+    // the angle of the vertex closest to the direction
+    template<class T>
+    T nearestVertexAngle(long long n, T rotation, T direction) {
+        T step = 2 * PI<T> / (T) n;
+        T first = rotation + PI<T> / 2 - PI<T> / (T) n;
+        return first + round((direction - first) / step) * step;
+    }
+}
+
+// constructor
+template<class T>
+BasicRegularShape<T>::BasicRegularShape(long long n, T side_len, const Point &center, T rotation) {
+    if (!checkParameters(n, side_len)) {
+        cout << "<RegularShape> The parameters do not form a polygon" << endl;
+        return;
+    }
+    _n_ = n;
+    _side_ = side_len;
+    _center_ = center;
+    _rotation_ = rotation;
+}
+
+template<class T>
+Checked<BasicRegularShape<T>> BasicRegularShape<T>::tryMake(long long n, T side_len, const Point &center,
+                                                             T rotation) {
+    Checked<BasicRegularShape> result;
+    result.status = checkParameters(n, side_len);
+    if (result.status) {
+        result.shape._n_ = n;
+        result.shape._side_ = side_len;
+        result.shape._center_ = center;
+        result.shape._rotation_ = rotation;
+    }
+    return result;
+}
+
+// ===== FUNCTIONS =====
+
+template<class T>
+long long BasicRegularShape<T>::degree() const {
+    return _n_;
+}
+
+template<class T>
+T BasicRegularShape<T>::getSide() const {
+    return _side_;
+}
+
+template<class T>
+BasicPoint<T> BasicRegularShape<T>::getCenter() const {
+    return _center_;
+}
+
+template<class T>
+T BasicRegularShape<T>::getRotation() const {
+    return _rotation_;
+}
+
+template<class T>
+T BasicRegularShape<T>::perimeter() const {
+    return (T) _n_ * _side_;
+}
+
+template<class T>
+T BasicRegularShape<T>::area() const {
+    return perimeter() * apothem() / 2;
+}
+
+template<class T>
+T BasicRegularShape<T>::circumradius() const {
+    if (_n_ == 0) {
+        return 0;
+    }
+    return _side_ / (2 * sin(PI<T> / (T) _n_));
+}
+
+template<class T>
+T BasicRegularShape<T>::apothem() const {
+    if (_n_ == 0) {
+        return 0;
+    }
+    return _side_ / (2 * tan(PI<T> / (T) _n_));
+}
+
+template<class T>
+BasicBox<T> BasicRegularShape<T>::boundingBox() const {
+    if (_n_ == 0) {
+        return Box();
+    }
+    T radius = circumradius();
+    // the extreme vertexes are the ones closest to the four axis directions
+    return Box(Point(_center_.getX() + radius * cos(nearestVertexAngle(_n_, _rotation_, PI<T>)),
+                     _center_.getY() + radius * sin(nearestVertexAngle(_n_, _rotation_, -PI<T> / 2))),
+               Point(_center_.getX() + radius * cos(nearestVertexAngle(_n_, _rotation_, (T) 0)),
+                     _center_.getY() + radius * sin(nearestVertexAngle(_n_, _rotation_, PI<T> / 2))));
+}
+
+template<class T>
+bool BasicRegularShape<T>::contains(const Point &point) const {
+    if (_n_ == 0) {
+        return false;
+    }
+    T dx = point.getX() - _center_.getX();
+    T dy = point.getY() - _center_.getY();
+    // edge j has its outward normal at rotation + pi / 2 + 2 pi j / n, the nearest normal faces the point
+    T step = 2 * PI<T> / (T) _n_;
+    T base = _rotation_ + PI<T> / 2;
+    T normal = base + round((atan2(dy, dx) - base) / step) * step;
+    return dx * cos(normal) + dy * sin(normal) <= apothem();
+}
+
+template<class T>
+void BasicRegularShape<T>::vertexes(Point *vertexes) const {
+    regularVertexes(_n_, circumradius(), _rotation_, _center_, vertexes);
+}
+
+template<class T>
+BasicRegularPolygon<T> BasicRegularShape<T>::toPolygon() const {
+    return BasicRegularPolygon<T>(*this);
+}
+
+
+template class BasicRegularShape<float>;
+template class BasicRegularShape<double>;
+template class BasicRegularShape<long double>;
@@ -0,0 +1,72 @@
+#ifndef PROGLAB_2_1_REGULAR_H
+#define PROGLAB_2_1_REGULAR_H
+
+#include "geometry.h"
+
+// A regular polygon kept as its parameters: the number of vertexes, the side
+// length, the center and a rotation (counterclockwise, in radians; with 0 the
+// first edge is on top and horizontal, as for RegularPolygon). Building one
+// allocates nothing and computes nothing. Area, perimeter, radii and
+// containment come from closed forms in O(1); the vertexes are generated only
+// when they are asked for, by regularVertexes, which computes every vertex
+// from its own exactly reduced angle instead of turning the previous one.
+
+template<class T>
+class BasicRegularShape {
+    static_assert(is_floating_point<T>::value, "the vertexes of a regular polygon are not on a grid");
+
+public:
+    using Point = BasicPoint<T>;
+    using Box = BasicBox<T>;
+private:
+    // 0 for the empty shape
+    long long _n_ = 0;
+    T _side_ = 0;
+    Point _center_;
+    T _rotation_ = 0;
+
+public:
+    // constructor
+    BasicRegularShape() = default;
+
+    BasicRegularShape(long long n, T side_len, const Point &center, T rotation = 0);
+
+    // as the constructor, but the reason of a failure is returned instead of printed
+    static Checked<BasicRegularShape> tryMake(long long n, T side_len, const Point &center, T rotation = 0);
+
+    // ===== FUNCTIONS =====
+
+    long long degree() const;
+
+    T getSide() const;
+
+    Point getCenter() const;
+
+    T getRotation() const;
+
+    T perimeter() const;
+
+    T area() const;
+
+    // distance from the center to the vertexes
+    T circumradius() const;
+
+    // distance from the center to the edges
+    T apothem() const;
+
+    Box boundingBox() const;
+
+    // true for points inside or on the boundary, decided against the one edge
+    // facing the point; points within rounding of an edge may go either way
+    bool contains(const Point &point) const;
+
+    // writes the degree() vertexes, counterclockwise
+    void vertexes(Point *vertexes) const;
+
+    // the vertexes as a RegularPolygon, its area and perimeter already known
+    BasicRegularPolygon<T> toPolygon() const;
+};
+
+using RegularShape = BasicRegularShape<double>;
+
+#endif //PROGLAB_2_1_REGULAR_H
@@ -0,0 +1,259 @@
+#include "rtree.h"
+#include "predicates.h"
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    const double HILBERT_SIDE = 1 << 16;
+
+    struct SortItem {
+        uint32_t key;
+        long long idx;
+    };
+
+    // spreads the low 16 bits of value to the even bit positions
+    uint32_t interleave(uint32_t value) {
+        value = (value | (value << 8)) & 0x00FF00FF;
+        value = (value | (value << 4)) & 0x0F0F0F0F;
+        value = (value | (value << 2)) & 0x33333333;
+        value = (value | (value << 1)) & 0x55555555;
+        return value;
+    }
+
+    // Position of the cell (x, y) along the Hilbert curve through a 2^16 x 2^16
+    // grid. Branch free: the orientation of every sub-square is worked out for
+    // all 16 levels at once with bit operations instead of one level at a time.
+    uint32_t hilbertIndex(uint32_t x, uint32_t y) {
+        const uint32_t MASK = 0xFFFF;
+        uint32_t a = x ^ y;
+        uint32_t b = MASK ^ a;
+        uint32_t c = MASK ^ (x | y);
+        uint32_t d = x & (y ^ MASK);
+
+        uint32_t A = a | (b >> 1);
+        uint32_t B = (a >> 1) ^ a;
+        uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+        uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+        a = A, b = B, c = C, d = D;
+        A = (a & (a >> 2)) ^ (b & (b >> 2));
+        B = (a & (b >> 2)) ^ (b & ((a ^ b) >> 2));
+        C ^= (a & (c >> 2)) ^ (b & (d >> 2));
+        D ^= (b & (c >> 2)) ^ ((a ^ b) & (d >> 2));
+
+        a = A, b = B, c = C, d = D;
+        A = (a & (a >> 4)) ^ (b & (b >> 4));
+        B = (a & (b >> 4)) ^ (b & ((a ^ b) >> 4));
+        C ^= (a & (c >> 4)) ^ (b & (d >> 4));
+        D ^= (b & (c >> 4)) ^ ((a ^ b) & (d >> 4));
+
+        a = A, b = B, c = C, d = D;
+        C ^= (a & (c >> 8)) ^ (b & (d >> 8));
+        D ^= (b & (c >> 8)) ^ ((a ^ b) & (d >> 8));
+
+        a = C ^ (C >> 1);
+        b = D ^ (D >> 1);
+        uint32_t i0 = x ^ y;
+        uint32_t i1 = b | (MASK ^ (i0 | a));
+        return (interleave(i1) << 1) | interleave(i0);
+    }
+
+    // stable LSD radix sort by key, a byte per pass
+    void radixSort(vector<SortItem> &items) {
+        vector<SortItem> buffer(items.size());
+        for (int shift = 0; shift < 32; shift += 8) {
+            long long count[257] = {};
+            for (const SortItem &item: items) {
+                count[((item.key >> shift) & 255) + 1]++;
+            }
+            for (int digit = 0; digit < 256; digit++) {
+                count[digit + 1] += count[digit];
+            }
+            for (const SortItem &item: items) {
+                buffer[count[(item.key >> shift) & 255]++] = item;
+            }
+            items.swap(buffer);
+        }
+    }
+
+    // the grid cell of coordinate within [low, low + width]
+    uint32_t cell(double coordinate, double low, double width) {
+        if (width <= 0) {
+            return 0;
+        }
+        return (uint32_t) min((coordinate - low) / width * HILBERT_SIDE, HILBERT_SIDE - 1);
+    }
+
+    // true when the whole box lies strictly on one side of the line through the segment
+    bool besideLine(const Box &box, const Point &begin, const Point &end) {
+        Point lower = box.getLower(), upper = box.getUpper();
+        double side[4] = {
+                orient2d(begin, end, lower),
+                orient2d(begin, end, Point(upper.getX(), lower.getY())),
+                orient2d(begin, end, upper),
+                orient2d(begin, end, Point(lower.getX(), upper.getY()))
+        };
+        bool left = true, right = true;
+        for (double value: side) {
+            left = left && value > 0;
+            right = right && value < 0;
+        }
+        return left || right;
+    }
+}
+
+// constructor
+RTree::RTree(const vector<Box> &boxes, long long node_size) : _node_size_(node_size) {
+    build(boxes);
+}
+
+void RTree::build(const vector<Box> &boxes) {
+    _node_size_ = max(_node_size_, 2LL);
+    _count_ = (long long) boxes.size();
+    _boxes_.clear();
+    _indexes_.clear();
+    _level_ends_.clear();
+    if (_count_ == 0) {
+        return;
+    }
+
+    Box extent;
+    for (const Box &box: boxes) {
+        if (!box.isEmpty()) {
+            extent.expand(box.getLower()).expand(box.getUpper());
+        }
+    }
+    double low_x = extent.getLower().getX(), width = extent.getUpper().getX() - low_x;
+    double low_y = extent.getLower().getY(), height = extent.getUpper().getY() - low_y;
+
+    // empty boxes can not be found by any query, they are kept at the very end
+    vector<SortItem> order;
+    vector<long long> empty;
+    order.reserve(_count_);
+    for (long long i = 0; i < _count_; i++) {
+        const Box &box = boxes[i];
+        if (box.isEmpty()) {
+            empty.push_back(i);
+            continue;
+        }
+        double x = (box.getLower().getX() + box.getUpper().getX()) / 2;
+        double y = (box.getLower().getY() + box.getUpper().getY()) / 2;
+        order.push_back({hilbertIndex(cell(x, low_x, width), cell(y, low_y, height)), i});
+    }
+    radixSort(order);
+    for (long long i: empty) {
+        order.push_back({0, i});
+    }
+
+    long long total = _count_ + _count_ / (_node_size_ - 1) + 64;
+    _boxes_.reserve(4 * total);
+    _indexes_.reserve(total);
+    for (const SortItem &item: order) {
+        const Box &box = boxes[item.idx];
+        _boxes_.insert(_boxes_.end(), {box.getLower().getX(), box.getLower().getY(),
+                                       box.getUpper().getX(), box.getUpper().getY()});
+        _indexes_.push_back(item.idx);
+    }
+    _level_ends_.push_back(_count_);
+
+    // every level is packed from consecutive runs of the one below, up to a single root
+    long long begin = 0, end = _count_;
+    do {
+        for (long long child = begin; child < end; child += _node_size_) {
+            double node[4] = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+            for (long long pos = child; pos < min(child + _node_size_, end); pos++) {
+                node[0] = min(node[0], _boxes_[4 * pos]);
+                node[1] = min(node[1], _boxes_[4 * pos + 1]);
+                node[2] = max(node[2], _boxes_[4 * pos + 2]);
+                node[3] = max(node[3], _boxes_[4 * pos + 3]);
+            }
+            _boxes_.insert(_boxes_.end(), node, node + 4);
+            _indexes_.push_back(child);
+        }
+        begin = end;
+        end = (long long) _indexes_.size();
+        _level_ends_.push_back(end);
+    } while (end - begin > 1);
+}
+
+// ===== FUNCTIONS =====
+
+long long RTree::size() const {
+    return _count_;
+}
+
+long long RTree::nodeSize() const {
+    return _node_size_;
+}
+
+Box RTree::bounds() const {
+    if (_count_ == 0) {
+        return {};
+    }
+    return entry(_level_ends_.back() - 1);
+}
+
+void RTree::search(const Box &window, vector<long long> &items) const {
+    items.clear();
+    visit(window, [&](long long item) {
+        items.push_back(item);
+        return true;
+    });
+}
+
+void RTree::candidates(const DirectSegment &segment, vector<long long> &items) const {
+    items.clear();
+    Box window = segment.boundingBox();
+    Point begin = segment.getBegin(), end = segment.getEnd();
+    traverse([&](const Box &box) {
+        return box.intersects(window) && !besideLine(box, begin, end);
+    }, [&](long long item) {
+        items.push_back(item);
+        return true;
+    });
+}
+
+void RTree::overlaps(const RTree &other, vector<pair<long long, long long>> &pairs) const {
+    pairs.clear();
+    if (_count_ == 0 || other._count_ == 0) {
+        return;
+    }
+    struct Visit {
+        long long pos, level, other_pos, other_level;
+    };
+    long long root = _level_ends_.back() - 1, other_root = other._level_ends_.back() - 1;
+    if (!entry(root).intersects(other.entry(other_root))) {
+        return;
+    }
+    vector<Visit> stack = {{root, (long long) _level_ends_.size() - 1,
+                            other_root, (long long) other._level_ends_.size() - 1}};
+    while (!stack.empty()) {
+        Visit now = stack.back();
+        stack.pop_back();
+        if (now.level == 0 && now.other_level == 0) {
+            pairs.emplace_back(_indexes_[now.pos], other._indexes_[now.other_pos]);
+            continue;
+        }
+        // the side that is higher up the tree is split
+        if (now.level >= now.other_level) {
+            Box box = other.entry(now.other_pos);
+            long long first = _indexes_[now.pos];
+            long long last = min(first + _node_size_, _level_ends_[now.level - 1]);
+            for (long long pos = first; pos < last; pos++) {
+                if (entry(pos).intersects(box)) {
+                    stack.push_back({pos, now.level - 1, now.other_pos, now.other_level});
+                }
+            }
+        } else {
+            Box box = entry(now.pos);
+            long long first = other._indexes_[now.other_pos];
+            long long last = min(first + other._node_size_, other._level_ends_[now.other_level - 1]);
+            for (long long pos = first; pos < last; pos++) {
+                if (other.entry(pos).intersects(box)) {
+                    stack.push_back({now.pos, now.level, pos, now.other_level - 1});
+                }
+            }
+        }
+    }
+    sort(pairs.begin(), pairs.end());
+}
@@ -0,0 +1,121 @@
+#ifndef PROGLAB_2_1_RTREE_H
+#define PROGLAB_2_1_RTREE_H
+
+#include "geometry.h"
+#include <algorithm>
+#include <utility>
+
+// Static R-tree over bounding boxes, bulk loaded in one go. The items are
+// sorted along a Hilbert curve through their box centres and packed node_size
+// to a node, the nodes of every further level are packed the same way. All
+// boxes live in one flat array, level after level (items first, root last),
+// and the children of a node are a contiguous run of the level below, so a
+// query walks plain arrays instead of chasing child pointers.
+//
+// Queries only compare boxes and hand out candidates, the exact test
+// (DirectSegment::intersects and the like) is left to the caller.
+class RTree {
+private:
+    long long _node_size_ = 16;
+    long long _count_ = 0;
+    // min x, min y, max x, max y of every entry
+    vector<double> _boxes_;
+    // for items the index they were given at build time, for nodes the position of the first child
+    vector<long long> _indexes_;
+    // position one past the last entry of every level, from the items up to the root
+    vector<long long> _level_ends_;
+
+    void build(const vector<Box> &boxes);
+
+    Box entry(long long pos) const {
+        const double *box = &_boxes_[4 * pos];
+        return Box(Point(box[0], box[1]), Point(box[2], box[3]));
+    }
+
+    template<class Shape>
+    static auto boundsOf(Shape &shape) -> decltype(shape.boundingBox()) {
+        return shape.boundingBox();
+    }
+
+    static Box boundsOf(const Box &box) {
+        return box;
+    }
+
+public:
+    // constructor
+    RTree() = default;
+
+    // item i is boxes[i]
+    explicit RTree(const vector<Box> &boxes, long long node_size = 16);
+
+    // item i is the i-th shape of the range (Polygon, Polyline, DirectSegment or Box)
+    template<class ShapeIt>
+    RTree(ShapeIt first, ShapeIt last, long long node_size = 16) : _node_size_(node_size) {
+        vector<Box> boxes;
+        for (; first != last; ++first) {
+            boxes.push_back(boundsOf(*first));
+        }
+        build(boxes);
+    }
+
+    // ===== FUNCTIONS =====
+
+    long long size() const;
+
+    long long nodeSize() const;
+
+    // box around all the items, empty for an empty tree
+    Box bounds() const;
+
+    // items whose boxes meet the window, in no particular order
+    void search(const Box &window, vector<long long> &items) const;
+
+    // items that may intersect the segment: their boxes meet the box of the
+    // segment and do not lie strictly on one side of its line
+    void candidates(const DirectSegment &segment, vector<long long> &items) const;
+
+    // every pair (i, j) of an item i of this tree and an item j of other with
+    // overlapping boxes, ordered by i, then j
+    void overlaps(const RTree &other, vector<pair<long long, long long>> &pairs) const;
+
+    // Depth first walk. Subtrees whose box fails accept(box) are skipped and
+    // visitor(item) is called for every item whose own box passes; returning
+    // false from the visitor stops the walk, and then traverse returns false.
+    template<class Accept, class Visitor>
+    bool traverse(Accept &&accept, Visitor &&visitor) const {
+        if (_count_ == 0) {
+            return true;
+        }
+        long long root = _level_ends_.back() - 1;
+        if (!accept(entry(root))) {
+            return true;
+        }
+        // (node position, level of the node)
+        vector<pair<long long, long long>> stack = {{root, (long long) _level_ends_.size() - 1}};
+        while (!stack.empty()) {
+            long long node = stack.back().first, level = stack.back().second;
+            stack.pop_back();
+            long long first = _indexes_[node];
+            long long last = min(first + _node_size_, _level_ends_[level - 1]);
+            for (long long pos = first; pos < last; pos++) {
+                if (!accept(entry(pos))) {
+                    continue;
+                }
+                if (level > 1) {
+                    stack.emplace_back(pos, level - 1);
+                } else if (!visitor(_indexes_[pos])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // traverse over the items whose boxes meet the window
+    template<class Visitor>
+    bool visit(const Box &window, Visitor &&visitor) const {
+        return traverse([&](const Box &box) { return box.intersects(window); }, visitor);
+    }
+};
+
+#endif //PROGLAB_2_1_RTREE_H
@@ -0,0 +1,387 @@
+#include "simplify.h"
+#include "predicates.h"
+#include "rtree.h"
+#include "sweep.h"
+#include <algorithm>
+#include <queue>
+
+namespace {
+    int orient(const Point &A, const Point &B, const Point &C) {
+        double det = orient2d(A, B, C);
+        return (det > 0) - (det < 0);
+    }
+
+    bool lexLess(const Point &A, const Point &B) {
+        return A.getX() < B.getX() || (A.getX() == B.getX() && A.getY() < B.getY());
+    }
+
+    // squared distance from P to the segment AB
+    double segmentDistance2(const Point &P, const Point &A, const Point &B) {
+        double dx = B.getX() - A.getX(), dy = B.getY() - A.getY();
+        double px = P.getX() - A.getX(), py = P.getY() - A.getY();
+        double length2 = dx * dx + dy * dy;
+        double t = length2 > 0 ? (px * dx + py * dy) / length2 : 0;
+        t = min(max(t, 0.0), 1.0);
+        double ex = px - t * dx, ey = py - t * dy;
+        return ex * ex + ey * ey;
+    }
+
+    // vertex of the run strictly between first and last (last may be n, meaning vertex 0 of a ring)
+    // farthest from the segment joining them, -1 unless it lies farther than sqrt(distance2)
+    long long farthestInRun(const Point *points, long long n, long long first, long long last, double distance2) {
+        const Point &A = points[first];
+        const Point &B = points[last == n ? 0 : last];
+        long long farthest = -1;
+        for (long long i = first + 1; i < last; i++) {
+            double distance = segmentDistance2(points[i], A, B);
+            if (distance > distance2) {
+                farthest = i;
+                distance2 = distance;
+            }
+        }
+        return farthest;
+    }
+
+    // marks the vertexes of the run first..last that Douglas-Peucker keeps, the ends are left as they are
+    void markRun(const Point *points, long long n, long long first, long long last, double tolerance2,
+                 vector<char> &keep) {
+        vector<pair<long long, long long>> runs = {{first, last}};
+        while (!runs.empty()) {
+            long long a = runs.back().first, b = runs.back().second;
+            runs.pop_back();
+            if (b - a < 2) {
+                continue;
+            }
+            long long split = farthestInRun(points, n, a, b, tolerance2);
+            if (split < 0) {
+                continue;
+            }
+            keep[split] = 1;
+            runs.emplace_back(split, b);
+            runs.emplace_back(a, split);
+        }
+    }
+
+    // a ring is cut at vertex 0 and the vertex farthest from it, and at least three vertexes stay
+    void markRing(const Point *points, long long n, double tolerance2, vector<char> &keep) {
+        keep.assign(n, 0);
+        if (n <= 3) {
+            keep.assign(n, 1);
+            return;
+        }
+        keep[0] = 1;
+        long long opposite = 0;
+        double opposite_distance = -1;
+        for (long long i = 1; i < n; i++) {
+            double dx = points[i].getX() - points[0].getX(), dy = points[i].getY() - points[0].getY();
+            if (dx * dx + dy * dy > opposite_distance) {
+                opposite = i;
+                opposite_distance = dx * dx + dy * dy;
+            }
+        }
+        keep[opposite] = 1;
+        markRun(points, n, 0, opposite, tolerance2, keep);
+        markRun(points, n, opposite, n, tolerance2, keep);
+
+        if (count(keep.begin(), keep.end(), 1) == 2) {
+            long long first = farthestInRun(points, n, 0, opposite, -1);
+            long long second = farthestInRun(points, n, opposite, n, -1);
+            if (first < 0 || (second >= 0 && segmentDistance2(points[second], points[0], points[opposite]) >
+                                             segmentDistance2(points[first], points[0], points[opposite]))) {
+                first = second;
+            }
+            keep[first] = 1;
+            long long from = first < opposite ? 0 : opposite, to = first < opposite ? opposite : n;
+            markRun(points, n, from, first, tolerance2, keep);
+            markRun(points, n, first, to, tolerance2, keep);
+        }
+    }
+
+    struct HeapEntry {
+        // twice the area of the triangle of the vertex and its neighbours, the
+        // entry is stale once the vertex has another area
+        double area;
+        long long vertex;
+
+        bool operator>(const HeapEntry &other) const {
+            return area > other.area || (area == other.area && vertex > other.vertex);
+        }
+    };
+
+    // Visvalingam-Whyatt over a line (a ring when closed). keep comes out with
+    // the vertexes that stay; allowed(previous, vertex, next) may refuse to drop
+    // a vertex, it is asked again once one of the neighbours changes.
+    template<class Allowed>
+    void markVisvalingam(const Point *points, long long n, bool closed, double area, vector<char> &keep,
+                         Allowed &&allowed) {
+        keep.assign(n, 1);
+        long long least = closed ? 3 : 2;
+        if (n <= least) {
+            return;
+        }
+
+        vector<long long> previous(n), next(n);
+        vector<double> areas(n);
+        for (long long i = 0; i < n; i++) {
+            previous[i] = i == 0 ? n - 1 : i - 1;
+            next[i] = i == n - 1 ? 0 : i + 1;
+        }
+        auto removable = [&](long long vertex) {
+            return closed || (vertex != 0 && vertex != n - 1);
+        };
+        auto areaOf = [&](long long vertex) {
+            const Point &A = points[previous[vertex]], &B = points[vertex], &C = points[next[vertex]];
+            double bx = B.getX() - A.getX(), by = B.getY() - A.getY();
+            double cx = C.getX() - A.getX(), cy = C.getY() - A.getY();
+            return abs(bx * cy - by * cx);
+        };
+
+        double limit = 2 * area;
+        vector<HeapEntry> entries;
+        entries.reserve(n);
+        for (long long i = 0; i < n; i++) {
+            if (removable(i)) {
+                areas[i] = areaOf(i);
+                entries.push_back({areas[i], i});
+            }
+        }
+        priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry>> heap(greater<HeapEntry>(), move(entries));
+
+        long long remaining = n;
+        while (!heap.empty() && remaining > least) {
+            HeapEntry entry = heap.top();
+            heap.pop();
+            if (!keep[entry.vertex] || entry.area != areas[entry.vertex]) {
+                continue;
+            }
+            if (entry.area >= limit) {
+                break;
+            }
+            long long vertex = entry.vertex, before = previous[vertex], after = next[vertex];
+            if (!allowed(before, vertex, after)) {
+                continue;
+            }
+            keep[vertex] = 0;
+            remaining--;
+            next[before] = after;
+            previous[after] = before;
+            for (long long neighbour: {before, after}) {
+                if (removable(neighbour)) {
+                    areas[neighbour] = areaOf(neighbour);
+                    heap.push({areas[neighbour], neighbour});
+                }
+            }
+        }
+    }
+
+    pmr::vector<Point> gather(const Point *points, long long n, const vector<char> &keep) {
+        pmr::vector<Point> kept;
+        for (long long i = 0; i < n; i++) {
+            if (keep[i]) {
+                kept.push_back(points[i]);
+            }
+        }
+        return kept;
+    }
+
+    // Splits the edges of the kept ring that meet another edge other than at
+    // a shared end, at their farthest dropped vertex, until the ring is simple.
+    // Both halves of a split edge go through Douglas-Peucker again, so the
+    // tolerance still holds. Two edges of the original polygon never meet, so
+    // every round splits at least one edge and the loop ends at the latest with
+    // the whole polygon.
+    void untangle(const Point *points, long long n, double tolerance2, vector<char> &keep) {
+        vector<long long> ring;
+        vector<DirectSegment> edges;
+        vector<SegmentIntersection> meetings;
+        while (true) {
+            ring.clear();
+            for (long long i = 0; i < n; i++) {
+                if (keep[i]) {
+                    ring.push_back(i);
+                }
+            }
+            long long m = (long long) ring.size();
+            edges.clear();
+            for (long long i = 0; i < m; i++) {
+                edges.emplace_back(points[ring[i]], points[ring[(i + 1) % m]]);
+            }
+            allIntersections(edges, meetings);
+
+            vector<long long> split;
+            for (const SegmentIntersection &meeting: meetings) {
+                long long a = meeting.first, b = meeting.second;
+                bool adjacent = b == a + 1 || (a == 0 && b == m - 1);
+                if (adjacent) {
+                    // edges around a shared vertex only conflict when they fold back onto each other
+                    long long shared = b == a + 1 ? b : 0;
+                    const Point &S = points[ring[shared]];
+                    const Point &P = points[ring[(shared + m - 1) % m]];
+                    const Point &Q = points[ring[(shared + 1) % m]];
+                    if (orient(P, S, Q) != 0 || lexLess(P, S) != lexLess(Q, S)) {
+                        continue;
+                    }
+                }
+                split.push_back(a);
+                split.push_back(b);
+            }
+            if (split.empty()) {
+                return;
+            }
+            for (long long edge: split) {
+                long long first = ring[edge];
+                long long last = edge + 1 == m ? n : ring[edge + 1];
+                long long vertex = farthestInRun(points, n, first, last, -1);
+                if (vertex >= 0) {
+                    keep[vertex] = 1;
+                    markRun(points, n, first, vertex, tolerance2, keep);
+                    markRun(points, n, vertex, last, tolerance2, keep);
+                }
+            }
+        }
+    }
+}
+
+Polyline douglasPeucker(Polyline &line, double tolerance) {
+    long long n = line.size();
+    if (n <= 2) {
+        return line;
+    }
+    const Point *points = &line[0];
+    vector<char> keep(n, 0);
+    keep[0] = keep[n - 1] = 1;
+    markRun(points, n, 0, n - 1, tolerance * tolerance, keep);
+    return Polyline(gather(points, n, keep));
+}
+
+ClosedPolyline douglasPeucker(ClosedPolyline &closed_line, double tolerance) {
+    long long n = closed_line.size();
+    if (n <= 3) {
+        return closed_line;
+    }
+    const Point *points = &closed_line[0];
+    vector<char> keep;
+    markRing(points, n, tolerance * tolerance, keep);
+    return ClosedPolyline(gather(points, n, keep));
+}
+
+Polygon douglasPeucker(Polygon &polygon, double tolerance) {
+    long long n = polygon.degree();
+    if (n <= 3) {
+        return polygon;
+    }
+    const Point *points = polygon.data();
+    vector<char> keep;
+    markRing(points, n, tolerance * tolerance, keep);
+    untangle(points, n, tolerance * tolerance, keep);
+    return Polygon(gather(points, n, keep), Polygon::Trusted());
+}
+
+Polyline visvalingam(Polyline &line, double area) {
+    long long n = line.size();
+    if (n <= 2) {
+        return line;
+    }
+    const Point *points = &line[0];
+    vector<char> keep;
+    markVisvalingam(points, n, false, area, keep, [](long long, long long, long long) { return true; });
+    return Polyline(gather(points, n, keep));
+}
+
+ClosedPolyline visvalingam(ClosedPolyline &closed_line, double area) {
+    long long n = closed_line.size();
+    if (n <= 3) {
+        return closed_line;
+    }
+    const Point *points = &closed_line[0];
+    vector<char> keep;
+    markVisvalingam(points, n, true, area, keep, [](long long, long long, long long) { return true; });
+    return ClosedPolyline(gather(points, n, keep));
+}
+
+Polygon visvalingam(Polygon &polygon, double area) {
+    long long n = polygon.degree();
+    if (n <= 3) {
+        return polygon;
+    }
+    const Point *points = polygon.data();
+
+    vector<Box> boxes;
+    boxes.reserve(n);
+    for (long long i = 0; i < n; i++) {
+        boxes.emplace_back(points[i], points[i]);
+    }
+    RTree tree(boxes);
+
+    vector<char> keep;
+    // a vertex may go when its closed triangle holds no other vertex still on the boundary
+    auto empty = [&](long long before, long long vertex, long long after) {
+        const Point &A = points[before], &B = points[vertex], &C = points[after];
+        Box window;
+        window.expand(A).expand(B).expand(C);
+        return tree.visit(window, [&](long long other) {
+            if (!keep[other] || other == before || other == vertex || other == after) {
+                return true;
+            }
+            int a = orient(A, B, points[other]), b = orient(B, C, points[other]), c = orient(C, A, points[other]);
+            return !((a >= 0 && b >= 0 && c >= 0) || (a <= 0 && b <= 0 && c <= 0));
+        });
+    };
+    markVisvalingam(points, n, true, area, keep, empty);
+    return Polygon(gather(points, n, keep), Polygon::Trusted());
+}
+
+
+// constructor
+StreamingSimplifier::StreamingSimplifier(double tolerance, function<void(const Point &)> emit, long long window)
+        : _tolerance_(tolerance), _window_(max(window, 3LL)), _emit_(move(emit)) {
+    _buffer_.reserve(_window_);
+}
+
+StreamingSimplifier::StreamingSimplifier(double tolerance, Polyline &output, long long window)
+        : StreamingSimplifier(tolerance, [&output](const Point &vertex) { output.elongate(vertex); }, window) {}
+
+// ===== FUNCTIONS =====
+
+void StreamingSimplifier::flush(bool finishing) {
+    long long n = (long long) _buffer_.size();
+    _keep_.assign(n, 0);
+    _keep_[0] = _keep_[n - 1] = 1;
+    markRun(_buffer_.data(), n, 0, n - 1, _tolerance_ * _tolerance_, _keep_);
+
+    // the last vertex of a full window is only a cut: the vertexes kept before it are settled
+    long long settled = n - 1;
+    if (!finishing) {
+        settled = n - 2;
+        while (settled > 0 && !_keep_[settled]) {
+            settled--;
+        }
+        // nothing kept inside the window, its end has to be settled to free the memory
+        if (settled == 0) {
+            settled = n - 1;
+        }
+    }
+    for (long long i = 1; i <= settled; i++) {
+        if (_keep_[i]) {
+            _emit_(_buffer_[i]);
+        }
+    }
+    _buffer_.erase(_buffer_.begin(), _buffer_.begin() + settled);
+}
+
+void StreamingSimplifier::elongate(const Point &vertex) {
+    if (_buffer_.empty()) {
+        _emit_(vertex);
+    }
+    _buffer_.push_back(vertex);
+    if ((long long) _buffer_.size() == _window_) {
+        flush(false);
+    }
+}
+
+void StreamingSimplifier::finish() {
+    if (_buffer_.size() > 1) {
+        flush(true);
+    }
+    _buffer_.clear();
+}
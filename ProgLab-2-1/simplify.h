@@ -0,0 +1,70 @@
+#ifndef PROGLAB_2_1_SIMPLIFY_H
+#define PROGLAB_2_1_SIMPLIFY_H
+
+#include "geometry.h"
+#include <functional>
+
+// Line simplification, keeping a subset of the vertexes in their order.
+//
+// Douglas-Peucker keeps the vertex farthest from the segment joining the ends
+// of a run while it lies more than tolerance away, and splits the run there;
+// the runs wait on an explicit stack, so long lines cannot overflow the call
+// stack. Every dropped vertex ends up within tolerance of the simplified line.
+// O(n log n) on typical lines, O(n^2) at worst.
+//
+// Visvalingam-Whyatt drops the vertex spanning the smallest triangle with its
+// two neighbours, over and over, while that area is below the given one. The
+// areas wait in a binary heap, the neighbours of a dropped vertex go back in
+// with their new areas, O(n log n).
+//
+// Open lines keep both ends, closed lines and polygons keep at least three
+// vertexes. A simplified Polygon stays simple: Visvalingam-Whyatt only drops a
+// vertex when no other vertex lies in its (closed) triangle, so the new edge
+// can not touch the rest of the boundary, and Douglas-Peucker splits the edges
+// that meet some other edge until none do.
+
+Polyline douglasPeucker(Polyline &line, double tolerance);
+
+ClosedPolyline douglasPeucker(ClosedPolyline &closed_line, double tolerance);
+
+Polygon douglasPeucker(Polygon &polygon, double tolerance);
+
+Polyline visvalingam(Polyline &line, double area);
+
+ClosedPolyline visvalingam(ClosedPolyline &closed_line, double area);
+
+Polygon visvalingam(Polygon &polygon, double area);
+
+// Douglas-Peucker over a line that arrives one vertex at a time. At most
+// window vertexes are held: once the window fills up it is simplified, the
+// vertexes settled by then are emitted and the window restarts from the last
+// of them. The guarantee is the one of douglasPeucker, the result may keep a
+// few more vertexes near the window borders.
+class StreamingSimplifier {
+private:
+    double _tolerance_;
+    long long _window_;
+    function<void(const Point &)> _emit_;
+    // the vertexes not settled yet, the first one has been emitted already
+    vector<Point> _buffer_;
+    vector<char> _keep_;
+
+    // simplifies the buffer and emits what it keeps after its first vertex, up to the last one when finishing
+    void flush(bool finishing);
+
+public:
+    // constructor
+    StreamingSimplifier(double tolerance, function<void(const Point &)> emit, long long window = 4096);
+
+    // the simplified vertexes are added to output with Polyline::elongate
+    StreamingSimplifier(double tolerance, Polyline &output, long long window = 4096);
+
+    // ===== FUNCTIONS =====
+
+    void elongate(const Point &vertex);
+
+    // emits the rest of the line, then the simplifier is ready for a new one
+    void finish();
+};
+
+#endif //PROGLAB_2_1_SIMPLIFY_H
@@ -0,0 +1,87 @@
+#include "stats.h"
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+
+namespace {
+    // the counters of the running threads; a thread leaves it at its exit, under the same lock
+    // the readers hold, so a snapshot never reads the counters of a finished thread
+    struct StatsRegistry {
+        mutex lock;
+        vector<pair<thread::id, const GeometryStats *>> threads;
+    };
+
+    // never destroyed, threads may exit after the static objects are gone
+    StatsRegistry &registry() {
+        static StatsRegistry *_registry_ = new StatsRegistry();
+        return *_registry_;
+    }
+
+    void writeOperation(ostringstream &out, const char *name, const OperationStats &operation) {
+        out << ", \"" << name << "\": {\"calls\": " << operation.calls << ", \"cycles\": " << operation.cycles << "}";
+    }
+}
+
+// constructor
+StatsRegistration::StatsRegistration() {
+    StatsRegistry &all = registry();
+    lock_guard<mutex> guard(all.lock);
+    all.threads.emplace_back(this_thread::get_id(), &stats);
+}
+
+// destructor
+StatsRegistration::~StatsRegistration() {
+    StatsRegistry &all = registry();
+    lock_guard<mutex> guard(all.lock);
+    all.threads.erase(find_if(all.threads.begin(), all.threads.end(),
+                              [this](const pair<thread::id, const GeometryStats *> &thread) {
+                                  return thread.second == &stats;
+                              }));
+}
+
+// ===== FUNCTIONS =====
+
+GeometryStats statsSnapshot() {
+    return threadStats();
+}
+
+void statsReset() {
+    threadStats() = GeometryStats();
+}
+
+vector<ThreadStats> statsSnapshotAll() {
+    StatsRegistry &all = registry();
+    lock_guard<mutex> guard(all.lock);
+    vector<ThreadStats> snapshot;
+    snapshot.reserve(all.threads.size());
+    for (const pair<thread::id, const GeometryStats *> &thread: all.threads) {
+        snapshot.push_back({thread.first, *thread.second});
+    }
+    return snapshot;
+}
+
+string statsJson(const GeometryStats &stats) {
+    ostringstream out;
+    out << "{\"enabled\": " << (statsEnabled() ? "true" : "false")
+        << ", \"intersects_calls\": " << stats.intersects_calls
+        << ", \"validations\": " << stats.validations
+        << ", \"validation_checks\": " << stats.validation_checks
+        << ", \"buffer_allocations\": " << stats.buffer_allocations
+        << ", \"buffer_bytes\": " << stats.buffer_bytes;
+    writeOperation(out, "area", stats.area);
+    writeOperation(out, "perimeter", stats.perimeter);
+    writeOperation(out, "length", stats.length);
+    out << "}";
+    return out.str();
+}
+
+string statsJson(const vector<ThreadStats> &threads) {
+    ostringstream out;
+    out << "[";
+    for (size_t i = 0; i < threads.size(); i++) {
+        out << (i == 0 ? "" : ", ") << "{\"thread\": \"" << threads[i].id << "\", \"stats\": "
+            << statsJson(threads[i].stats) << "}";
+    }
+    out << "]";
+    return out.str();
+}
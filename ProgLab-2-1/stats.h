@@ -0,0 +1,170 @@
+#ifndef PROGLAB_2_1_STATS_H
+#define PROGLAB_2_1_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+using namespace std;
+
+// Counters of the hot paths, built in with -DGEOMETRY_STATS=1 (the CMake
+// option of the same name). Every thread counts into its own GeometryStats,
+// so a worker reads and resets its counters without touching anyone else's.
+// The blocks of all threads are listed in a registry when they are first
+// used, so a monitoring thread can scrape them per worker; the worker is the
+// only writer of its counters and never waits for the reader. Without the
+// option the hooks below compile to nothing and every snapshot is zero.
+
+#ifndef GEOMETRY_STATS
+#define GEOMETRY_STATS 0
+#endif
+
+// A counter written by one thread and read by any: relaxed atomic loads and
+// stores, plain moves on x86, without the locked read-modify-write of fetch_add.
+class StatsCounter {
+private:
+    atomic<uint64_t> _value_{0};
+public:
+    // constructor
+    StatsCounter() = default;
+
+    StatsCounter(uint64_t value) : _value_(value) {}
+
+    // copy constructor
+    StatsCounter(const StatsCounter &counter) : _value_(counter) {}
+
+    // assignment operator
+    StatsCounter &operator=(const StatsCounter &counter) {
+        _value_.store(counter, memory_order_relaxed);
+        return *this;
+    }
+
+    // only the thread owning the counter adds to it
+    StatsCounter &operator+=(uint64_t amount) {
+        _value_.store(_value_.load(memory_order_relaxed) + amount, memory_order_relaxed);
+        return *this;
+    }
+
+    operator uint64_t() const {
+        return _value_.load(memory_order_relaxed);
+    }
+};
+
+// calls of an operation and the cycles spent in them (TSC ticks on x86, nanoseconds elsewhere)
+struct OperationStats {
+    StatsCounter calls;
+    StatsCounter cycles;
+};
+
+struct GeometryStats {
+    // DirectSegment::intersects, also when the batch kernels fall back to it
+    StatsCounter intersects_calls;
+    // Polygon validations and the pairs of edges they compared
+    StatsCounter validations;
+    StatsCounter validation_checks;
+    // vertex buffers moved to or grown on their memory resource, and the bytes they asked for
+    StatsCounter buffer_allocations;
+    StatsCounter buffer_bytes;
+    // the computations behind Polygon::area, perimeter and Polyline::length (cache hits are not counted)
+    OperationStats area;
+    OperationStats perimeter;
+    OperationStats length;
+};
+
+// the counters of one thread, listed in the registry while the thread runs
+class StatsRegistration {
+public:
+    GeometryStats stats;
+
+    // constructor
+    StatsRegistration();
+
+    StatsRegistration(const StatsRegistration &registration) = delete;
+
+    StatsRegistration &operator=(const StatsRegistration &registration) = delete;
+
+    // destructor
+    ~StatsRegistration();
+};
+
+// the counters of the calling thread
+inline GeometryStats &threadStats() {
+    static thread_local StatsRegistration _registration_;
+    return _registration_.stats;
+}
+
+inline uint64_t readCycles() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __rdtsc();
+#else
+    return (uint64_t) chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// adds the cycles of its lifetime to an operation
+class OperationTimer {
+private:
+    OperationStats &_operation_;
+    uint64_t _start_;
+public:
+    // constructor
+    explicit OperationTimer(OperationStats &operation) : _operation_(operation), _start_(readCycles()) {}
+
+    OperationTimer(const OperationTimer &timer) = delete;
+
+    OperationTimer &operator=(const OperationTimer &timer) = delete;
+
+    // destructor
+    ~OperationTimer() {
+        _operation_.calls += 1;
+        _operation_.cycles += readCycles() - _start_;
+    }
+};
+
+#if GEOMETRY_STATS
+#define GEOMETRY_COUNT(counter, amount) (threadStats().counter += (amount))
+#define GEOMETRY_TIME(operation) OperationTimer _operation_timer_(threadStats().operation)
+#else
+#define GEOMETRY_COUNT(counter, amount) ((void) 0)
+#define GEOMETRY_TIME(operation) ((void) 0)
+#endif
+
+// ===== FUNCTIONS =====
+
+// true when the library was built with the counters
+constexpr bool statsEnabled() {
+    return GEOMETRY_STATS != 0;
+}
+
+// a copy of the counters of the calling thread
+GeometryStats statsSnapshot();
+
+// zeroes the counters of the calling thread
+void statsReset();
+
+// the counters of one worker, as the registry saw them
+struct ThreadStats {
+    thread::id id;
+    GeometryStats stats;
+};
+
+// a copy of the counters of every thread that has counted and still runs, in
+// the order they registered; safe to call from any thread at any time
+vector<ThreadStats> statsSnapshotAll();
+
+// the counters as one JSON object
+string statsJson(const GeometryStats &stats);
+
+// the counters of every thread as a JSON array of {"thread": id, "stats": {...}}
+string statsJson(const vector<ThreadStats> &threads);
+
+#endif //PROGLAB_2_1_STATS_H
@@ -0,0 +1,363 @@
+#include "sweep.h"
+#include "predicates.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <set>
+
+namespace {
+    // a closed range surely holding a value that was computed with rounding
+    struct Interval {
+        double lo;
+        double hi;
+    };
+
+    // at least one ulp away from value on either side, a lot cheaper than nextafter
+    double down(double value) {
+        return value - (abs(value) * DBL_EPSILON + DBL_TRUE_MIN);
+    }
+
+    double up(double value) {
+        return value + (abs(value) * DBL_EPSILON + DBL_TRUE_MIN);
+    }
+
+    Interval exactly(double value) {
+        return {value, value};
+    }
+
+    Interval operator+(const Interval &A, const Interval &B) {
+        return {down(A.lo + B.lo), up(A.hi + B.hi)};
+    }
+
+    Interval operator-(const Interval &A, const Interval &B) {
+        return {down(A.lo - B.hi), up(A.hi - B.lo)};
+    }
+
+    Interval operator*(const Interval &A, const Interval &B) {
+        double products[4] = {A.lo * B.lo, A.lo * B.hi, A.hi * B.lo, A.hi * B.hi};
+        return {down(*min_element(products, products + 4)), up(*max_element(products, products + 4))};
+    }
+
+    // only called for divisors away from 0
+    Interval operator/(const Interval &A, const Interval &B) {
+        double quotients[4] = {A.lo / B.lo, A.lo / B.hi, A.hi / B.lo, A.hi / B.hi};
+        return {down(*min_element(quotients, quotients + 4)), up(*max_element(quotients, quotients + 4))};
+    }
+
+    // 1 when the whole interval is above 0, -1 when below, 0 when unsure
+    int signOf(const Interval &value) {
+        return (value.lo > 0) - (value.hi < 0);
+    }
+
+    // a segment with its ends in sweep order, left is lexicographically smaller
+    struct Segment {
+        Point left;
+        Point right;
+    };
+
+    // A point the sweep stops at: a segment end, exact, or the crossing of two
+    // segments, known exactly only through the segments themselves.
+    struct EventPoint {
+        Interval x;
+        Interval y;
+        long long first = -1;
+        long long second = -1;
+
+        bool isExact() const {
+            return first < 0;
+        }
+    };
+
+    EventPoint endpoint(const Point &point) {
+        return {exactly(point.getX()), exactly(point.getY())};
+    }
+
+    class Sweep {
+    private:
+        const vector<Segment> &_segments_;
+
+        // exact homogeneous coordinates (X / W, Y / W) with W > 0
+        void homogeneous(const EventPoint &P, Expansion &X, Expansion &Y, Expansion &W) const {
+            if (P.isExact()) {
+                X = P.x.lo, Y = P.y.lo, W = 1;
+                return;
+            }
+            const Segment &S = _segments_[P.first], &T = _segments_[P.second];
+            Expansion ex = Expansion::difference(S.right.getX(), S.left.getX());
+            Expansion ey = Expansion::difference(S.right.getY(), S.left.getY());
+            Expansion fx = Expansion::difference(T.right.getX(), T.left.getX());
+            Expansion fy = Expansion::difference(T.right.getY(), T.left.getY());
+            Expansion gx = Expansion::difference(T.left.getX(), S.left.getX());
+            Expansion gy = Expansion::difference(T.left.getY(), S.left.getY());
+            // S.left + (N / W) (S.right - S.left)
+            W = ex * fy - ey * fx;
+            Expansion N = gx * fy - gy * fx;
+            X = Expansion(S.left.getX()) * W + N * ex;
+            Y = Expansion(S.left.getY()) * W + N * ey;
+            if (W.sign() < 0) {
+                X = -X, Y = -Y, W = -W;
+            }
+        }
+
+        int compareCoordinate(const EventPoint &A, const EventPoint &B, bool is_y) const {
+            const Interval &a = is_y ? A.y : A.x;
+            const Interval &b = is_y ? B.y : B.x;
+            if (a.hi < b.lo) {
+                return -1;
+            }
+            if (b.hi < a.lo) {
+                return 1;
+            }
+            if (A.isExact() && B.isExact()) {
+                return (a.lo > b.lo) - (a.lo < b.lo);
+            }
+            if (A.first == B.first && A.second == B.second) {
+                return 0;
+            }
+            Expansion AX, AY, AW, BX, BY, BW;
+            homogeneous(A, AX, AY, AW);
+            homogeneous(B, BX, BY, BW);
+            return is_y ? (AY * BW - BY * AW).sign() : (AX * BW - BX * AW).sign();
+        }
+
+    public:
+        // the point the sweep is at, the order of the status is the one just after it
+        EventPoint now;
+
+        explicit Sweep(const vector<Segment> &segments) : _segments_(segments) {}
+
+        const Segment &segment(long long idx) const {
+            return _segments_[idx];
+        }
+
+        bool pointLess(const EventPoint &A, const EventPoint &B) const {
+            int x = compareCoordinate(A, B, false);
+            if (x != 0) {
+                return x < 0;
+            }
+            return compareCoordinate(A, B, true) < 0;
+        }
+
+        // sign of orient2d(left, right, P): 1 when P is above the segment, -1 below, 0 on it
+        int side(long long idx, const EventPoint &P) const {
+            const Segment &S = _segments_[idx];
+            if (P.isExact()) {
+                double det = orient2d(S.left, S.right, Point(P.x.lo, P.y.lo));
+                return (det > 0) - (det < 0);
+            }
+            if (P.first == idx || P.second == idx) {
+                return 0;
+            }
+            Interval ex = exactly(S.right.getX()) - exactly(S.left.getX());
+            Interval ey = exactly(S.right.getY()) - exactly(S.left.getY());
+            int sign = signOf(ex * (P.y - exactly(S.left.getY())) - ey * (P.x - exactly(S.left.getX())));
+            if (sign != 0) {
+                return sign;
+            }
+            Expansion X, Y, W;
+            homogeneous(P, X, Y, W);
+            Expansion dx = Expansion::difference(S.right.getX(), S.left.getX());
+            Expansion dy = Expansion::difference(S.right.getY(), S.left.getY());
+            return (dx * (Y - Expansion(S.left.getY()) * W) - dy * (X - Expansion(S.left.getX()) * W)).sign();
+        }
+
+        // Order of two active segments just after the current point, defined when
+        // at least one of them passes through it (the only comparisons the status
+        // set makes, as segments are only ever inserted at the current point).
+        bool segmentLess(long long a, long long b) const {
+            // -1 below the point, 0 through it, 1 above it
+            int place_a = -side(a, now), place_b = -side(b, now);
+            if (place_a != place_b) {
+                return place_a < place_b;
+            }
+            if (place_a == 0) {
+                const Segment &A = _segments_[a], &B = _segments_[b];
+                int turn = crossSign(A.left, A.right, B.left, B.right);
+                if (turn != 0) {
+                    return turn > 0;
+                }
+            }
+            return a < b;
+        }
+
+        // the crossing of two segments that are not parallel
+        EventPoint crossing(long long first, long long second) const {
+            const Segment &S = _segments_[first], &T = _segments_[second];
+            EventPoint P;
+            P.first = first;
+            P.second = second;
+
+            // the crossing lies in the boxes of both segments
+            P.x = {max(S.left.getX(), T.left.getX()), min(S.right.getX(), T.right.getX())};
+            P.y = {max(min(S.left.getY(), S.right.getY()), min(T.left.getY(), T.right.getY())),
+                   min(max(S.left.getY(), S.right.getY()), max(T.left.getY(), T.right.getY()))};
+
+            Interval ex = exactly(S.right.getX()) - exactly(S.left.getX());
+            Interval ey = exactly(S.right.getY()) - exactly(S.left.getY());
+            Interval fx = exactly(T.right.getX()) - exactly(T.left.getX());
+            Interval fy = exactly(T.right.getY()) - exactly(T.left.getY());
+            Interval gx = exactly(T.left.getX()) - exactly(S.left.getX());
+            Interval gy = exactly(T.left.getY()) - exactly(S.left.getY());
+            Interval W = ex * fy - ey * fx;
+            if (signOf(W) != 0) {
+                Interval t = (gx * fy - gy * fx) / W;
+                Interval x = exactly(S.left.getX()) + t * ex;
+                Interval y = exactly(S.left.getY()) + t * ey;
+                P.x = {max(P.x.lo, x.lo), min(P.x.hi, x.hi)};
+                P.y = {max(P.y.lo, y.lo), min(P.y.hi, y.hi)};
+            }
+            return P;
+        }
+
+        Point location(const EventPoint &P) const {
+            if (P.isExact()) {
+                return Point(P.x.lo, P.y.lo);
+            }
+            // a few ulps wide after the interval arithmetic, otherwise worked out exactly
+            if (P.x.hi - P.x.lo <= 64 * DBL_EPSILON * abs(P.x.lo) &&
+                P.y.hi - P.y.lo <= 64 * DBL_EPSILON * abs(P.y.lo)) {
+                return Point(P.x.lo + (P.x.hi - P.x.lo) / 2, P.y.lo + (P.y.hi - P.y.lo) / 2);
+            }
+            Expansion X, Y, W;
+            homogeneous(P, X, Y, W);
+            double w = W.estimate();
+            return Point(X.estimate() / w, Y.estimate() / w);
+        }
+    };
+
+    struct EventOrder {
+        const Sweep *sweep;
+
+        bool operator()(const EventPoint &A, const EventPoint &B) const {
+            return sweep->pointLess(A, B);
+        }
+    };
+
+    // segments ordered from the bottom up; searching with an EventPoint finds
+    // the segments passing through it
+    struct StatusOrder {
+        using is_transparent = void;
+
+        const Sweep *sweep;
+
+        bool operator()(long long a, long long b) const {
+            return sweep->segmentLess(a, b);
+        }
+
+        bool operator()(long long a, const EventPoint &P) const {
+            return sweep->side(a, P) > 0;
+        }
+
+        bool operator()(const EventPoint &P, long long a) const {
+            return sweep->side(a, P) < 0;
+        }
+    };
+}
+
+void allIntersections(const vector<DirectSegment> &segments, vector<SegmentIntersection> &intersections) {
+    intersections.clear();
+    long long n = (long long) segments.size();
+    vector<Segment> normalized(n);
+    for (long long i = 0; i < n; i++) {
+        Point begin = segments[i].getBegin(), end = segments[i].getEnd();
+        bool forward = begin.getX() < end.getX() || (begin.getX() == end.getX() && begin.getY() <= end.getY());
+        normalized[i] = forward ? Segment{begin, end} : Segment{end, begin};
+    }
+
+    Sweep sweep(normalized);
+    // event point -> segments starting there
+    map<EventPoint, vector<long long>, EventOrder> events(EventOrder{&sweep});
+    for (long long i = 0; i < n; i++) {
+        events[endpoint(normalized[i].left)].push_back(i);
+        events[endpoint(normalized[i].right)];
+    }
+    set<long long, StatusOrder> status(StatusOrder{&sweep});
+
+    auto isPoint = [&](long long idx) {
+        return normalized[idx].left == normalized[idx].right;
+    };
+    // Queues the crossing of two neighbours when it lies ahead of the sweep. Only
+    // proper crossings need an event of their own: where an end of one segment
+    // lies on the other, the event of that end already finds both.
+    auto checkPair = [&](long long a, long long b) {
+        const Segment &A = normalized[a], &B = normalized[b];
+        auto turn = [](const Point &P, const Point &Q, const Point &R) {
+            double det = orient2d(P, Q, R);
+            return (det > 0) - (det < 0);
+        };
+        if (turn(A.left, A.right, B.left) * turn(A.left, A.right, B.right) >= 0 ||
+            turn(B.left, B.right, A.left) * turn(B.left, B.right, A.right) >= 0) {
+            return;
+        }
+        EventPoint crossing = sweep.crossing(a, b);
+        if (sweep.pointLess(sweep.now, crossing)) {
+            events.emplace(crossing, vector<long long>());
+        }
+    };
+
+    vector<long long> meeting, reinserted;
+    while (!events.empty()) {
+        auto next = events.begin();
+        sweep.now = next->first;
+        vector<long long> starting = move(next->second);
+        events.erase(next);
+
+        // segments passing through or ending at the point leave the status ...
+        auto passing = status.equal_range(sweep.now);
+        meeting.assign(passing.first, passing.second);
+        status.erase(passing.first, passing.second);
+
+        // ... and the ones going on to the right come back in their order after it
+        reinserted.clear();
+        for (long long idx: meeting) {
+            if (sweep.pointLess(sweep.now, endpoint(normalized[idx].right))) {
+                reinserted.push_back(idx);
+            }
+        }
+        for (long long idx: starting) {
+            if (!isPoint(idx)) {
+                reinserted.push_back(idx);
+            }
+        }
+        meeting.insert(meeting.end(), starting.begin(), starting.end());
+
+        if (meeting.size() > 1) {
+            Point location = sweep.location(sweep.now);
+            for (size_t i = 0; i < meeting.size(); i++) {
+                for (size_t j = i + 1; j < meeting.size(); j++) {
+                    intersections.push_back({min(meeting[i], meeting[j]), max(meeting[i], meeting[j]), location});
+                }
+            }
+        }
+
+        for (long long idx: reinserted) {
+            status.insert(idx);
+        }
+
+        if (reinserted.empty()) {
+            auto above = status.lower_bound(sweep.now);
+            if (above != status.begin() && above != status.end()) {
+                checkPair(*prev(above), *above);
+            }
+        } else {
+            auto range = status.equal_range(sweep.now);
+            if (range.first != status.begin()) {
+                checkPair(*prev(range.first), *range.first);
+            }
+            if (range.second != status.end()) {
+                checkPair(*prev(range.second), *range.second);
+            }
+        }
+    }
+
+    // overlapping segments meet at several points, the first one found is the leftmost
+    stable_sort(intersections.begin(), intersections.end(),
+                [](const SegmentIntersection &A, const SegmentIntersection &B) {
+                    return A.first < B.first || (A.first == B.first && A.second < B.second);
+                });
+    intersections.erase(unique(intersections.begin(), intersections.end(),
+                               [](const SegmentIntersection &A, const SegmentIntersection &B) {
+                                   return A.first == B.first && A.second == B.second;
+                               }), intersections.end());
+}
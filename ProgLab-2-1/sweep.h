@@ -0,0 +1,27 @@
+#ifndef PROGLAB_2_1_SWEEP_H
+#define PROGLAB_2_1_SWEEP_H
+
+#include "geometry.h"
+
+// All intersecting pairs of a set of segments with the Bentley-Ottmann sweep,
+// O((n + k) log n) for n segments and k intersecting pairs.
+//
+// The pairs are exactly the ones DirectSegment::intersects accepts: touching
+// ends, an end on another segment, overlapping collinear segments and zero
+// length segments included. Every decision of the sweep (the order of the
+// event points, above or below, the order of the segments leaving a point)
+// is exact; intersection points, which doubles can not hold exactly, are kept
+// as exact rationals of the input coordinates while they matter for the order.
+
+struct SegmentIntersection {
+    long long first;
+    long long second;
+    // where the two segments meet, for overlapping segments the leftmost (then
+    // lowest) shared point; crossings are rounded to the nearest double
+    Point point;
+};
+
+// every pair first < second of intersecting segments, ordered by first, then second
+void allIntersections(const vector<DirectSegment> &segments, vector<SegmentIntersection> &intersections);
+
+#endif //PROGLAB_2_1_SWEEP_H
@@ -0,0 +1,1530 @@
+#include "arena.h"
+#include "fixed.h"
+#include "geometry.h"
+#include "grid.h"
+#include "hull.h"
+#include "kernels.h"
+#include "metrics.h"
+#include "minkowski.h"
+#include "overlay.h"
+#include "predicates.h"
+#include "prepared.h"
+#include "reader.h"
+#include "regular.h"
+#include "rtree.h"
+#include "simplify.h"
+#include "stats.h"
+#include "sweep.h"
+#include "triangulate.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+// Checks of the fast algorithms against plain ones and regression tests of
+// inputs that once broke the library, run by ctest. Every test returns the
+// number of its checks that failed.
+
+namespace {
+    int check(bool condition, const char *what) {
+        if (!condition) {
+            cout << "FAILED: " << what << endl;
+        }
+        return condition ? 0 : 1;
+    }
+
+    // swallows what the constructors print about the invalid shapes of a test
+    class Quiet {
+    private:
+        stringstream _output_;
+        streambuf *_console_;
+    public:
+        Quiet() : _console_(cout.rdbuf(_output_.rdbuf())) {}
+
+        ~Quiet() { cout.rdbuf(_console_); }
+
+        string output() const { return _output_.str(); }
+    };
+
+    // small random polygons on a grid, so that vertexes repeat, touch edges and line up
+    vector<Point> gridRing(mt19937 &random, long long n, int size) {
+        vector<Point> ring;
+        for (long long i = 0; i < n; i++) {
+            ring.emplace_back((double) (random() % size), (double) (random() % size));
+        }
+        return ring;
+    }
+
+    // n distinct grid points sorted around a point off the grid: star-shaped,
+    // simple unless some of them line up with that point
+    vector<Point> starRing(mt19937 &random, long long n, int size) {
+        vector<Point> ring;
+        while ((long long) ring.size() < n) {
+            Point vertex = gridRing(random, 1, size)[0];
+            if (find(ring.begin(), ring.end(), vertex) == ring.end()) {
+                ring.push_back(vertex);
+            }
+        }
+        double center = (size - 1) / 2.0 + 0.25;
+        sort(ring.begin(), ring.end(), [&](const Point &A, const Point &B) {
+            return atan2(A.getY() - center, A.getX() - center) < atan2(B.getY() - center, B.getX() - center);
+        });
+        return ring;
+    }
+
+    // the polygon of the first N vertexes of ring, through the initializer list constructor
+    template<size_t... I>
+    Polygon polygonOf(const vector<Point> &ring, index_sequence<I...>) {
+        return Polygon{ring[I]...};
+    }
+
+    // the pairwise check the sweep replaced: edges that are not neighbours may
+    // not meet, neighbours only at their shared vertex; three vertexes always
+    // pass, as they did before
+    bool isSimplePairwise(const vector<Point> &ring) {
+        long long n = (long long) ring.size();
+        if (n <= 3) {
+            return n == 3;
+        }
+        for (long long i = 0; i < n; i++) {
+            const Point &A = ring[i], &B = ring[(i + 1) % n], &C = ring[(i + 2) % n];
+            // a repeated vertex, or the next edge turning back along this one
+            if (A == B || ((B - A) * (C - B) == 0 && (A - B).scalar(C - B) > 0)) {
+                return false;
+            }
+            for (long long j = i + 2; j < n; j++) {
+                if (i == 0 && j == n - 1) {
+                    continue;
+                }
+                if (DirectSegment(A, B).intersects(DirectSegment(ring[j], ring[(j + 1) % n]))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // The Shamos-Hoey sweep in the Polygon constructor decides as the pairwise
+    // edge checks it replaced, on simple, touching and self-crossing rings.
+    template<size_t N>
+    int validationMatchesPairwise(int rings, int size, bool moved) {
+        mt19937 random(N);
+        int differ = 0, simple = 0;
+        for (int i = 0; i < rings; i++) {
+            vector<Point> ring = moved ? gridRing(random, N, size) : starRing(random, N, size);
+            if (moved && i % 2 == 1) {
+                ring = starRing(random, N, size);
+                ring[random() % N] = gridRing(random, 1, size)[0];
+            }
+            bool expected = isSimplePairwise(ring);
+            Quiet quiet;
+            differ += (polygonOf(ring, make_index_sequence<N>()).degree() == (long long) N) != expected;
+            simple += expected;
+        }
+        return check(differ == 0 && simple > 0 && simple < rings, "the sweep validates as the pairwise checks");
+    }
+
+    int validationOfRings() {
+        Polygon square{Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)};
+        int failed = check(square.degree() == 4, "a square is simple");
+        long long degrees;
+        {
+            Quiet quiet;
+            Polygon bowtie{Point(0, 0), Point(2, 2), Point(2, 0), Point(0, 2)};
+            Polygon touching{Point(0, 0), Point(4, 0), Point(4, 4), Point(2, 0), Point(0, 4)};
+            Polygon folding{Point(0, 0), Point(4, 0), Point(2, 0), Point(2, 3)};
+            Polygon repeated{Point(0, 0), Point(1, 0), Point(1, 0), Point(0, 1)};
+            degrees = bowtie.degree() + touching.degree() + folding.degree() + repeated.degree();
+        }
+        failed += check(degrees == 0, "crossing, touching, folding and repeating rings are not simple");
+
+        // random rings of a few vertexes, star-shaped ones of many with one vertex moved anywhere
+        failed += validationMatchesPairwise<5>(20000, 5, true);
+        failed += validationMatchesPairwise<9>(20000, 5, true);
+        failed += validationMatchesPairwise<24>(3000, 12, false);
+        failed += validationMatchesPairwise<24>(3000, 12, true);
+        return failed;
+    }
+
+    // relative error of a sum against its plain scalar value
+    bool near(double value, double expected) {
+        return abs(value - expected) <= 1e-12 * max(1.0, abs(expected));
+    }
+
+    // The kernels picked at run time (GEOMETRY_KERNELS caps them, see the
+    // ctest variants) against plain loops, for runs shorter than a vector,
+    // empty ones and runs that are no multiple of the vector width.
+    int kernelsMatchScalar() {
+        const char *cap = getenv("GEOMETRY_KERNELS");
+        int failed = 0;
+        if (cap != nullptr && strcmp(cap, "scalar") == 0) {
+            failed += check(strcmp(kernelsName(), "scalar") == 0, "GEOMETRY_KERNELS=scalar picks the scalar kernels");
+        }
+        if (cap != nullptr && strcmp(cap, "sse2") == 0) {
+            failed += check(strcmp(kernelsName(), "avx2") != 0, "GEOMETRY_KERNELS=sse2 does not pick AVX2");
+        }
+
+        mt19937 random(2);
+        uniform_real_distribution<double> coordinate(-100, 100);
+        int wrong = 0;
+        for (long long n: {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 100, 1001}) {
+            vector<Point> vertexes;
+            for (long long i = 0; i < n; i++) {
+                vertexes.emplace_back(coordinate(random), coordinate(random));
+            }
+            double chain = 0, area = 0;
+            for (long long i = 0; i + 1 < n; i++) {
+                const Point &A = vertexes[i], &B = vertexes[i + 1];
+                chain += hypot(B.getX() - A.getX(), B.getY() - A.getY());
+            }
+            double loop = chain;
+            if (n >= 2) {
+                loop += hypot(vertexes[0].getX() - vertexes[n - 1].getX(),
+                              vertexes[0].getY() - vertexes[n - 1].getY());
+            }
+            for (long long i = 0; n >= 3 && i < n; i++) {
+                area += vertexes[i] * vertexes[(i + 1) % n];
+            }
+            wrong += !near(chainLength(vertexes.data(), n), chain) || !near(loopLength(vertexes.data(), n), loop) ||
+                     !near(shoelace(vertexes.data(), n), area);
+        }
+        failed += check(wrong == 0, "length, perimeter and area kernels match plain loops");
+        return failed;
+    }
+
+    // segments on a small lattice (touching, collinear, overlapping, zero
+    // length), the same nudged by an ulp, and anywhere
+    DirectSegment randomSegment(mt19937 &random) {
+        int kind = (int) (random() % 3);
+        double ends[4];
+        for (double &end: ends) {
+            end = (double) (random() % 5);
+            if (kind == 1 && random() % 2 == 0) {
+                end = nextafter(end, random() % 2 == 0 ? 10.0 : -10.0);
+            } else if (kind == 2) {
+                end += (double) (random() % 1000) / 1000;
+            }
+        }
+        return DirectSegment(Point(ends[0], ends[1]), Point(ends[2], ends[3]));
+    }
+
+    // The batch kernels answer as DirectSegment::intersects, for packs that
+    // fill no whole number of vectors too.
+    int intersectionKernelsMatchScalar() {
+        mt19937 random(3);
+        int wrong_masks = 0, wrong_lists = 0, wrong_pairs = 0;
+        for (long long n: {0, 1, 2, 3, 4, 5, 7, 8, 9, 63, 64, 65, 130}) {
+            vector<DirectSegment> segments;
+            SegmentPack pack;
+            for (long long i = 0; i < n; i++) {
+                segments.push_back(randomSegment(random));
+                pack.add(segments.back());
+            }
+            for (int query = 0; query < 200; query++) {
+                DirectSegment segment = randomSegment(random);
+                vector<uint64_t> mask;
+                vector<long long> list, expected;
+                intersectsMask(segment, pack, mask);
+                intersectsList(segment, pack, list);
+                for (long long i = 0; i < n; i++) {
+                    bool hit = segment.intersects(segments[i]);
+                    wrong_masks += hit != ((mask[i / 64] >> (i % 64)) & 1);
+                    if (hit) {
+                        expected.push_back(i);
+                    }
+                }
+                wrong_lists += list != expected;
+            }
+
+            SegmentPack other;
+            vector<DirectSegment> others;
+            for (long long j = 0; j < 37; j++) {
+                others.push_back(randomSegment(random));
+                other.add(others.back());
+            }
+            vector<pair<long long, long long>> pairs, expected;
+            intersectsPairs(pack, other, pairs);
+            for (long long i = 0; i < n; i++) {
+                for (long long j = 0; j < (long long) others.size(); j++) {
+                    if (segments[i].intersects(others[j])) {
+                        expected.emplace_back(i, j);
+                    }
+                }
+            }
+            wrong_pairs += pairs != expected;
+        }
+        int failed = check(wrong_masks == 0, "intersectsMask answers as DirectSegment::intersects");
+        failed += check(wrong_lists == 0, "intersectsList answers as DirectSegment::intersects");
+        failed += check(wrong_pairs == 0, "intersectsPairs answers as DirectSegment::intersects");
+        return failed;
+    }
+
+    // the protected ways of changing a polygon, opened up for the cache test
+    class EditablePolygon : public Polygon {
+    public:
+        using Polygon::Polygon;
+
+        explicit EditablePolygon(const Polygon &polygon) : Polygon(polygon) {}
+
+        using Polygon::operator[];
+
+        using Polygon::elongate;
+
+        using Polygon::clear;
+    };
+
+    // the cached metrics of polygon are the ones a fresh copy of its vertexes computes
+    bool metricsAre(EditablePolygon &polygon, Polygon &fresh) {
+        Box box = polygon.boundingBox(), fresh_box = fresh.boundingBox();
+        return polygon.area() == fresh.area() && polygon.perimeter() == fresh.perimeter() &&
+               polygon.orientation() == fresh.orientation() && box.getLower() == fresh_box.getLower() &&
+               box.getUpper() == fresh_box.getUpper();
+    }
+
+    // Area, perimeter, orientation and bounding box are cached on first use;
+    // every way of changing the vertexes drops them, copies carry them over.
+    int cacheFollowsMutations() {
+        EditablePolygon polygon{Point(0, 0), Point(4, 0), Point(4, 3)};
+        Polygon triangle{Point(0, 0), Point(4, 0), Point(4, 3)};
+        int failed = check(metricsAre(polygon, triangle), "first metrics of a polygon");
+
+        polygon[2] = Point(4, 5);
+        Polygon taller{Point(0, 0), Point(4, 0), Point(4, 5)};
+        failed += check(metricsAre(polygon, taller), "operator[] drops the cached metrics");
+
+        polygon.elongate(Point(-2, 5));
+        Polygon quadrilateral{Point(0, 0), Point(4, 0), Point(4, 5), Point(-2, 5)};
+        failed += check(metricsAre(polygon, quadrilateral), "elongate drops the cached metrics");
+
+        EditablePolygon copy(polygon), moved(move(copy));
+        failed += check(metricsAre(moved, quadrilateral), "copies and moves keep the metrics");
+
+        polygon.clear();
+        failed += check(polygon.area() == 0 && polygon.perimeter() == 0 && polygon.orientation() == 0 &&
+                        polygon.boundingBox().isEmpty(), "clear drops the cached metrics");
+        return failed;
+    }
+
+    // sign of an integer determinant
+    int signOf(__int128 value) {
+        return (value > 0) - (value < 0);
+    }
+
+    // The points of a 64 x 64 block of ulps next to (0.5, 0.5) against lines
+    // through it (after Shewchuk's figure): a plain determinant gets half of
+    // the signs wrong. Scaled by 2^53 every coordinate is an integer, which
+    // gives the exact sign in 128 bits.
+    int predicatesNearCollinear() {
+        const double ulp = ldexp(1.0, -53), scale = ldexp(1.0, 53);
+        auto scaled = [&](double coordinate) { return (__int128) (coordinate * scale); };
+        Point A(12, 12), B(24, 24), D(18.5, 18.5);
+        int wrong_orientations = 0, wrong_crossings = 0, collinear = 0;
+        for (int i = 0; i < 64; i++) {
+            for (int j = 0; j < 64; j++) {
+                Point C(0.5 + i * ulp, 0.5 + j * ulp);
+                __int128 orientation = (scaled(A.getX()) - scaled(C.getX())) * (scaled(B.getY()) - scaled(C.getY())) -
+                                       (scaled(A.getY()) - scaled(C.getY())) * (scaled(B.getX()) - scaled(C.getX()));
+                int exact = signOf(orientation);
+                double decided = orient2d(A, B, C);
+                wrong_orientations += ((decided > 0) - (decided < 0)) != exact;
+                collinear += exact == 0;
+
+                __int128 cross = (scaled(B.getX()) - scaled(A.getX())) * (scaled(D.getY()) - scaled(C.getY())) -
+                                 (scaled(B.getY()) - scaled(A.getY())) * (scaled(D.getX()) - scaled(C.getX()));
+                wrong_crossings += crossSign(A, B, C, D) != signOf(cross);
+            }
+        }
+        int failed = check(wrong_orientations == 0, "orient2d next to a line has the exact sign");
+        failed += check(collinear == 64, "orient2d finds the points on the line");
+        failed += check(wrong_crossings == 0, "crossSign of nearly parallel directions has the exact sign");
+
+        // a segment ending one ulp beside another one, and exactly on it
+        DirectSegment diagonal(Point(0, 0), A);
+        failed += check(!DirectSegment(Point(1, 0), Point(0.5 + ulp, 0.5)).intersects(diagonal),
+                        "a segment one ulp off a line does not touch it");
+        failed += check(DirectSegment(Point(1, 0), Point(0.5, 0.5)).intersects(diagonal),
+                        "a segment ending on a line touches it");
+        return failed;
+    }
+
+    // what operator<< prints, for comparing shapes vertex by vertex
+    template<class Shape>
+    string printed(Shape &shape) {
+        stringstream out;
+        out << shape;
+        return out.str();
+    }
+
+    // Every bulk constructor builds the shape the initializer list builds,
+    // and the polygons among them are checked the same way.
+    int bulkConstructionMatches() {
+        vector<Point> vertexes = {Point(0, 0), Point(4, 0), Point(4, 3), Point(1, 5)};
+        double coordinates[] = {0, 0, 4, 0, 4, 3, 1, 5};
+        double x[] = {0, 4, 4, 1}, y[] = {0, 0, 3, 5};
+
+        Polyline line{Point(0, 0), Point(4, 0), Point(4, 3), Point(1, 5)};
+        Polyline lines[] = {Polyline(vertexes.begin(), vertexes.end()), Polyline(vertexes.data(), 4),
+                            Polyline(coordinates, 4), Polyline(x, y, 4), Polyline(vector<Point>(vertexes))};
+        int differ = 0;
+        for (Polyline &built: lines) {
+            differ += printed(built) != printed(line);
+        }
+        int failed = check(differ == 0, "polylines from ranges, arrays and vectors");
+
+        Polygon polygon{Point(0, 0), Point(4, 0), Point(4, 3), Point(1, 5)};
+        Polygon polygons[] = {Polygon(vertexes.begin(), vertexes.end()), Polygon(vertexes.data(), 4),
+                              Polygon(coordinates, 4), Polygon(x, y, 4), Polygon(vector<Point>(vertexes))};
+        differ = 0;
+        for (Polygon &built: polygons) {
+            differ += printed(built) != printed(polygon) || built.area() != polygon.area();
+        }
+        failed += check(differ == 0, "polygons from ranges, arrays and vectors");
+
+        // the last two vertexes swapped make the edges cross
+        swap(vertexes[2], vertexes[3]);
+        long long degrees;
+        {
+            Quiet quiet;
+            degrees = Polygon(vertexes.begin(), vertexes.end()).degree() + Polygon(vertexes.data(), 4).degree() +
+                      Polygon(vector<Point>(vertexes)).degree();
+        }
+        failed += check(degrees == 0, "polygons from ranges are validated");
+        return failed;
+    }
+
+    // what a parser handed out, feature by feature
+    struct Parsed {
+        long long features = 0;
+        vector<long long> polylines, polygons, errors;
+    };
+
+    Parsed parsed(bool wkt, const string &text) {
+        Parsed result;
+        auto collect = [&](GeometryBatch &batch) {
+            result.polylines.insert(result.polylines.end(), batch.polyline_features.begin(),
+                                    batch.polyline_features.end());
+            result.polygons.insert(result.polygons.end(), batch.polygon_features.begin(),
+                                   batch.polygon_features.end());
+            for (const ParseError &error: batch.errors) {
+                result.errors.push_back(error.feature);
+            }
+        };
+        // batches of one, so that every shape and error goes through a flush
+        Quiet quiet;
+        result.features = wkt ? parseWKT(text.data(), (long long) text.size(), collect, 1)
+                              : parseGeoJSON(text.data(), (long long) text.size(), collect, 1);
+        return result;
+    }
+
+    bool parsedAre(const Parsed &result, long long features, const vector<long long> &polylines,
+                   const vector<long long> &polygons, const vector<long long> &errors) {
+        return result.features == features && result.polylines == polylines && result.polygons == polygons &&
+               result.errors == errors;
+    }
+
+    // A broken feature costs one error and nothing else: truncated input, text
+    // after a geometry or a document, and a bad polygon among good features.
+    int readersSkipBadFeatures() {
+        int failed = check(parsedAre(parsed(true, "LINESTRING (0 0, 1 1)\nPOLYGON ((0 0, 2 0, 2 2, 0 2, 0 0))\n"),
+                                     2, {0}, {1}, {}), "WKT lines are read");
+        failed += check(parsedAre(parsed(true, "LINESTRING (0 0, 1 1)\nPOLYGON ((0 0, 2 0, 2"), 2, {0}, {}, {1}),
+                        "truncated WKT is an error of the last geometry");
+        failed += check(parsedAre(parsed(true, "LINESTRING (0 0, 1 1) garbage\nPOLYGON ((0 0, 2 0, 2 2, 0 0))\n"
+                                               "LINESTRING (0 0, 1 1);\n"), 3, {0, 2}, {1}, {0}),
+                        "text after a WKT geometry is an error of that geometry");
+        failed += check(parsedAre(parsed(true, "MULTIPOLYGON (((0 0, 2 0, 2 2, 0 0)), ((0 0, 2 2, 2 0, 0 2, 0 0)))\n"
+                                               "POLYGON ((0 0, 1 0, 1 1, 0 0))\n"), 2, {}, {0, 1}, {0}),
+                        "a bad WKT polygon leaves the others of its feature");
+
+        string collection = R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[0, 0], [1, 1]]}},
+            {"type": "Feature", "geometry": {"type": "MultiPolygon", "coordinates": [
+                [[[0, 0], [2, 0], [2, 2], [0, 0]]], [[[0, 0], [2, 2], [2, 0], [0, 2], [0, 0]]]]}},
+            {"type": "Feature", "geometry": {"type": "Polygon", "coordinates": [[[0, 0], [1, 0], [1, 1]]]}}]})";
+        failed += check(parsedAre(parsed(false, collection), 3, {0}, {1, 2}, {1}),
+                        "a bad GeoJSON polygon leaves the other features");
+        failed += check(parsedAre(parsed(false, collection.substr(0, collection.find("[[[0, 0], [2, 2]") + 8)),
+                                  2, {0}, {1}, {1}), "truncated GeoJSON is one error of the last feature");
+        failed += check(parsedAre(parsed(false, collection + " {}"), 3, {0}, {1, 2}, {1, 0}),
+                        "text after a GeoJSON document is an error");
+        failed += check(parsedAre(parsed(false, R"({"type": "LineString", "coordinates": [[0, 0], [1, 1]]} x)"),
+                                  1, {0}, {}, {0}), "text after a bare GeoJSON geometry is an error");
+        failed += check(parsed(false, R"({"type": "Feature", "properties": {"name": "a\)").errors.size() == 1,
+                        "a string cut after a backslash is an error");
+        return failed;
+    }
+
+    // boxes of one to three units on a grid, so that many touch; every tenth is empty
+    vector<Box> gridBoxes(mt19937 &random, long long n, int size) {
+        vector<Box> boxes;
+        for (long long i = 0; i < n; i++) {
+            Point lower = gridRing(random, 1, size)[0];
+            Point upper = lower + Point(1 + random() % 3, 1 + random() % 3);
+            boxes.push_back(i % 10 == 9 ? Box() : Box(lower, upper));
+        }
+        return boxes;
+    }
+
+    // the segment meets the box itself, not only its bounding box
+    bool segmentMeets(const DirectSegment &segment, const Box &box) {
+        if (box.isEmpty()) {
+            return false;
+        }
+        Point lower = box.getLower(), upper = box.getUpper();
+        Point corners[] = {lower, Point(upper.getX(), lower.getY()), upper, Point(lower.getX(), upper.getY())};
+        if (box.contains(segment.getBegin())) {
+            return true;
+        }
+        for (int i = 0; i < 4; i++) {
+            if (segment.intersects(DirectSegment(corners[i], corners[(i + 1) % 4]))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Every query of the R-tree finds what a loop over all the boxes finds, on
+    // empty trees, trees of a single node and trees of several levels.
+    int rtreeMatchesBruteForce() {
+        mt19937 random(9);
+        int wrong_search = 0, wrong_candidates = 0, wrong_overlaps = 0, wrong_traverse = 0;
+        for (long long n: {0, 1, 3, 4, 17, 250, 2000}) {
+            for (long long node_size: {2, 4, 16}) {
+                vector<Box> boxes = gridBoxes(random, n, 40), others = gridBoxes(random, n / 2 + 1, 40);
+                RTree tree(boxes, node_size), other(others.begin(), others.end(), node_size);
+                vector<long long> items, expected;
+                for (int query = 0; query < 20; query++) {
+                    Point A = gridRing(random, 1, 40)[0], B = gridRing(random, 1, 40)[0];
+                    if (A == B) {
+                        B = B + Point(1, 1);
+                    }
+                    Box window = Box().expand(A).expand(B);
+                    DirectSegment segment(A, B);
+
+                    tree.search(window, items);
+                    expected.clear();
+                    for (long long i = 0; i < n; i++) {
+                        if (boxes[i].intersects(window)) {
+                            expected.push_back(i);
+                        }
+                    }
+                    sort(items.begin(), items.end());
+                    wrong_search += items != expected;
+
+                    // candidates may keep boxes the segment misses, but only boxes it would find
+                    tree.candidates(segment, items);
+                    sort(items.begin(), items.end());
+                    for (long long i = 0; i < n; i++) {
+                        bool found = binary_search(items.begin(), items.end(), i);
+                        wrong_candidates += (segmentMeets(segment, boxes[i]) && !found) ||
+                                            (found && !boxes[i].intersects(window));
+                    }
+                }
+
+                vector<pair<long long, long long>> pairs, expected_pairs;
+                tree.overlaps(other, pairs);
+                for (long long i = 0; i < n; i++) {
+                    for (long long j = 0; j < (long long) others.size(); j++) {
+                        if (boxes[i].intersects(others[j])) {
+                            expected_pairs.emplace_back(i, j);
+                        }
+                    }
+                }
+                wrong_overlaps += pairs != expected_pairs;
+
+                // a walk accepting everything sees every item once, a stopped walk stops
+                items.clear();
+                bool finished = tree.traverse([](const Box &) { return true; }, [&](long long item) {
+                    items.push_back(item);
+                    return true;
+                });
+                expected.resize(n);
+                iota(expected.begin(), expected.end(), 0);
+                sort(items.begin(), items.end());
+                long long visited = 0;
+                bool stopped = !tree.traverse([](const Box &) { return true; }, [&](long long) {
+                    return ++visited < 3;
+                });
+                wrong_traverse += !finished || items != expected || stopped != (expected.size() >= 3) ||
+                                  visited != min((long long) expected.size(), 3LL);
+            }
+        }
+        int failed = check(wrong_search == 0, "RTree::search finds the boxes meeting the window");
+        failed += check(wrong_candidates == 0, "RTree::candidates keeps every box the segment meets");
+        failed += check(wrong_overlaps == 0, "RTree::overlaps finds the overlapping pairs in order");
+        failed += check(wrong_traverse == 0, "RTree::traverse visits every item once and stops when asked");
+        return failed;
+    }
+
+    // Batch metrics are the metrics of every shape on its own, whatever the
+    // number of threads, for collections shorter and longer than a chunk.
+    int batchMetricsMatch() {
+        mt19937 random(10);
+        int wrong = 0;
+        for (long long count: {0LL, 1LL, METRICS_CHUNK - 1, 3 * METRICS_CHUNK + 5}) {
+            vector<Polygon> polygons;
+            vector<ClosedPolyline> loops;
+            {
+                Quiet quiet;
+                for (long long i = 0; i < count; i++) {
+                    vector<Point> ring = starRing(random, 3 + (long long) (random() % 40), 12);
+                    // some of them are no polygons at all
+                    if (i % 7 == 3) {
+                        ring[0] = ring[ring.size() / 2];
+                    }
+                    polygons.emplace_back(vector<Point>(ring));
+                    loops.emplace_back(move(ring));
+                }
+            }
+            for (unsigned threads: {1u, 2u, 7u, 0u}) {
+                vector<Polygon> fresh = polygons;
+                vector<ShapeMetrics> metrics = batchMetrics(fresh, threads);
+                vector<ShapeMetrics> loop_metrics = batchMetrics(loops, threads);
+                for (long long i = 0; i < count; i++) {
+                    Polygon alone = polygons[i];
+                    wrong += metrics[i].area != alone.area() || metrics[i].perimeter != alone.perimeter() ||
+                             metrics[i].degree != alone.degree();
+                    // a loop measures the same as its polygon, when that is one
+                    wrong += alone.degree() != 0 && (loop_metrics[i].degree != alone.degree() ||
+                                                     !near(loop_metrics[i].area, alone.area()) ||
+                                                     !near(loop_metrics[i].perimeter, alone.perimeter()));
+                }
+            }
+        }
+        return check(wrong == 0, "batchMetrics measures as the shapes do one by one");
+    }
+
+    // PreparedPolygon answers as Polygon::contains, also for the points on
+    // vertexes, edges and horizontal edges that the quarter steps hit.
+    int preparedMatchesContains() {
+        mt19937 random(11);
+        vector<Point> points;
+        for (int x = -4; x <= 40; x++) {
+            for (int y = -4; y <= 40; y++) {
+                points.emplace_back(x / 4.0, y / 4.0);
+            }
+        }
+        // the rings that line up with the centre are no polygons, they contain nothing
+        vector<Polygon> polygons;
+        {
+            Quiet quiet;
+            for (int i = 0; i < 200; i++) {
+                polygons.emplace_back(starRing(random, 8 + (long long) (random() % 40), 10));
+            }
+        }
+        int differ = 0, differ_batch = 0, inside = 0, queries = 0;
+        for (Polygon &polygon: polygons) {
+            PreparedPolygon prepared(polygon);
+            vector<uint8_t> batch;
+            prepared.contains(points.data(), (long long) points.size(), batch, 2);
+            for (size_t k = 0; k < points.size(); k++) {
+                bool expected = polygon.contains(points[k]);
+                differ += prepared.contains(points[k]) != expected;
+                differ_batch += (batch[k] == 1) != expected;
+                inside += expected;
+            }
+            queries += (int) points.size();
+        }
+        int failed = check(differ == 0, "PreparedPolygon contains the points Polygon::contains does");
+        failed += check(differ_batch == 0, "batched PreparedPolygon queries match Polygon::contains");
+        failed += check(inside > queries / 10 && inside < queries - queries / 10, "the queries fall inside and out");
+        return failed;
+    }
+
+    // The hull contains every point of the cloud and is made of cloud points
+    // only, for clouds with repeated and collinear points and for any threads.
+    int hullCoversPoints() {
+        mt19937 random(12);
+        uniform_real_distribution<double> coordinate(-1, 1);
+        int uncovered = 0, foreign = 0, degrees = 0;
+        for (int round = 0; round < 60; round++) {
+            long long n = 3 + (long long) (random() % 3000);
+            vector<Point> points = round % 2 == 0 ? gridRing(random, n, 8) : vector<Point>();
+            while ((long long) points.size() < n) {
+                points.emplace_back(coordinate(random), coordinate(random));
+            }
+            EditablePolygon hull(convexHull(points, 1 + round % 4));
+            degrees += hull.degree() < 3;
+            for (const Point &point: points) {
+                uncovered += !hull.contains(point);
+            }
+            vector<Point> sorted = points;
+            sort(sorted.begin(), sorted.end(), [](const Point &A, const Point &B) {
+                return make_pair(A.getX(), A.getY()) < make_pair(B.getX(), B.getY());
+            });
+            for (long long i = 0; i < hull.degree(); i++) {
+                foreign += !binary_search(sorted.begin(), sorted.end(), hull[i], [](const Point &A, const Point &B) {
+                    return make_pair(A.getX(), A.getY()) < make_pair(B.getX(), B.getY());
+                });
+            }
+        }
+        int failed = check(degrees == 0, "clouds spanning a polygon have a hull");
+        failed += check(uncovered == 0, "the hull contains every point of the cloud");
+        failed += check(foreign == 0, "every vertex of the hull is a point of the cloud");
+
+        vector<Point> line = {Point(0, 0), Point(1, 1), Point(3, 3), Point(1, 1), Point(2, 2)};
+        failed += check(convexHull(line).degree() == 0 && convexHull(vector<Point>()).degree() == 0,
+                        "points on one line and no points have an empty hull");
+        return failed;
+    }
+
+    // allIntersections reports the pairs that testing every pair with
+    // DirectSegment::intersects finds: on a small grid segments touch, overlap,
+    // meet at their ends and have zero length; off the grid they cross.
+    int sweepMatchesBruteForce() {
+        mt19937 random(13);
+        int differ = 0, misplaced = 0, pairs = 0;
+        for (int round = 0; round < 100; round++) {
+            int size = round % 2 == 0 ? 6 : 1000;
+            double step = round % 2 == 0 ? 1 : 0.001;
+            vector<DirectSegment> segments;
+            for (int i = 0; i < 60; i++) {
+                vector<Point> ends = gridRing(random, 2, size);
+                segments.emplace_back(Point(ends[0].getX() * step, ends[0].getY() * step),
+                                      Point(ends[1].getX() * step, ends[1].getY() * step));
+            }
+            vector<pair<long long, long long>> expected;
+            for (long long a = 0; a < (long long) segments.size(); a++) {
+                for (long long b = a + 1; b < (long long) segments.size(); b++) {
+                    if (segments[a].intersects(segments[b])) {
+                        expected.emplace_back(a, b);
+                    }
+                }
+            }
+            vector<SegmentIntersection> found;
+            allIntersections(segments, found);
+            vector<pair<long long, long long>> reported;
+            for (const SegmentIntersection &intersection: found) {
+                reported.emplace_back(intersection.first, intersection.second);
+                // the meeting point, up to the rounding of a crossing
+                for (long long index: {intersection.first, intersection.second}) {
+                    Box box = segments[index].boundingBox();
+                    Point lower = box.getLower(), upper = box.getUpper();
+                    misplaced += intersection.point.getX() < lower.getX() - 1e-9 ||
+                                 intersection.point.getX() > upper.getX() + 1e-9 ||
+                                 intersection.point.getY() < lower.getY() - 1e-9 ||
+                                 intersection.point.getY() > upper.getY() + 1e-9;
+                }
+            }
+            differ += reported != expected;
+            pairs += (int) expected.size();
+        }
+        int failed = check(differ == 0, "allIntersections reports the pairs of the brute force");
+        failed += check(misplaced == 0, "every intersection point lies on both segments");
+        failed += check(pairs > 1000, "the segments intersect");
+        return failed;
+    }
+
+    // area of the pieces, their holes taken off
+    double areaOf(vector<PolygonWithHoles> &pieces) {
+        double area = 0;
+        for (PolygonWithHoles &piece: pieces) {
+            area += piece.outer.area();
+            for (Polygon &hole: piece.holes) {
+                area -= hole.area();
+            }
+        }
+        return area;
+    }
+
+    // outer rings counterclockwise, holes clockwise, none of them degenerate
+    bool ringsAreOriented(vector<PolygonWithHoles> &pieces) {
+        for (PolygonWithHoles &piece: pieces) {
+            if (piece.outer.degree() < 3 || piece.outer.orientation() != 1) {
+                return false;
+            }
+            for (Polygon &hole: piece.holes) {
+                if (hole.degree() < 3 || hole.orientation() != -1) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // A vertex of Q lies on an edge of P only up to rounding: every round cut
+    // the crossings next to it one ulp further, the overlay never became planar
+    // and the face walk of the union ran out of memory.
+    int overlayNearVertex() {
+        Point p[] = {Point(1, 5), Point(8, 5), Point(3, 8)};
+        Point q[] = {Point(0, 5), Point(1.2, 5.3), Point(1, 5), Point(5, 6), Point(3, 11)};
+        Polygon P(p, 3), Q(q, 5);
+        Overlay overlay(P, Q);
+        int failed = check(overlay.isPlanar(), "overlay near a vertex is planar");
+        failed += check(overlay.size() <= 12, "overlay near a vertex has no slivers");
+
+        vector<PolygonWithHoles> sum = overlay.result(BooleanOperation::UNION);
+        vector<PolygonWithHoles> common = overlay.result(BooleanOperation::INTERSECTION);
+        failed += check(sum.size() == 1 && ringsAreOriented(sum), "union near a vertex is one ring");
+        failed += check(ringsAreOriented(common), "intersection near a vertex has oriented rings");
+        failed += check(abs(areaOf(sum) + areaOf(common) - P.area() - Q.area()) < 1e-9,
+                        "union and intersection near a vertex add up to both polygons");
+        return failed;
+    }
+
+    // n - 2 counterclockwise triangles whose areas add up to the polygon's
+    bool triangulatesExactly(Polygon &polygon) {
+        vector<Triangle> triangles;
+        triangulate(polygon, triangles);
+        double area = 0;
+        for (Triangle &triangle: triangles) {
+            if (triangle.orientation() != 1) {
+                return false;
+            }
+            area += triangle.area();
+        }
+        return (long long) triangles.size() == polygon.degree() - 2 &&
+               abs(area - polygon.area()) <= 1e-12 * polygon.area();
+    }
+
+    // Triangulation of star-shaped polygons with straight runs in either
+    // orientation, and of combs whose teeth make split and merge vertexes.
+    int triangulationCoversPolygon() {
+        mt19937 random(15);
+        int wrong = 0, tried = 0;
+        while (tried < 300) {
+            vector<Point> ring = starRing(random, 5 + (long long) (random() % 60), 9);
+            Polygon counterclockwise;
+            {
+                Quiet quiet;
+                counterclockwise = Polygon(ring.data(), (long long) ring.size());
+            }
+            if (counterclockwise.degree() == 0) {
+                continue;
+            }
+            reverse(ring.begin(), ring.end());
+            Polygon clockwise(ring.data(), (long long) ring.size());
+            wrong += !triangulatesExactly(counterclockwise) + !triangulatesExactly(clockwise);
+            tried++;
+        }
+        int failed = check(wrong == 0, "star-shaped polygons give n - 2 triangles of their area");
+
+        // teeth up along the bottom and down along the top
+        vector<Point> comb;
+        for (int k = 0; k < 10; k++) {
+            comb.emplace_back(2 * k, 0);
+            comb.emplace_back(2 * k + 1, 3 + k % 3);
+        }
+        comb.emplace_back(20, 0);
+        comb.emplace_back(20, 10);
+        for (int k = 9; k >= 0; k--) {
+            comb.emplace_back(2 * k + 1, 10);
+            comb.emplace_back(2 * k + 1, 6 + k % 2);
+            comb.emplace_back(2 * k, 10);
+        }
+        Polygon teeth(comb.data(), (long long) comb.size());
+        failed += check(teeth.degree() > 0 && triangulatesExactly(teeth), "a comb gives n - 2 triangles of its area");
+
+        vector<long long> indexes;
+        Polygon empty;
+        triangulate(empty, indexes);
+        failed += check(indexes.empty(), "an empty polygon gives no triangles");
+        return failed;
+    }
+
+    // the vertexes of polygon through the validating constructor again
+    bool validatesAgain(const Polygon &polygon) {
+        EditablePolygon copy(polygon);
+        vector<Point> ring;
+        for (long long i = 0; i < copy.degree(); i++) {
+            ring.push_back(copy[i]);
+        }
+        Quiet quiet;
+        return Polygon(move(ring)).degree() == copy.degree();
+    }
+
+    // A simplified Polygon keeps at least three of its vertexes and stays
+    // simple, built from its vertexes again it passes validation.
+    int simplifiedPolygonIsSimple() {
+        mt19937 random(16);
+        int broken = 0, dropped = 0, tried = 0;
+        while (tried < 100) {
+            Polygon polygon;
+            {
+                Quiet quiet;
+                polygon = Polygon(starRing(random, 60 + (long long) (random() % 200), 40));
+            }
+            if (polygon.degree() == 0) {
+                continue;
+            }
+            for (double tolerance: {0.5, 2.0, 8.0, 40.0}) {
+                Polygon simplified[] = {douglasPeucker(polygon, tolerance),
+                                        visvalingam(polygon, tolerance * tolerance)};
+                for (Polygon &result: simplified) {
+                    broken += result.degree() < 3 || result.degree() > polygon.degree() || !validatesAgain(result);
+                    dropped += result.degree() < polygon.degree();
+                }
+            }
+            tried++;
+        }
+        int failed = check(broken == 0, "simplified polygons stay simple");
+        failed += check(dropped > 700, "simplification drops vertexes");
+        return failed;
+    }
+
+    // A FixedPolygon built from a polygon of another degree has every vertex
+    // at the origin, and says nothing about it.
+    int fixedWrongDegree() {
+        Point corners[] = {Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)};
+        Polygon square(corners, 4);
+
+        string output;
+        bool at_origin;
+        {
+            Quiet quiet;
+            at_origin = FixedTriangle(square) == FixedTriangle();
+            output = quiet.output();
+        }
+        int failed = check(output.empty(), "a fixed polygon of the wrong degree prints nothing");
+        failed += check(at_origin, "a fixed polygon of the wrong degree has every vertex at the origin");
+        FixedTrapezoid quadrilateral(square);
+        failed += check(quadrilateral.area() == 4 && quadrilateral[2] == Point(2, 2),
+                        "a fixed polygon of the right degree keeps the vertexes");
+        Checked<FixedTriangle> triangle = FixedTriangle::tryMake(square);
+        failed += check(triangle.status.error == ShapeError::WRONG_DEGREE && triangle.shape == FixedTriangle(),
+                        "tryMake refuses a fixed polygon of the wrong degree");
+        Checked<FixedTrapezoid> made = FixedTrapezoid::tryMake(square);
+        failed += check(made.status && made.shape == quadrilateral,
+                        "tryMake keeps a fixed polygon of the right degree");
+        return failed;
+    }
+
+    // takes its memory from the heap and counts the blocks
+    class CountingResource : public pmr::memory_resource {
+    public:
+        long long allocations = 0, live = 0;
+
+    protected:
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            allocations++, live++;
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override {
+            live--;
+            pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // the vertexes of a regular polygon of n vertexes, as plain points
+    vector<Point> circleRing(long long n) {
+        vector<Point> ring;
+        for (long long i = 0; i < n; i++) {
+            ring.emplace_back(cos(2 * M_PI * (double) i / (double) n), sin(2 * M_PI * (double) i / (double) n));
+        }
+        return ring;
+    }
+
+    // Batches of polygons built in an arena are the polygons built on the heap;
+    // after a reset the next batches reuse the chunks of the first one, and
+    // copies, moves and assignments keep the resources geometry.h promises.
+    int arenaBatches() {
+        CountingResource upstream;
+        vector<Point> ring = circleRing(100);
+        Polygon reference(ring.begin(), ring.end());
+        int wrong = 0, misplaced = 0;
+        long long first_batch = 0, later_batches = 0;
+        {
+            ArenaResource arena(4096, &upstream);
+            for (int batch = 0; batch < 5; batch++) {
+                {
+                    vector<Polygon> polygons;
+                    for (int i = 0; i < 50; i++) {
+                        polygons.emplace_back(ring.begin(), ring.end(), &arena);
+                    }
+                    for (Polygon &polygon: polygons) {
+                        wrong += polygon.resource() != &arena || printed(polygon) != printed(reference) ||
+                                 polygon.area() != reference.area();
+                    }
+                }
+                if (batch == 0) {
+                    first_batch = upstream.allocations;
+                }
+                wrong += arena.used() == 0;
+                arena.reset();
+                wrong += arena.used() != 0 || arena.capacity() == 0;
+            }
+            later_batches = upstream.allocations - first_batch;
+
+            Polygon in_arena(ring.begin(), ring.end(), &arena);
+            Polygon copied(in_arena), copied_into(in_arena, &upstream);
+            misplaced += copied.resource() != pmr::get_default_resource() || copied_into.resource() != &upstream;
+            // assignments overwrite a polygon of the same type
+            Polygon assigned(ring.rbegin(), ring.rend(), &upstream);
+            assigned = in_arena;
+            Polygon moved(move(in_arena));
+            misplaced += assigned.resource() != &upstream || moved.resource() != &arena;
+            assigned = move(moved);
+            misplaced += assigned.resource() != &upstream;
+            wrong += printed(copied) != printed(reference) || printed(copied_into) != printed(reference) ||
+                     printed(assigned) != printed(reference);
+        }
+        int failed = check(wrong == 0, "polygons in an arena are the polygons on the heap");
+        failed += check(first_batch > 0 && later_batches == 0,
+                        "batches after the first take nothing from the upstream resource");
+        failed += check(misplaced == 0, "copies, moves and assignments keep the documented resources");
+        failed += check(upstream.live == 0, "the arena hands its chunks back");
+        return failed;
+    }
+
+    vector<Point> pointsOf(const VertexBuffer &buffer) {
+        return vector<Point>(buffer.begin(), buffer.end());
+    }
+
+    // A buffer moves to the heap when it outgrows GEOMETRY_INLINE_VERTEXES and
+    // stays there; copies, moves and assignments between inline and heap
+    // buffers on different resources keep the vertexes and the resources
+    // geometry.h promises.
+    int vertexBuffersSpill() {
+        const long long INLINE = GEOMETRY_INLINE_VERTEXES;
+        vector<Point> ring = circleRing(3 * INLINE);
+        CountingResource first, second;
+
+        int wrong = 0;
+        {
+            VertexBuffer growing(&first);
+            for (long long n = 1; n <= 3 * INLINE; n++) {
+                growing.push_back(ring[n - 1]);
+                wrong += growing.isSpilled() != (n > INLINE) ||
+                         pointsOf(growing) != vector<Point>(ring.begin(), ring.begin() + n);
+            }
+            wrong += first.allocations == 0;
+            growing.clear();
+            growing.push_back(ring[0]);
+            wrong += !growing.isSpilled() || growing.size() != 1;
+        }
+        int failed = check(wrong == 0, "a vertex buffer spills past the inline vertexes and stays spilled");
+
+        int misplaced = 0;
+        wrong = 0;
+        for (long long a: {0LL, INLINE - 1, INLINE, INLINE + 1, 3 * INLINE}) {
+            for (long long b: {0LL, INLINE, INLINE + 1}) {
+                vector<Point> A(ring.begin(), ring.begin() + a), B(ring.begin() + 1, ring.begin() + 1 + b);
+                VertexBuffer source(A.begin(), A.end(), &first), target(B.begin(), B.end(), &second);
+
+                VertexBuffer copied(source), copied_into(source, &second);
+                wrong += pointsOf(copied) != A || pointsOf(copied_into) != A;
+                misplaced += copied.resource() != pmr::get_default_resource() || copied_into.resource() != &second;
+
+                VertexBuffer assigned = target;
+                assigned = source;
+                wrong += pointsOf(assigned) != A;
+                misplaced += assigned.resource() != pmr::get_default_resource();
+
+                VertexBuffer moved(move(copied_into));
+                wrong += pointsOf(moved) != A || copied_into.size() != 0;
+                misplaced += moved.resource() != &second;
+
+                // from one resource to another the vertexes are copied, on the same one the heap is taken over
+                target = move(moved);
+                wrong += pointsOf(target) != A;
+                misplaced += target.resource() != &second;
+                VertexBuffer other(B.begin(), B.end(), &first);
+                other = move(source);
+                wrong += pointsOf(other) != A;
+                misplaced += other.resource() != &first;
+            }
+        }
+        failed += check(wrong == 0, "copies and moves of inline and spilled buffers keep the vertexes");
+        failed += check(misplaced == 0, "copies and moves of vertex buffers keep the documented resources");
+
+        // polygons on either side of the inline limit measure as plain loops
+        wrong = 0;
+        for (long long n: {INLINE, INLINE + 1}) {
+            vector<Point> vertexes = circleRing(max(n, 3LL));
+            Polygon polygon(vertexes.begin(), vertexes.end());
+            double area = 0;
+            for (size_t i = 0; i < vertexes.size(); i++) {
+                area += vertexes[i] * vertexes[(i + 1) % vertexes.size()];
+            }
+            wrong += polygon.degree() != (long long) vertexes.size() || !near(polygon.area(), area / 2);
+        }
+        failed += check(wrong == 0, "polygons on either side of the inline limit");
+        failed += check(first.live == 0 && second.live == 0, "vertex buffers give back their memory");
+        return failed;
+    }
+
+    // The float and long double kernels against plain long double loops, up to
+    // the rounding of sums kept in T: relative to the sum of the magnitudes of
+    // the terms, as the shoelace terms cancel.
+    template<class T>
+    int typedKernelsMatchScalar(const char *what) {
+        mt19937 random(2);
+        uniform_real_distribution<double> coordinate(-100, 100);
+        long double tolerance = 64 * numeric_limits<T>::epsilon();
+        int wrong = 0;
+        for (long long n: {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 1001}) {
+            vector<BasicPoint<T>> vertexes;
+            for (long long i = 0; i < n; i++) {
+                vertexes.emplace_back((T) coordinate(random), (T) coordinate(random));
+            }
+            long double chain = 0, closing = 0, area = 0, magnitude = 0;
+            for (long long i = 0; i < n; i++) {
+                const BasicPoint<T> &A = vertexes[i], &B = vertexes[(i + 1) % n];
+                long double length = hypot((long double) B.getX() - A.getX(), (long double) B.getY() - A.getY());
+                long double term = (long double) A.getX() * B.getY() - (long double) A.getY() * B.getX();
+                (i + 1 < n ? chain : closing) += length;
+                area += n >= 3 ? term : 0;
+                magnitude += abs(term);
+            }
+            long double loop = n >= 2 ? chain + closing : 0;
+            wrong += abs(chainLength(vertexes.data(), n) - chain) > tolerance * max(chain, 1.0L) ||
+                     abs(loopLength(vertexes.data(), n) - loop) > tolerance * max(loop, 1.0L) ||
+                     abs(shoelace(vertexes.data(), n) - area) > tolerance * max(magnitude, 1.0L);
+        }
+        return check(wrong == 0, what);
+    }
+
+    // Shapes converted to other coordinates keep their vertexes and their type
+    // tag; narrowed polygons are validated again, widened ones need not be.
+    int coordinateConversions() {
+        int failed = typedKernelsMatchScalar<float>("float kernels match plain loops");
+        failed += typedKernelsMatchScalar<long double>("long double kernels match plain loops");
+
+        BasicPoint<float> corners[] = {BasicPoint<float>(0, 0), BasicPoint<float>(0.1f, 0),
+                                       BasicPoint<float>(0.1f, 0.3f)};
+        BasicTriangle<float> narrow(corners, 3);
+        Triangle wide(narrow);
+        BasicTriangle<long double> wider(wide);
+        BasicPolygon<float> back(wider);
+        failed += check(wide.getType() == PolygonType::TRIANGLE && back.getType() == PolygonType::TRIANGLE &&
+                        wide.area() == 0.5 * (double) 0.1f * (double) 0.3f && back.area() == narrow.area() &&
+                        printed(back) == printed(narrow), "widened and narrowed back, a triangle stays the same");
+
+        // a notch that comes within 1e-9 of the bottom edge: in float it lands on the edge
+        Polygon notched{Point(0, 1), Point(4, 1), Point(4, 5), Point(2, 1 + 1e-9), Point(0, 5)};
+        long long narrowed;
+        {
+            Quiet quiet;
+            narrowed = BasicPolygon<float>(notched).degree();
+        }
+        failed += check(notched.degree() == 5 && narrowed == 0, "a polygon that touches itself in float is refused");
+        failed += check(BasicPolygon<long double>(notched).degree() == 5, "widening a polygon keeps it");
+
+        Polyline line{Point(0, 0), Point(1e-9, 0), Point(1, 1)};
+        BasicPolyline<float> narrow_line(line);
+        failed += check(narrow_line.size() == 3 && narrow_line[1] == BasicPoint<float>(1e-9f, 0),
+                        "a line narrows vertex by vertex");
+        return failed;
+    }
+
+    // The int64_t kernels: the shoelace sum exact in 128 bits, the lengths as
+    // long double loops give them, for coordinates up to GRID_LIMIT.
+    int gridKernelsMatchScalar() {
+        mt19937_64 random(21);
+        int wrong = 0;
+        for (int64_t range: {(int64_t) 100, GRID_LIMIT}) {
+            uniform_int_distribution<int64_t> coordinate(-range, range);
+            for (long long n: {0, 1, 2, 3, 4, 5, 7, 8, 9, 17, 100}) {
+                vector<GridPoint> vertexes;
+                for (long long i = 0; i < n; i++) {
+                    vertexes.emplace_back(coordinate(random), coordinate(random));
+                }
+                __int128 area = 0;
+                long double chain = 0, closing = 0;
+                for (long long i = 0; i < n; i++) {
+                    const GridPoint &A = vertexes[i], &B = vertexes[(i + 1) % n];
+                    (i + 1 < n ? chain : closing) += hypot((long double) B.getX() - (long double) A.getX(),
+                                                           (long double) B.getY() - (long double) A.getY());
+                    area += n >= 3 ? (__int128) A.getX() * B.getY() - (__int128) A.getY() * B.getX() : 0;
+                }
+                long double loop = n >= 2 ? chain + closing : 0;
+                wrong += shoelace(vertexes.data(), n) != area ||
+                         abs(chainLength(vertexes.data(), n) - chain) > 1e-12L * max(chain, 1.0L) ||
+                         abs(loopLength(vertexes.data(), n) - loop) > 1e-12L * max(loop, 1.0L);
+            }
+        }
+        return check(wrong == 0, "int64_t kernels match plain loops");
+    }
+
+    // Coordinates at +-GRID_LIMIT were subtracted in int64_t, and at a limit of
+    // 2^62 the square of the whole grid doubled to 2^127 and wrapped: its area
+    // came out negative and its orientation clockwise.
+    int gridLimits() {
+        GridPoint low_left(-GRID_LIMIT, -GRID_LIMIT), low_right(GRID_LIMIT, -GRID_LIMIT);
+        GridPoint up_left(-GRID_LIMIT, GRID_LIMIT), up_right(GRID_LIMIT, GRID_LIMIT);
+        int failed = check(orient2d(low_left, low_right, up_right) > 0, "turn across the whole grid is left");
+        failed += check(crossSign(up_left, low_right, low_left, up_right) == 1 &&
+                        crossSign(low_left, up_right, up_left, low_right) == -1, "diagonals of the grid cross");
+
+        // lengths subtracted in int64_t as well, up to 2^63 across the range of the predicates
+        const int64_t range = (int64_t) 1 << 62;
+        GridPolyline across = {GridPoint(-range, 0), GridPoint(range, 0)};
+        failed += check(across.length() == 2 * (double) range, "length of a line across the predicate range");
+
+        GridPoint corners[] = {low_left, low_right, up_right, up_left};
+        GridPolygon square(corners, 4);
+        double side = 2 * (double) GRID_LIMIT;
+        failed += check(square.degree() == 4 && square.area() == side * side && square.orientation() == 1,
+                        "the square at the grid corners is counterclockwise, of the full area");
+        reverse(begin(corners), end(corners));
+        failed += check(GridPolygon(corners, 4).orientation() == -1,
+                        "the reversed square at the grid corners is clockwise");
+
+        // the last steps on the grid, and the first ones off it
+        Grid unit(1);
+        double limit = (double) GRID_LIMIT;
+        failed += check(unit.fits(Point(limit, -limit)) && unit.snap(Point(limit, -limit)) == low_right,
+                        "points at the limit snap to the corners");
+        failed += check(!unit.fits(Point(nextafter(limit, INFINITY), 0)) && !unit.fits(Point(0, NAN)),
+                        "points past the limit or not finite do not fit");
+        return failed;
+    }
+
+    // A bad step and points off the grid gave a line of output for every grid
+    // and every shape of an ingest; they are only reported through the results.
+    int gridSnapSilent() {
+        Point outside[] = {Point(0, 0), Point(1, 0), Point(1e300, 1), Point(0, 1)};
+        Polygon polygon(outside, 4);
+        Polyline line(outside, 4);
+
+        bool invalid, empty;
+        string output;
+        {
+            Quiet quiet;
+            Grid bad(-1), unit(1);
+            invalid = !bad.isValid() && bad.getStep() == 1 && unit.isValid() && !Grid(NAN).isValid();
+            empty = unit.snap(polygon).degree() == 0 && unit.snap(line).size() == 0 &&
+                    unit.snap(outside[2]) == GridPoint();
+            output = quiet.output();
+        }
+        int failed = check(output.empty(), "bad steps and snaps outside the grid print nothing");
+        failed += check(invalid, "a grid of a bad step has step 1 and says it is not valid");
+        failed += check(empty, "shapes snapped outside the grid are empty");
+
+        // the two left vertexes merge and the polygon touches itself
+        Point collapsing[] = {Point(0, 0), Point(0.2, -0.1), Point(4, 0), Point(4, 4), Point(2, 0.4)};
+        Polygon touching(collapsing, 5);
+        long long degree;
+        {
+            Quiet quiet;
+            degree = Grid(1).snap(touching).degree();
+        }
+        failed += check(touching.degree() == 5 && degree == 0, "a polygon that touches itself once snapped is refused");
+
+        // trySnap says why, with the indexes of the polygon given to it
+        Checked<GridPolygon> snapped = Grid(1).trySnap(polygon);
+        failed += check(snapped.status.error == ShapeError::OUTSIDE_GRID && snapped.status.vertex == 2,
+                        "snapping outside the grid reports the vertex");
+        snapped = Grid(1).trySnap(touching);
+        failed += check(snapped.status.error == ShapeError::EDGES_INTERSECT && snapped.shape.degree() == 0,
+                        "trySnap refuses a polygon that touches itself once snapped");
+        failed += check(snapped.status.vertex >= 1 && snapped.status.vertex < 5 && snapped.status.edge < 5,
+                        "the refused snapped polygon reports indexes of its vertexes");
+        return failed;
+    }
+
+    // Every worker counted into its own block, which only the worker itself
+    // could read: a monitoring thread saw nothing of the others.
+    int statsOfWorkers() {
+        const int workers = 3;
+        mutex lock;
+        condition_variable changed;
+        int counted = 0;
+        bool scraped = false;
+        vector<thread> threads;
+        for (int i = 0; i < workers; i++) {
+            threads.emplace_back([&, i]() {
+                Point corners[] = {Point(0, 0), Point(1, 0), Point(0, 1)};
+                for (int k = 0; k <= i; k++) {
+                    Polygon triangle(corners, 3);
+                }
+                unique_lock<mutex> guard(lock);
+                counted++;
+                changed.notify_all();
+                changed.wait(guard, [&]() { return scraped; });
+            });
+        }
+        vector<ThreadStats> snapshot;
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [&]() { return counted == workers; });
+            snapshot = statsSnapshotAll();
+            scraped = true;
+            changed.notify_all();
+        }
+        vector<thread::id> ids;
+        for (thread &worker: threads) {
+            ids.push_back(worker.get_id());
+            worker.join();
+        }
+
+        int failed = 0;
+        if (statsEnabled()) {
+            uint64_t validations = 0;
+            int seen = 0;
+            for (const ThreadStats &worker: snapshot) {
+                if (find(ids.begin(), ids.end(), worker.id) != ids.end()) {
+                    seen++;
+                    validations += worker.stats.validations;
+                }
+            }
+            failed += check(seen == workers, "every running worker is in the snapshot");
+            failed += check(validations >= 6, "the snapshot holds the counters of the workers");
+        }
+        failed += check(statsJson(snapshot).front() == '[', "the snapshot is written as a JSON array");
+        return failed;
+    }
+
+    // The constructors print why a shape is refused and leave it empty; the
+    // factories say it in the status instead, without output.
+    int factoriesSilent() {
+        Point bowtie[] = {Point(0, 0), Point(2, 2), Point(2, 0), Point(0, 2)};
+        Point repeated[] = {Point(0, 0), Point(2, 0), Point(2, 0), Point(0, 2)};
+        Point kite[] = {Point(0, 0), Point(2, -1), Point(4, 0), Point(2, 3)};
+        Point rectangle[] = {Point(0, 0), Point(2, 0), Point(2, 1), Point(0, 1)};
+        Point square[] = {Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)};
+
+        string output;
+        Checked<Polygon> crossing, doubled;
+        Checked<Triangle> triangle;
+        Checked<Trapezoid> trapezoid, rectangular;
+        Checked<RegularPolygon> unequal, regular;
+        {
+            Quiet quiet;
+            crossing = Polygon::tryMake(bowtie, 4);
+            doubled = Polygon::tryMake(repeated, 4);
+            triangle = Triangle::tryMake(square, 4);
+            trapezoid = Trapezoid::tryMake(kite, 4);
+            rectangular = Trapezoid::tryMake(rectangle, 4);
+            unequal = RegularPolygon::tryMake(rectangle, 4);
+            regular = RegularPolygon::tryMake(square, 4);
+            output = quiet.output();
+        }
+        int failed = check(output.empty(), "the factories print nothing");
+        failed += check(crossing.status.error == ShapeError::EDGES_INTERSECT && crossing.shape.degree() == 0,
+                        "a bowtie is refused");
+        failed += check(crossing.status.vertex >= 0 && crossing.status.edge >= 0, "a bowtie names its edges");
+        failed += check(doubled.status.error == ShapeError::REPEATED_VERTEX && doubled.status.vertex == 2,
+                        "a repeated vertex is named");
+        failed += check(triangle.status.error == ShapeError::WRONG_DEGREE, "a triangle of four vertexes is refused");
+        failed += check(trapezoid.status.error == ShapeError::NOT_A_TRAPEZOID, "a kite is not a trapezoid");
+        failed += check(rectangular.status.error == ShapeError::NOT_A_TRAPEZOID, "a rectangle is not a trapezoid");
+        failed += check(unequal.status.error == ShapeError::UNEQUAL_SIDES, "a rectangle is not regular");
+        failed += check(regular.status && regular.shape.area() == 4, "a square is regular");
+        failed += check(string(describe(ShapeError::NONE)).empty() && *describe(ShapeError::OUTSIDE_GRID),
+                        "every error is described");
+
+        const ClosedPolyline made(square, 4);
+        failed += check(made.tryAt(4) == nullptr && made.tryAt(-1) == nullptr && *made.tryAt(3) == Point(0, 2),
+                        "tryAt is checked");
+        failed += check(made.uncheckedAt(2) == Point(2, 2), "uncheckedAt reads the vertex");
+        return failed;
+    }
+
+    // RegularShape gives area and perimeter from closed forms, without the
+    // vertexes; they agree with the polygon of the vertexes it generates.
+    int regularShapeMatchesPolygon() {
+        bool metrics = true, oriented = true, on_circle = true, boxed = true, contained = true, built = true;
+        for (long long n: {3LL, 4LL, 5LL, 7LL, 12LL, 100LL, 1000LL, 100000LL}) {
+            RegularShape shape(n, 1.5, Point(3, -2), 0.3);
+            vector<Point> vertexes((size_t) n);
+            shape.vertexes(vertexes.data());
+            Polygon polygon(vertexes.data(), n);
+            metrics &= fabs(polygon.area() - shape.area()) <= 1e-12 * shape.area() &&
+                       fabs(polygon.perimeter() - shape.perimeter()) <= 1e-12 * shape.perimeter();
+            oriented &= polygon.orientation() == 1;
+
+            // the box is the closed form of the extreme vertexes, rounded either way
+            Box box = shape.boundingBox();
+            for (const Point &vertex: vertexes) {
+                double radius = hypot(vertex.getX() - 3, vertex.getY() + 2);
+                on_circle &= fabs(radius - shape.circumradius()) <= 1e-12 * shape.circumradius();
+                Point lower = box.getLower(), upper = box.getUpper();
+                boxed &= vertex.getX() >= lower.getX() - 1e-9 && vertex.getX() <= upper.getX() + 1e-9 &&
+                         vertex.getY() >= lower.getY() - 1e-9 && vertex.getY() <= upper.getY() + 1e-9;
+            }
+            contained &= shape.contains(Point(3, -2)) && !shape.contains(Point(3, -2 + 1.01 * shape.circumradius()));
+
+            RegularPolygon polygon_of_shape = shape.toPolygon();
+            built &= polygon_of_shape.degree() == n && polygon_of_shape.area() == shape.area() &&
+                     EditablePolygon(polygon_of_shape)[1] == vertexes[1];
+        }
+        int failed = check(metrics, "closed-form area and perimeter match the generated polygon");
+        failed += check(oriented, "the generated vertexes are counterclockwise");
+        failed += check(on_circle, "the generated vertexes are on the circumcircle");
+        failed += check(boxed, "the bounding box holds the generated vertexes");
+        failed += check(contained, "a regular shape contains its center and not a point past a vertex");
+        failed += check(built, "toPolygon gives the generated vertexes and the closed-form area");
+
+        string output;
+        Checked<RegularShape> flat, few;
+        {
+            Quiet quiet;
+            flat = RegularShape::tryMake(5, 0, Point());
+            few = RegularShape::tryMake(2, 1, Point());
+            output = quiet.output();
+        }
+        failed += check(output.empty(), "tryMake of a regular shape prints nothing");
+        failed += check(flat.status.error == ShapeError::INVALID_SIDE && flat.shape.degree() == 0,
+                        "a regular shape of side 0 is refused");
+        failed += check(few.status.error == ShapeError::TOO_FEW_VERTEXES, "a regular shape of 2 vertexes is refused");
+        return failed;
+    }
+
+    // every a + b of the vertexes lies in the sum, on its boundary at most
+    bool containsVertexSums(Polygon &sum, const vector<Point> &first, const vector<Point> &second) {
+        for (const Point &a: first) {
+            for (const Point &b: second) {
+                if (!sum.contains(a + b)) {
+                    return false;
+                }
+            }
+        }
+        return sum.degree() >= 3;
+    }
+
+    // The sums of the triangles were merged with polygonUnion, which ran into
+    // the overlay that never became planar and aborted with bad_alloc.
+    int minkowskiNonConvex() {
+        vector<Point> a = {Point(4, 6), Point(7, 5), Point(7, 3), Point(4, 1), Point(3, 0), Point(1, 2),
+                           Point(0, 5), Point(5, 7)};
+        vector<Point> b = {Point(0, 0), Point(3, 6), Point(4, 2), Point(1, 0), Point(3, 3)};
+        Polygon A(a.data(), (long long) a.size()), B(b.data(), (long long) b.size());
+        Polygon sum = minkowskiSum(A, B);
+        int failed = check(containsVertexSums(sum, a, b), "sum of two non-convex polygons holds every a + b");
+
+        // random polygons on a small grid, where vertex sums land on edges and crossings of the pieces
+        mt19937 random(2021);
+        auto polygon = [&](vector<Point> &vertexes) {
+            while (true) {
+                vertexes.clear();
+                long long n = 3 + (long long) (random() % 6);
+                for (long long i = 0; i < n; i++) {
+                    vertexes.emplace_back((double) (random() % 8), (double) (random() % 8));
+                }
+                Checked<Polygon> made = Polygon::tryMake(vertexes.data(), n);
+                if (made.status && made.shape.area() > 0) {
+                    return move(made.shape);
+                }
+            }
+        };
+        int missed = 0;
+        for (int i = 0; i < 200; i++) {
+            vector<Point> first, second;
+            Polygon P = polygon(first), Q = polygon(second);
+            Polygon grid_sum = minkowskiSum(P, Q);
+            missed += !containsVertexSums(grid_sum, first, second);
+        }
+        failed += check(missed == 0, "sums of random grid polygons hold every a + b");
+        return failed;
+    }
+
+    // x is in the sum when x - second meets first: either their boundaries
+    // cross, so x is in the sum of an edge of each, or one holds the other, so
+    // x is in first + b or in a + second for a vertex a of first, b of second
+    bool inPairwiseSums(const Point &x, const vector<Point> &first, const vector<Point> &second,
+                        Polygon &first_moved, Polygon &second_moved) {
+        size_t n = first.size(), m = second.size();
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < m; j++) {
+                const Point &a = first[i], &next_a = first[(i + 1) % n];
+                const Point &b = second[j], &next_b = second[(j + 1) % m];
+                Point corners[] = {a + b, next_a + b, next_a + next_b, a + next_b};
+                int left = 0, right = 0;
+                for (int k = 0; k < 4; k++) {
+                    double turn = (corners[(k + 1) % 4] - corners[k]) * (x - corners[k]);
+                    left += turn >= 0;
+                    right += turn <= 0;
+                }
+                if (left == 4 || right == 4) {
+                    return true;
+                }
+            }
+        }
+        return first_moved.contains(x) || second_moved.contains(x);
+    }
+
+    // The sum against the union of the pairwise sums of the edges and the two
+    // polygons moved by a vertex of the other, decided on a fine grid of points
+    // that keeps clear of the integer boundaries.
+    int minkowskiMatchesPairwiseSums() {
+        vector<pair<vector<Point>, vector<Point>>> pairs = {
+                {{Point(4, 6), Point(7, 5), Point(7, 3), Point(4, 1), Point(3, 0), Point(1, 2), Point(0, 5),
+                  Point(5, 7)},
+                 {Point(0, 0), Point(3, 6), Point(4, 2), Point(1, 0), Point(3, 3)}},
+                {{Point(0, 0), Point(6, 0), Point(6, 5), Point(4, 5), Point(4, 2), Point(2, 2), Point(2, 5),
+                  Point(0, 5)},
+                 {Point(0, 0), Point(3, 0), Point(3, 1), Point(1, 1), Point(1, 3), Point(0, 3)}},
+                {{Point(0, 0), Point(6, 0), Point(6, 5), Point(4, 5), Point(4, 2), Point(2, 2), Point(2, 5),
+                  Point(0, 5)},
+                 {Point(0, 0), Point(1, 0), Point(1, 1), Point(0, 1)}}};
+        bool same = true, area = true;
+        for (auto &[first, second]: pairs) {
+            Polygon P(first.data(), (long long) first.size()), Q(second.data(), (long long) second.size());
+            Polygon sum = minkowskiSum(P, Q);
+            vector<Point> first_moved, second_moved;
+            for (const Point &a: first) {
+                first_moved.push_back(a + second[0]);
+            }
+            for (const Point &b: second) {
+                second_moved.push_back(first[0] + b);
+            }
+            Polygon P_moved(first_moved.data(), (long long) first_moved.size());
+            Polygon Q_moved(second_moved.data(), (long long) second_moved.size());
+
+            const double step = 0.1;
+            Box box = sum.boundingBox();
+            long long inside = 0;
+            for (double x = box.getLower().getX() - 1 + 0.0371; x < box.getUpper().getX() + 1; x += step) {
+                for (double y = box.getLower().getY() - 1 + 0.0213; y < box.getUpper().getY() + 1; y += step) {
+                    bool in_sum = sum.contains(Point(x, y));
+                    same &= in_sum == inPairwiseSums(Point(x, y), first, second, P_moved, Q_moved);
+                    inside += in_sum;
+                }
+            }
+            // the points stand for cells of step^2, only those cut by the boundary may be off
+            area &= fabs((double) inside * step * step - sum.area()) <= sum.perimeter() * step;
+        }
+        int failed = check(same, "sums of non-convex polygons cover the pairwise sums and nothing else");
+        failed += check(area, "areas of sums of non-convex polygons match the pairwise sums");
+        return failed;
+    }
+}
+
+int main() {
+    int failed = 0;
+    failed += validationOfRings();
+    failed += kernelsMatchScalar();
+    failed += intersectionKernelsMatchScalar();
+    failed += cacheFollowsMutations();
+    failed += predicatesNearCollinear();
+    failed += bulkConstructionMatches();
+    failed += readersSkipBadFeatures();
+    failed += rtreeMatchesBruteForce();
+    failed += batchMetricsMatch();
+    failed += preparedMatchesContains();
+    failed += hullCoversPoints();
+    failed += sweepMatchesBruteForce();
+    failed += overlayNearVertex();
+    failed += triangulationCoversPolygon();
+    failed += simplifiedPolygonIsSimple();
+    failed += fixedWrongDegree();
+    failed += arenaBatches();
+    failed += vertexBuffersSpill();
+    failed += coordinateConversions();
+    failed += gridKernelsMatchScalar();
+    failed += gridLimits();
+    failed += gridSnapSilent();
+    failed += statsOfWorkers();
+    failed += factoriesSilent();
+    failed += regularShapeMatchesPolygon();
+    failed += minkowskiNonConvex();
+    failed += minkowskiMatchesPairwiseSums();
+    cout << (failed == 0 ? "all tests passed" : "some tests failed") << endl;
+    return failed == 0 ? 0 : 1;
+}
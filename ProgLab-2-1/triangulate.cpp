@@ -0,0 +1,386 @@
+#include "triangulate.h"
+#include "predicates.h"
+#include <algorithm>
+#include <set>
+
+namespace {
+    enum VertexType {
+        START, SPLIT, END, MERGE, REGULAR
+    };
+
+    int orient(const Point &A, const Point &B, const Point &C) {
+        double det = orient2d(A, B, C);
+        return (det > 0) - (det < 0);
+    }
+
+    // the sweep runs from the top down, at equal heights from left to right
+    bool above(const Point &A, const Point &B) {
+        return A.getY() > B.getY() || (A.getY() == B.getY() && A.getX() < B.getX());
+    }
+
+    // edges of the status (edge k runs down from vertex k to vertex k + 1), ordered from west to east
+    struct StatusOrder {
+        using is_transparent = void;
+
+        const vector<Point> *points;
+
+        const Point &upper(long long edge) const {
+            return (*points)[edge];
+        }
+
+        const Point &lower(long long edge) const {
+            return (*points)[edge + 1 == (long long) points->size() ? 0 : edge + 1];
+        }
+
+        // 1 when the point lies east of the edge, -1 when west of it
+        int sideOf(long long edge, const Point &point) const {
+            return orient(upper(edge), lower(edge), point);
+        }
+
+        bool operator()(long long a, long long b) const {
+            if (a == b) {
+                return false;
+            }
+            if (above(upper(b), upper(a))) {
+                int side = sideOf(b, upper(a));
+                if (side == 0) {
+                    side = sideOf(b, lower(a));
+                }
+                if (side != 0) {
+                    return side < 0;
+                }
+            } else {
+                int side = sideOf(a, upper(b));
+                if (side == 0) {
+                    side = sideOf(a, lower(b));
+                }
+                if (side != 0) {
+                    return side > 0;
+                }
+            }
+            return a < b;
+        }
+
+        bool operator()(long long edge, const Point &point) const {
+            return sideOf(edge, point) > 0;
+        }
+
+        bool operator()(const Point &point, long long edge) const {
+            return sideOf(edge, point) < 0;
+        }
+    };
+
+    // order around a vertex, counterclockwise from the direction of the positive x-axis
+    struct AngleOrder {
+        const Point *center;
+
+        int half(const Point &point) const {
+            return point.getY() > center->getY() || (point.getY() == center->getY() && point.getX() > center->getX())
+                   ? 0 : 1;
+        }
+
+        bool operator()(const Point &A, const Point &B) const {
+            int half_a = half(A), half_b = half(B);
+            if (half_a != half_b) {
+                return half_a < half_b;
+            }
+            return orient(*center, A, B) > 0;
+        }
+    };
+
+    // diagonals cutting a counterclockwise polygon without straight vertexes into y-monotone pieces
+    void monotoneDiagonals(const vector<Point> &points, vector<pair<long long, long long>> &diagonals) {
+        long long m = (long long) points.size();
+        vector<VertexType> types(m);
+        vector<long long> order(m);
+        for (long long k = 0; k < m; k++) {
+            const Point &previous = points[(k + m - 1) % m], &vertex = points[k], &next = points[(k + 1) % m];
+            bool previous_below = above(vertex, previous), next_below = above(vertex, next);
+            bool convex = orient(previous, vertex, next) > 0;
+            if (previous_below && next_below) {
+                types[k] = convex ? START : SPLIT;
+            } else if (!previous_below && !next_below) {
+                types[k] = convex ? END : MERGE;
+            } else {
+                types[k] = REGULAR;
+            }
+            order[k] = k;
+        }
+        sort(order.begin(), order.end(), [&](long long a, long long b) { return above(points[a], points[b]); });
+
+        set<long long, StatusOrder> status(StatusOrder{&points});
+        vector<set<long long, StatusOrder>::iterator> position(m);
+        // the lowest vertex seen so far between the edge and the next edge east of it
+        vector<long long> helper(m, -1);
+
+        auto insert = [&](long long edge) {
+            position[edge] = status.insert(edge).first;
+            helper[edge] = edge;
+        };
+        // a merge vertex waits for the next vertex below it to be connected
+        auto connectHelper = [&](long long edge, long long vertex) {
+            if (types[helper[edge]] == MERGE) {
+                diagonals.emplace_back(vertex, helper[edge]);
+            }
+        };
+        auto edgeLeftOf = [&](long long vertex) {
+            return *prev(status.lower_bound(points[vertex]));
+        };
+
+        for (long long k: order) {
+            long long previous = (k + m - 1) % m;
+            switch (types[k]) {
+                case START:
+                    insert(k);
+                    break;
+                case END:
+                    connectHelper(previous, k);
+                    status.erase(position[previous]);
+                    break;
+                case SPLIT: {
+                    long long left = edgeLeftOf(k);
+                    diagonals.emplace_back(k, helper[left]);
+                    helper[left] = k;
+                    insert(k);
+                    break;
+                }
+                case MERGE: {
+                    connectHelper(previous, k);
+                    status.erase(position[previous]);
+                    long long left = edgeLeftOf(k);
+                    connectHelper(left, k);
+                    helper[left] = k;
+                    break;
+                }
+                case REGULAR:
+                    if (above(points[previous], points[k])) {
+                        // on the left boundary, the inside is east of the vertex
+                        connectHelper(previous, k);
+                        status.erase(position[previous]);
+                        insert(k);
+                    } else {
+                        long long left = edgeLeftOf(k);
+                        connectHelper(left, k);
+                        helper[left] = k;
+                    }
+                    break;
+            }
+        }
+    }
+
+    // Triangulates a y-monotone piece given by its vertexes in counterclockwise
+    // order. sorted and stack are scratch space, kept by the caller across pieces.
+    void triangulateMonotone(const vector<Point> &points, const vector<long long> &piece,
+                             vector<pair<long long, bool>> &sorted, vector<pair<long long, bool>> &stack,
+                             vector<long long> &triangles) {
+        auto emit = [&](long long a, long long b, long long c) {
+            if (orient(points[a], points[b], points[c]) < 0) {
+                swap(b, c);
+            }
+            triangles.push_back(a);
+            triangles.push_back(b);
+            triangles.push_back(c);
+        };
+
+        long long s = (long long) piece.size();
+        long long top = 0, bottom = 0;
+        for (long long i = 1; i < s; i++) {
+            if (above(points[piece[i]], points[piece[top]])) {
+                top = i;
+            }
+            if (above(points[piece[bottom]], points[piece[i]])) {
+                bottom = i;
+            }
+        }
+
+        // (vertex, on the left chain) from the top down; counterclockwise order goes down the left chain
+        sorted.clear();
+        sorted.emplace_back(piece[top], true);
+        long long left = (top + 1) % s, right = (top + s - 1) % s;
+        while (left != bottom || right != bottom) {
+            if (right == bottom || (left != bottom && above(points[piece[left]], points[piece[right]]))) {
+                sorted.emplace_back(piece[left], true);
+                left = (left + 1) % s;
+            } else {
+                sorted.emplace_back(piece[right], false);
+                right = (right + s - 1) % s;
+            }
+        }
+        sorted.emplace_back(piece[bottom], true);
+
+        stack.assign({sorted[0], sorted[1]});
+        for (long long j = 2; j < s - 1; j++) {
+            const pair<long long, bool> &vertex = sorted[j];
+            if (vertex.second != stack.back().second) {
+                // the vertex sees the whole chain on the stack
+                for (size_t i = stack.size() - 1; i > 0; i--) {
+                    emit(vertex.first, stack[i].first, stack[i - 1].first);
+                }
+                stack.assign({sorted[j - 1], vertex});
+            } else {
+                pair<long long, bool> last = stack.back();
+                stack.pop_back();
+                while (!stack.empty()) {
+                    const Point &P = points[vertex.first], &Q = points[last.first], &R = points[stack.back().first];
+                    if ((vertex.second ? orient(R, Q, P) : orient(P, Q, R)) <= 0) {
+                        break;
+                    }
+                    emit(vertex.first, last.first, stack.back().first);
+                    last = stack.back();
+                    stack.pop_back();
+                }
+                stack.push_back(last);
+                stack.push_back(vertex);
+            }
+        }
+        for (size_t i = stack.size() - 1; i > 0; i--) {
+            emit(sorted[s - 1].first, stack[i].first, stack[i - 1].first);
+        }
+    }
+
+    // triangulates a counterclockwise polygon without straight vertexes, the triangles index its points
+    void triangulateSimple(const vector<Point> &points, vector<long long> &triangles) {
+        long long m = (long long) points.size();
+        vector<pair<long long, long long>> diagonals;
+        monotoneDiagonals(points, diagonals);
+
+        // half edges: the boundary counterclockwise and every diagonal both ways, all with the inside on their left
+        long long h = m + 2 * (long long) diagonals.size();
+        vector<long long> from(h), to(h);
+        for (long long k = 0; k < m; k++) {
+            from[k] = k;
+            to[k] = (k + 1) % m;
+        }
+        for (size_t i = 0; i < diagonals.size(); i++) {
+            from[m + 2 * i] = to[m + 2 * i + 1] = diagonals[i].first;
+            to[m + 2 * i] = from[m + 2 * i + 1] = diagonals[i].second;
+        }
+        vector<long long> out_starts(m + 1, 0);
+        for (long long e = 0; e < h; e++) {
+            out_starts[from[e] + 1]++;
+        }
+        for (long long k = 0; k < m; k++) {
+            out_starts[k + 1] += out_starts[k];
+        }
+        vector<long long> outgoing(h);
+        vector<long long> filled(out_starts.begin(), out_starts.end() - 1);
+        for (long long e = 0; e < h; e++) {
+            outgoing[filled[from[e]]++] = e;
+        }
+        for (long long k = 0; k < m; k++) {
+            if (out_starts[k + 1] - out_starts[k] > 1) {
+                AngleOrder order{&points[k]};
+                sort(outgoing.begin() + out_starts[k], outgoing.begin() + out_starts[k + 1],
+                     [&](long long a, long long b) { return order(points[to[a]], points[to[b]]); });
+            }
+        }
+
+        // every face is a monotone piece, after u -> v it goes on along the first edge clockwise from v -> u
+        vector<uint8_t> used(h, 0);
+        vector<long long> piece;
+        vector<pair<long long, bool>> sorted, stack;
+        for (long long start = 0; start < h; start++) {
+            if (used[start]) {
+                continue;
+            }
+            piece.clear();
+            long long edge = start;
+            do {
+                used[edge] = 1;
+                piece.push_back(from[edge]);
+                long long vertex = to[edge];
+                long long first_out = out_starts[vertex], last_out = out_starts[vertex + 1];
+                if (last_out - first_out == 1) {
+                    edge = outgoing[first_out];
+                } else {
+                    AngleOrder order{&points[vertex]};
+                    const Point &back = points[from[edge]];
+                    auto after = partition_point(outgoing.begin() + first_out, outgoing.begin() + last_out,
+                                                 [&](long long out) { return order(points[to[out]], back); });
+                    edge = after == outgoing.begin() + first_out ? outgoing[last_out - 1] : *prev(after);
+                }
+            } while (edge != start);
+            triangulateMonotone(points, piece, sorted, stack, triangles);
+        }
+    }
+}
+
+void triangulate(Polygon &polygon, vector<long long> &indexes) {
+    indexes.clear();
+    long long n = polygon.degree();
+    if (n < 3) {
+        return;
+    }
+    const Point *vertexes = polygon.data();
+
+    // positions in counterclockwise order, and the next one along the boundary
+    vector<long long> ccw(n), next(n);
+    bool reversed = polygon.orientation() < 0;
+    for (long long i = 0; i < n; i++) {
+        ccw[i] = reversed ? n - 1 - i : i;
+    }
+    for (long long i = 0; i < n; i++) {
+        next[ccw[i]] = ccw[(i + 1) % n];
+    }
+
+    // vertexes on a straight run of the boundary are left out of the sweep
+    vector<long long> corners;
+    for (long long i = 0; i < n; i++) {
+        if (orient(vertexes[ccw[(i + n - 1) % n]], vertexes[ccw[i]], vertexes[ccw[(i + 1) % n]]) != 0) {
+            corners.push_back(ccw[i]);
+        }
+    }
+    if (corners.size() < 3) {
+        return;
+    }
+    long long m = (long long) corners.size();
+    vector<Point> points;
+    points.reserve(m);
+    vector<long long> next_corner(n, -1);
+    for (long long k = 0; k < m; k++) {
+        points.push_back(vertexes[corners[k]]);
+        next_corner[corners[k]] = corners[(k + 1) % m];
+    }
+
+    vector<long long> triangles;
+    triangles.reserve(3 * (m - 2));
+    triangulateSimple(points, triangles);
+
+    // The triangle on a boundary edge with straight vertexes on it is fanned out
+    // from its third corner, the new triangles are checked for further such edges.
+    indexes.reserve(3 * (n - 2));
+    vector<long long> pending;
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        pending.assign({corners[triangles[t]], corners[triangles[t + 1]], corners[triangles[t + 2]]});
+        while (!pending.empty()) {
+            long long c = pending.back(), b = pending[pending.size() - 2], a = pending[pending.size() - 3];
+            pending.resize(pending.size() - 3);
+            bool fanned = false;
+            for (int turn = 0; turn < 3 && !fanned; turn++) {
+                if (next_corner[a] == b && next[a] != b) {
+                    for (long long u = a; u != b; u = next[u]) {
+                        pending.insert(pending.end(), {u, next[u], c});
+                    }
+                    fanned = true;
+                }
+                long long first = a;
+                a = b, b = c, c = first;
+            }
+            if (!fanned) {
+                indexes.insert(indexes.end(), {a, b, c});
+            }
+        }
+    }
+}
+
+void triangulate(Polygon &polygon, vector<Triangle> &triangles) {
+    vector<long long> indexes;
+    triangulate(polygon, indexes);
+    const Point *vertexes = polygon.data();
+    triangles.clear();
+    triangles.reserve(indexes.size() / 3);
+    for (size_t t = 0; t < indexes.size(); t += 3) {
+        triangles.push_back(Triangle(vertexes[indexes[t]], vertexes[indexes[t + 1]], vertexes[indexes[t + 2]],
+                                     Polygon::Trusted()));
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef PROGLAB_2_1_TRIANGULATE_H
+#define PROGLAB_2_1_TRIANGULATE_H
+
+#include "geometry.h"
+
+// Triangulation of a simple polygon in O(n log n).
+//
+// A sweep from the top down adds the diagonals that cut the polygon into
+// y-monotone pieces (at split and merge vertexes, de Berg et al., chapter 3),
+// and every piece is then triangulated in linear time with a stack. Vertexes
+// lying on a straight run of the boundary are set aside during the sweep and
+// fanned into the triangle of their edge afterwards, so no triangle comes out
+// flat. All turns are decided with the exact orient2d.
+//
+// A polygon of n vertexes gives n - 2 counterclockwise triangles, whatever the
+// orientation of the polygon; an empty polygon gives none.
+
+// every three entries are one triangle, as positions of its corners among the vertexes of the polygon
+void triangulate(Polygon &polygon, vector<long long> &indexes);
+
+// the same triangles as Triangle objects, built without validating them again
+void triangulate(Polygon &polygon, vector<Triangle> &triangles);
+
+#endif //PROGLAB_2_1_TRIANGULATE_H